@@ -1,7 +1,103 @@
 #include "parser.h"
 
-// NOTE(joon) 'peek' function takes a Tokenizer as a value, therefore 
-// not advancing the tokenizer
+// NOTE(joon) the parser only builds on the posix hosts(mmap, pread, pthreads) 
+// with gcc or clang(__builtin_* and __atomic_*)
+#include <errno.h>
+#include <fcntl.h>
+#include <float.h>
+#include <locale.h>
+#include <math.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// NOTE(joon) io_uring is used through the raw syscalls, so that there is no liburing dependency. 
+// Define PARSER_IO_URING as 0 to always use the pread thread instead.
+#ifndef PARSER_IO_URING
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define PARSER_IO_URING 1
+#endif
+#endif
+#endif
+#ifndef PARSER_IO_URING
+#define PARSER_IO_URING 0
+#endif
+
+#if PARSER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+// NOTE(joon) compressed inputs need the host to link zlib(-lz) or zstd(-lzstd), so they are opt-in
+#ifndef PARSER_ZLIB
+#define PARSER_ZLIB 0
+#endif
+#ifndef PARSER_ZSTD
+#define PARSER_ZSTD 0
+#endif
+
+#if PARSER_ZLIB
+#include <zlib.h>
+#endif
+#if PARSER_ZSTD
+#include <zstd.h>
+#endif
+
+#if defined(__x86_64__)
+#define PARSER_X64 1
+#include <immintrin.h>
+#else
+#define PARSER_X64 0
+#endif
+
+// NOTE(joon) lets the compiler emit avx2 instructions for this function only,
+// without building the whole file with -mavx2.
+#define PARSER_TARGET_AVX2 __attribute__((target("avx2")))
+#define PARSER_TARGET_F16C __attribute__((target("avx2,f16c")))
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define PARSER_BIG_ENDIAN 1
+#else
+#define PARSER_BIG_ENDIAN 0
+#endif
+
+inline u16
+parser_byte_swap_u16(u16 value)
+{
+    u16 result = (u16)((value << 8) | (value >> 8));
+    return result;
+}
+
+inline u32
+parser_byte_swap_u32(u32 value)
+{
+    return __builtin_bswap32(value);
+}
+
+inline u64
+parser_byte_swap_u64(u64 value)
+{
+    return __builtin_bswap64(value);
+}
+
+inline u32
+parser_count_trailing_zeros(u32 value)
+{
+    assert(value);
+    return (u32)__builtin_ctz(value);
+}
+
+inline u32
+parser_count_set_bits(u32 value)
+{
+    return (u32)__builtin_popcount(value);
+}
+
+// NOTE(joon) 'peek' function takes a tokenizer pointer, but never moves at. 
+// It only fills the lookahead of the tokenizer, so that the 'eat' at the same position 
+// can reuse the token instead of parsing it again.
 // 'eat' function takes a tokenizer pointer, and will advance the tokenizer
 inline void
 eat(Tokenizer *tokenizer, i32 a)
@@ -80,662 +176,8162 @@ get_extension(char *dest, char *source)
     }
 }
 
+#define default_parser_arena_block_size (16*1024*1024)
+
+// NOTE(joon) counts the block in this arena and all of its parents. 
+// The gcc/clang atomics are fine here, the parser only builds with those(see the top of this file).
 internal void
-eat_until_whitespace(Tokenizer *tokenizer)
+add_parser_arena_reserved_size(ParserArena *arena, size_t size, b32 is_adding)
 {
-    while(tokenizer->at < tokenizer->one_past_end)
+    for(ParserArena *at = arena;
+            at;
+            at = at->parent)
     {
-        if(*tokenizer->at == '\n' ||
-            *tokenizer->at == '\r' ||
-           *tokenizer->at == ' ')
+        if(is_adding)
         {
-            break;
-        }
+            size_t reserved_size = __atomic_add_fetch(&at->reserved_size, size, __ATOMIC_RELAXED);
 
-        tokenizer->at++;
+            size_t peak_reserved_size = __atomic_load_n(&at->peak_reserved_size, __ATOMIC_RELAXED);
+            while(peak_reserved_size < reserved_size &&
+                  !__atomic_compare_exchange_n(&at->peak_reserved_size, &peak_reserved_size, reserved_size, 
+                                               true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+            }
+        }
+        else
+        {
+            __atomic_sub_fetch(&at->reserved_size, size, __ATOMIC_RELAXED);
+        }
     }
 }
 
+// NOTE(joon) makes the arena start with the memory that the caller owns. 
+// Nothing is malloced until the memory is full, and free_parser_arena never frees it.
 internal void
-eat_until_newline(Tokenizer *tokenizer)
+init_parser_arena(ParserArena *arena, void *memory, size_t memory_size, size_t minimum_block_size = 0)
+{
+    assert(memory_size > sizeof(ParserArenaFooter) + alignof(ParserArenaFooter));
+
+    *arena = {};
+    arena->minimum_block_size = minimum_block_size;
+
+    // NOTE(joon) the footer has pointers inside, so it goes to the last aligned spot of the memory
+    size_t footer_address = ((size_t)memory + memory_size - sizeof(ParserArenaFooter)) & ~(alignof(ParserArenaFooter) - 1);
+
+    arena->base = (u8 *)memory;
+    arena->size = footer_address - (size_t)memory;
+    arena->external_base = arena->base;
+    arena->block_count = 1;
+
+    ParserArenaFooter *footer = (ParserArenaFooter *)(arena->base + arena->size);
+    *footer = {};
+
+    add_parser_arena_reserved_size(arena, arena->size + sizeof(ParserArenaFooter), true);
+}
+
+// NOTE(joon) sub-arena for one thread of the parallel path. 
+// It can only be used by one thread at a time, and should be freed before the parent.
+internal ParserArena
+begin_parser_sub_arena(ParserArena *parent, size_t minimum_block_size = 0)
+{
+    ParserArena result = {};
+    result.parent = parent;
+    result.minimum_block_size = minimum_block_size ? minimum_block_size : parent->minimum_block_size;
+
+    return result;
+}
+
+internal void *
+push_parser_size(ParserArena *arena, size_t size, size_t alignment = 16)
 {
-    while(tokenizer->at != tokenizer->one_past_end)
+    size_t alignment_offset = 0;
+    size_t alignment_mask = alignment - 1;
+    if((size_t)(arena->base + arena->used) & alignment_mask)
+    {
+        alignment_offset = alignment - ((size_t)(arena->base + arena->used) & alignment_mask);
+    }
+
+    if(!arena->base ||
+        arena->used + alignment_offset + size > arena->size)
     {
-        if(*tokenizer->at == '\n' ||
-            *tokenizer->at == '\r')
+        // NOTE(joon) current block is full, get a new one and store the previous block inside the footer
+        size_t minimum_block_size = arena->minimum_block_size ? arena->minimum_block_size : default_parser_arena_block_size;
+        size_t block_size = size + alignment + sizeof(ParserArenaFooter);
+        if(block_size < minimum_block_size)
         {
-            break;
+            block_size = minimum_block_size;
         }
+        // NOTE(joon) the footer at the end has pointers inside, so the end should be aligned for them
+        block_size = (block_size + alignof(ParserArenaFooter) - 1) & ~(alignof(ParserArenaFooter) - 1);
 
-        tokenizer->at++;
+        u8 *new_base = (u8 *)malloc(block_size);
+        assert(new_base);
+
+        ParserArenaFooter *footer = (ParserArenaFooter *)(new_base + block_size - sizeof(ParserArenaFooter));
+        footer->base = arena->base;
+        footer->size = arena->size;
+        footer->used = arena->used;
+
+        arena->base = new_base;
+        arena->size = block_size - sizeof(ParserArenaFooter);
+        arena->used = 0;
+        arena->block_count++;
+
+        add_parser_arena_reserved_size(arena, block_size, true);
+
+        alignment_offset = 0;
+        if((size_t)arena->base & alignment_mask)
+        {
+            alignment_offset = alignment - ((size_t)arena->base & alignment_mask);
+        }
     }
+
+    void *result = arena->base + arena->used + alignment_offset;
+    arena->used += alignment_offset + size;
+
+    return result;
 }
 
+#define push_parser_struct(arena, type) (type *)push_parser_size(arena, sizeof(type))
+#define push_parser_array(arena, type, count) (type *)push_parser_size(arena, sizeof(type)*(count))
 
+// NOTE(joon) frees every block that this arena has ever allocated. 
+// The peak stays, so that the caller can still get the stats after the load.
 internal void
-eat_all_whitespaces(Tokenizer *tokenizer)
+free_parser_arena(ParserArena *arena)
 {
-    while(tokenizer->at != tokenizer->one_past_end)
+    while(arena->base)
     {
-        if(!(*tokenizer->at == '\n' ||
-            *tokenizer->at == '\r' ||
-           *tokenizer->at == ' '))
+        ParserArenaFooter footer = *(ParserArenaFooter *)(arena->base + arena->size);
+        add_parser_arena_reserved_size(arena, arena->size + sizeof(ParserArenaFooter), false);
+        if(arena->base != arena->external_base)
         {
-            break;
+            free(arena->base);
         }
 
-        tokenizer->at++;
+        arena->base = footer.base;
+        arena->size = footer.size;
+        arena->used = footer.used;
     }
+
+    arena->block_count = 0;
+    arena->external_base = 0;
 }
 
-internal ParseNumericResult
-eat_numeric(Tokenizer *tokenizer)
+// NOTE(joon) gives every block of the sub-arena to the parent, so that the things that were 
+// allocated by the other thread live as long as the parent does. 
+// The blocks go under the parent's current block, so the parent keeps pushing where it was.
+internal void
+merge_parser_sub_arena(ParserArena *parent, ParserArena *sub_arena)
 {
-#if 0
-    assert(*start == '0' || 
-            *start == '1' || 
-            *start == '2' || 
-            *start == '3' || 
-            *start == '4' || 
-            *start == '5' || 
-            *start == '6' || 
-            *start == '7' || 
-            *start == '8' || 
-            *start == '9');
-#endif
-
-    ParseNumericResult result = {};
+    assert(sub_arena->parent == parent);
 
-    b32 scientific_notation = false;
-    f64 decimal_point_adjustment = 10.0f;
-    f64 number = 0;
-    while(tokenizer->at < tokenizer->one_past_end)
+    if(sub_arena->base)
     {
-        if(*tokenizer->at >= '0' && *tokenizer->at <= '9' )
-        {
-            number *= 10;
-            number += *tokenizer->at-'0';
-        }
-        else if(*tokenizer->at == '.')
-        {
-            result.is_float = true;
-        }
-        else if(*tokenizer->at == 'e')
+        if(parent->base)
         {
-            // -5.4335527188698052e-09
-            scientific_notation = true;
-            break;
+            ParserArenaFooter *oldest_footer = (ParserArenaFooter *)(sub_arena->base + sub_arena->size);
+            while(oldest_footer->base)
+            {
+                oldest_footer = (ParserArenaFooter *)(oldest_footer->base + oldest_footer->size);
+            }
+
+            ParserArenaFooter *parent_footer = (ParserArenaFooter *)(parent->base + parent->size);
+            *oldest_footer = *parent_footer;
+            parent_footer->base = sub_arena->base;
+            parent_footer->size = sub_arena->size;
+            parent_footer->used = sub_arena->used;
         }
         else
         {
-            break;
-        }
-
-        if(result.is_float)
-        {
-            decimal_point_adjustment *= 0.1f;
+            parent->base = sub_arena->base;
+            parent->size = sub_arena->size;
+            parent->used = sub_arena->used;
         }
 
-        tokenizer->at++;
-    }
-
-    if(result.is_float)
-    {
-        result.value_f32 = (f32)(number*decimal_point_adjustment);
+        // NOTE(joon) the parent(and its parents) already have these blocks inside the reserved size
+        parent->block_count += sub_arena->block_count;
     }
-    else
-    {
-        result.value_i32 = (i32)number;
-    }
-
-    if(scientific_notation)
-    {
-        assert(*tokenizer->at == 'e');
-        eat(tokenizer, 1);
-
-        b32 scientific_plus = false;
-        if(*tokenizer->at == '+')
-        {
-            scientific_plus = true;
-        }
-        eat(tokenizer, 1);
 
-        f32 scientific_value = 0;
-        while(tokenizer->at < tokenizer->one_past_end)
-        {
-            if(*tokenizer->at >= '0' && *tokenizer->at <= '9' )
-            {
-                scientific_value *= 10;
-                scientific_value += (*tokenizer->at-'0');
-            }
-            else
-            {
-                break;
-            }
+    *sub_arena = {};
+}
 
-            eat(tokenizer, 1);
-        }
+internal ParserArenaStats
+get_parser_arena_stats(ParserArena *arena)
+{
+    ParserArenaStats result = {};
+    result.block_count = arena->block_count;
+    result.reserved_size = __atomic_load_n(&arena->reserved_size, __ATOMIC_RELAXED);
+    result.peak_reserved_size = __atomic_load_n(&arena->peak_reserved_size, __ATOMIC_RELAXED);
 
-        result.value_f32 *= powf(10.0f, (scientific_plus ? 1 : -1) * scientific_value);
+    ParserArenaFooter at = {arena->base, arena->size, arena->used};
+    while(at.base)
+    {
+        result.used_size += at.used;
+        at = *(ParserArenaFooter *)(at.base + at.size);
     }
-    
+
     return result;
 }
 
 internal void
-numeric_obj_token_to_f32(ObjToken token, f32 *dest)
+init_parser_block_list(ParserBlockList *list, u32 element_size)
 {
-    if(token.type == obj_token_type_f32)
+    assert(element_size % 4 == 0);
+
+    *list = {};
+    list->element_size = element_size;
+}
+
+internal ParserBlock *
+add_parser_block(ParserArena *arena, ParserBlockList *list)
+{
+    // NOTE(joon) start small so that tiny files don't waste memory, and double up to 1M elements per block
+    u32 capacity = 1024;
+    if(list->last)
     {
-        *dest = token.value_f32;
+        capacity = 2*list->last->capacity;
+        if(capacity > (1 << 20))
+        {
+            capacity = (1 << 20);
+        }
     }
-    else if(token.type == obj_token_type_i32)
+
+    ParserBlock *block = (ParserBlock *)push_parser_size(arena, sizeof(ParserBlock) + (size_t)capacity*list->element_size);
+    block->next = 0;
+    block->count = 0;
+    block->capacity = capacity;
+
+    if(list->last)
     {
-        *dest = (f32)token.value_i32;
+        list->last->next = block;
     }
     else
     {
-        invalid_code_path;
+        list->first = block;
     }
+    list->last = block;
+
+    return block;
 }
 
+inline void *
+push_parser_block_list(ParserArena *arena, ParserBlockList *list)
+{
+    ParserBlock *block = list->last;
+    if(!block || block->count == block->capacity)
+    {
+        block = add_parser_block(arena, list);
+    }
 
+    void *result = (u8 *)(block + 1) + (size_t)block->count*list->element_size;
+    block->count++;
+    list->total_count++;
 
-internal PlyToken
-eat_ply_token(Tokenizer *tokenizer)
+    return result;
+}
+
+// NOTE(joon) dest should be big enough to hold list->total_count elements
+internal void
+copy_parser_block_list(ParserBlockList *list, void *dest)
 {
-    PlyToken result = {};
+    u8 *at = (u8 *)dest;
+    for(ParserBlock *block = list->first;
+            block;
+            block = block->next)
+    {
+        size_t size = (size_t)block->count*list->element_size;
+        memcpy(at, block + 1, size);
+        at += size;
+    }
+}
 
-    // NOTE(joon) eat all the unnecessary charcters(whilespace, newline...)
-    eat_all_whitespaces(tokenizer);
+internal void *
+parser_thread_proc(void *data)
+{
+    ParserThreadPool *pool = (ParserThreadPool *)data;
 
-    if(tokenizer->at < tokenizer->one_past_end)
+    pthread_mutex_lock(&pool->mutex);
+    while(1)
     {
-        if(string_compare((char *)tokenizer->at, "element"))
+        if(pool->next_work_to_read != pool->next_work_to_write)
         {
-            result.type = ply_token_type_element;
-            eat_until_whitespace(tokenizer);
+            ParserWork work = pool->works[pool->next_work_to_read];
+            pool->next_work_to_read = (pool->next_work_to_read + 1) % parser_max_work_count;
+            pthread_mutex_unlock(&pool->mutex);
+
+            work.callback(work.data);
+
+            pthread_mutex_lock(&pool->mutex);
+            pool->completion_count++;
+            pthread_cond_broadcast(&pool->work_completed);
         }
-        else if(string_compare((char *)tokenizer->at, "vertex"))
+        else if(pool->is_shutting_down)
         {
-            result.type = ply_token_type_vertex;
-            eat_until_whitespace(tokenizer);
+            break;
         }
-        else if(string_compare((char *)tokenizer->at, "face"))
+        else
         {
-            result.type = ply_token_type_face;
-            eat_until_whitespace(tokenizer);
+            pthread_cond_wait(&pool->work_added, &pool->mutex);
         }
-        else if(string_compare((char *)tokenizer->at, "end_header"))
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return 0;
+}
+
+// NOTE(joon) thread_count is the number of the worker threads, 
+// the thread that calls complete_all_parser_work will also do the work
+internal void
+start_parser_thread_pool(ParserThreadPool *pool, u32 thread_count)
+{
+    assert(thread_count <= parser_max_thread_count);
+
+    pool->thread_count = 0;
+    pool->next_work_to_read = 0;
+    pool->next_work_to_write = 0;
+    pool->completion_goal = 0;
+    pool->completion_count = 0;
+    pool->is_shutting_down = false;
+
+    pthread_mutex_init(&pool->mutex, 0);
+    pthread_cond_init(&pool->work_added, 0);
+    pthread_cond_init(&pool->work_completed, 0);
+
+    for(u32 thread_index = 0;
+            thread_index < thread_count;
+            ++thread_index)
+    {
+        if(pthread_create(pool->threads + pool->thread_count, 0, parser_thread_proc, pool) == 0)
         {
-            result.type = ply_token_type_end_header;
-            eat_until_whitespace(tokenizer);
+            pool->thread_count++;
         }
-        else if(string_compare((char *)tokenizer->at, "property"))
+    }
+}
+
+internal void
+end_parser_thread_pool(ParserThreadPool *pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    pool->is_shutting_down = true;
+    pthread_cond_broadcast(&pool->work_added);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for(u32 thread_index = 0;
+            thread_index < pool->thread_count;
+            ++thread_index)
+    {
+        pthread_join(pool->threads[thread_index], 0);
+    }
+
+    pthread_cond_destroy(&pool->work_completed);
+    pthread_cond_destroy(&pool->work_added);
+    pthread_mutex_destroy(&pool->mutex);
+    pool->thread_count = 0;
+}
+
+// NOTE(joon) if there is no pool, the work is done right away. 
+// The same happens when the ring is full, so the work that is already queued is never overwritten, 
+// and the calling thread helps with draining the ring instead of waiting.
+internal void
+add_parser_work(ParserThreadPool *pool, parser_work_callback *callback, void *data)
+{
+    b32 is_queued = false;
+    if(pool)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        u32 new_next_work_to_write = (pool->next_work_to_write + 1) % parser_max_work_count;
+        if(new_next_work_to_write != pool->next_work_to_read)
         {
-            result.type = ply_token_type_property;
-            eat_until_whitespace(tokenizer);
+            ParserWork *work = pool->works + pool->next_work_to_write;
+            work->callback = callback;
+            work->data = data;
+            pool->next_work_to_write = new_next_work_to_write;
+            pool->completion_goal++;
+            is_queued = true;
+
+            pthread_cond_signal(&pool->work_added);
         }
-  
-        else
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    if(!is_queued)
+    {
+        callback(data);
+    }
+}
+
+// NOTE(joon) the calling thread also does the work, instead of just waiting
+internal void
+complete_all_parser_work(ParserThreadPool *pool)
+{
+    if(pool)
+    {
+        pthread_mutex_lock(&pool->mutex);
+        while(pool->completion_count != pool->completion_goal)
         {
-            b32 hyphen_appeared = false;
-            switch(*tokenizer->at)
+            if(pool->next_work_to_read != pool->next_work_to_write)
             {
-                case '-':
-                {
-                    hyphen_appeared = true;
-                    tokenizer->at++;
-                };
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
-                {
-                    ParseNumericResult parse_numeric_result = eat_numeric(tokenizer);
-
-                    if(parse_numeric_result.is_float)
-                    {
-                        result.type = ply_token_type_f32;
-                        result.value_f32 = parse_numeric_result.value_f32;
-                        result.is_float = true;
+                ParserWork work = pool->works[pool->next_work_to_read];
+                pool->next_work_to_read = (pool->next_work_to_read + 1) % parser_max_work_count;
+                pthread_mutex_unlock(&pool->mutex);
 
-                        if(hyphen_appeared)
-                        {
-                            result.value_f32 *= -1.0f;
-                            hyphen_appeared = false;
-                        }
-                    }
-                    else
-                    {
-                        result.type = ply_token_type_i32;
-                        result.value_i32 = parse_numeric_result.value_i32;
-                        result.is_float = false;
-                        if(hyphen_appeared)
-                        {
-                            result.value_i32 *= -1;
-                            hyphen_appeared = false;
-                        }
-                    }
-                }break;
+                work.callback(work.data);
 
-                default:
-                {
-                }break;
+                pthread_mutex_lock(&pool->mutex);
+                pool->completion_count++;
+            }
+            else
+            {
+                pthread_cond_wait(&pool->work_completed, &pool->mutex);
             }
-
         }
 
+        pool->completion_goal = 0;
+        pool->completion_count = 0;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+// NOTE(joon) how many pieces should we cut the work into. 
+// More pieces than the threads so that the threads that finished early can pick up more.
+internal u32
+get_parser_chunk_count(ParserThreadPool *pool, size_t size, size_t minimum_chunk_size)
+{
+    u32 result = 1;
+    if(pool)
+    {
+        size_t max_chunk_count = size / minimum_chunk_size;
+        result = 4*(pool->thread_count + 1);
+        if(result > max_chunk_count)
+        {
+            result = (u32)max_chunk_count;
+        }
+        if(result == 0)
+        {
+            result = 1;
+        }
     }
 
     return result;
 }
 
-internal PlyToken
-eat_and_check_ply_token(Tokenizer *tokenizer, PlyTokenType expected_type)
+// NOTE(joon) returns the start of the line that comes after at(or at itself, if at is already at the line start)
+internal u8 *
+get_next_line_start(u8 *start, u8 *at, u8 *one_past_end)
 {
-    PlyToken result = eat_ply_token(tokenizer);
-    assert(result.type == expected_type);
+    if(at > start && at < one_past_end && at[-1] != '\n')
+    {
+        while(at < one_past_end && *at != '\n')
+        {
+            at++;
+        }
 
-    return result;
+        if(at < one_past_end)
+        {
+            at++;
+        }
+    }
+
+    return at;
 }
 
-internal PlyToken
-peek_ply_token(Tokenizer tokenizer)
+// NOTE(joon) SIMD version of the eat_until / eat_all functions. 
+// Each kernel classifies 16(SSE2) or 32(AVX2) bytes per iteration and jumps straight to 
+// the first byte that stops the scan. The loads never go past one_past_end, 
+// the last few bytes are always handled by the scalar loop.
+enum ParserSIMDLevel
 {
-    PlyToken result = eat_ply_token(&tokenizer);
+    parser_simd_level_scalar,
+    parser_simd_level_sse2,
+    parser_simd_level_avx2,
+};
+
+#if PARSER_X64
+internal ParserSIMDLevel
+detect_parser_simd_level()
+{
+    ParserSIMDLevel result = parser_simd_level_sse2; // every x64 cpu has sse2
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        result = parser_simd_level_avx2;
+    }
 
     return result;
 }
-
-internal ParsePlyHeaderResult
-parse_ply_header(u8 *memory, u32 file_size)
+#else
+internal ParserSIMDLevel
+detect_parser_simd_level()
 {
-    ParsePlyHeaderResult result = {};
+    return parser_simd_level_scalar;
+}
+#endif
 
-    Tokenizer tokenizer = {};
-    tokenizer.at = memory;
-    tokenizer.one_past_end = memory + file_size;
+// NOTE(joon) can be lowered by the caller to test the fallback paths
+global ParserSIMDLevel parser_simd_level = detect_parser_simd_level();
 
-    b32 end_header_appeared = false;
-    while(tokenizer.at < tokenizer.one_past_end && !end_header_appeared)
+enum ParserScanType
+{
+    // stop at '\n', '\r' or ' '
+    parser_scan_type_until_whitespace,
+    // stop at '\n' or '\r'
+    parser_scan_type_until_newline,
+    // stop at anything that is not '\n', '\r' or ' '
+    parser_scan_type_all_whitespaces,
+};
+
+#if PARSER_X64
+internal u8 *
+scan_tokenizer_bytes_sse2(u8 *at, u8 *one_past_end, ParserScanType type)
+{
+    // NOTE(joon) when we only care about the newlines, the 'space' lane compares against '\n' again, 
+    // which doesn't add anything to the mask
+    __m128i newline = _mm_set1_epi8('\n');
+    __m128i carriage_return = _mm_set1_epi8('\r');
+    __m128i space = _mm_set1_epi8(type == parser_scan_type_until_newline ? '\n' : ' ');
+    u32 invert_mask = (type == parser_scan_type_all_whitespaces) ? 0xffff : 0;
+
+    while(at + 16 <= one_past_end)
     {
-        PlyToken token = eat_ply_token(&tokenizer);
+        __m128i c = _mm_loadu_si128((__m128i *)at);
+        __m128i delimiter = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, newline), _mm_cmpeq_epi8(c, carriage_return)), 
+                                         _mm_cmpeq_epi8(c, space));
 
-        switch(token.type)
+        u32 mask = (u32)_mm_movemask_epi8(delimiter) ^ invert_mask;
+        if(mask)
         {
-            case ply_token_type_element:
-            {
-                PlyToken element_name = eat_ply_token(&tokenizer);
-                if(element_name.type == ply_token_type_vertex)
-                {
-                    PlyToken vertex_count = eat_and_check_ply_token(&tokenizer, ply_token_type_i32);
-                    result.vertex_count = vertex_count.value_i32;
-                }
-                else if(element_name.type == ply_token_type_face)
-                {
-                    // It seems like this information is useless?
+            return at + parser_count_trailing_zeros(mask);
+        }
+
+        at += 16;
+    }
+
+    return at;
+}
+
+PARSER_TARGET_AVX2 internal u8 *
+scan_tokenizer_bytes_avx2(u8 *at, u8 *one_past_end, ParserScanType type)
+{
+    __m256i newline = _mm256_set1_epi8('\n');
+    __m256i carriage_return = _mm256_set1_epi8('\r');
+    __m256i space = _mm256_set1_epi8(type == parser_scan_type_until_newline ? '\n' : ' ');
+    u32 invert_mask = (type == parser_scan_type_all_whitespaces) ? 0xffffffff : 0;
+
+    while(at + 32 <= one_past_end)
+    {
+        __m256i c = _mm256_loadu_si256((__m256i *)at);
+        __m256i delimiter = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c, newline), _mm256_cmpeq_epi8(c, carriage_return)), 
+                                            _mm256_cmpeq_epi8(c, space));
+
+        u32 mask = (u32)_mm256_movemask_epi8(delimiter) ^ invert_mask;
+        if(mask)
+        {
+            return at + parser_count_trailing_zeros(mask);
+        }
+
+        at += 32;
+    }
+
+    // NOTE(joon) let sse2 handle the 16 byte leftover, if any
+    return scan_tokenizer_bytes_sse2(at, one_past_end, type);
+}
+#endif
+
+inline b32
+is_token_whitespace(u8 c)
+{
+    b32 result = (c == '\n' || c == '\r' || c == ' ');
+    return result;
+}
+
+inline b32
+is_token_newline(u8 c)
+{
+    b32 result = (c == '\n' || c == '\r');
+    return result;
+}
+
+internal u8 *
+scan_tokenizer_bytes(u8 *at, u8 *one_past_end, ParserScanType type)
+{
+#if PARSER_X64
+    if(parser_simd_level == parser_simd_level_avx2)
+    {
+        at = scan_tokenizer_bytes_avx2(at, one_past_end, type);
+    }
+    else if(parser_simd_level == parser_simd_level_sse2)
+    {
+        at = scan_tokenizer_bytes_sse2(at, one_past_end, type);
+    }
+#endif
+
+    // scalar fallback, also handles whatever was left from the simd loop
+    switch(type)
+    {
+        case parser_scan_type_until_whitespace:
+        {
+            while(at < one_past_end && !is_token_whitespace(*at))
+            {
+                at++;
+            }
+        }break;
+        case parser_scan_type_until_newline:
+        {
+            while(at < one_past_end && !is_token_newline(*at))
+            {
+                at++;
+            }
+        }break;
+        case parser_scan_type_all_whitespaces:
+        {
+            while(at < one_past_end && is_token_whitespace(*at))
+            {
+                at++;
+            }
+        }break;
+    }
+
+    return at;
+}
+
+internal void
+eat_until_whitespace(Tokenizer *tokenizer)
+{
+    tokenizer->at = scan_tokenizer_bytes(tokenizer->at, tokenizer->one_past_end, parser_scan_type_until_whitespace);
+}
+
+internal void
+eat_until_newline(Tokenizer *tokenizer)
+{
+    tokenizer->at = scan_tokenizer_bytes(tokenizer->at, tokenizer->one_past_end, parser_scan_type_until_newline);
+}
+
+internal void
+eat_all_whitespaces(Tokenizer *tokenizer)
+{
+    // NOTE(joon) most of the time there is only one space(or none) between the tokens, 
+    // so check the first two bytes before going wide
+    if(tokenizer->at < tokenizer->one_past_end && !is_token_whitespace(*tokenizer->at))
+    {
+        return;
+    }
+    if(tokenizer->at + 1 < tokenizer->one_past_end && !is_token_whitespace(tokenizer->at[1]))
+    {
+        tokenizer->at++;
+        return;
+    }
+
+    tokenizer->at = scan_tokenizer_bytes(tokenizer->at, tokenizer->one_past_end, parser_scan_type_all_whitespaces);
+}
+
+// NOTE(joon) same structure as the scan kernels, but counts every '\n' instead of stopping at the first one
+#if PARSER_X64
+internal u8 *
+count_newlines_sse2(u8 *at, u8 *one_past_end, u64 *count)
+{
+    __m128i newline = _mm_set1_epi8('\n');
+
+    u64 result = 0;
+    while(at + 16 <= one_past_end)
+    {
+        __m128i c = _mm_loadu_si128((__m128i *)at);
+        result += parser_count_set_bits((u32)_mm_movemask_epi8(_mm_cmpeq_epi8(c, newline)));
+
+        at += 16;
+    }
+    *count += result;
+
+    return at;
+}
+
+PARSER_TARGET_AVX2 internal u8 *
+count_newlines_avx2(u8 *at, u8 *one_past_end, u64 *count)
+{
+    __m256i newline = _mm256_set1_epi8('\n');
+
+    u64 result = 0;
+    while(at + 32 <= one_past_end)
+    {
+        __m256i c = _mm256_loadu_si256((__m256i *)at);
+        result += parser_count_set_bits((u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, newline)));
+
+        at += 32;
+    }
+    *count += result;
+
+    return count_newlines_sse2(at, one_past_end, count);
+}
+#endif
+
+internal u64
+count_newlines(u8 *at, u8 *one_past_end)
+{
+    u64 result = 0;
+#if PARSER_X64
+    if(parser_simd_level == parser_simd_level_avx2)
+    {
+        at = count_newlines_avx2(at, one_past_end, &result);
+    }
+    else if(parser_simd_level == parser_simd_level_sse2)
+    {
+        at = count_newlines_sse2(at, one_past_end, &result);
+    }
+#endif
+
+    while(at < one_past_end)
+    {
+        result += (*at == '\n');
+        at++;
+    }
+
+    return result;
+}
+
+// NOTE(joon) moves the tokenizer to the start of the next line
+internal void
+eat_line(Tokenizer *tokenizer)
+{
+    eat_until_newline(tokenizer);
+    if(tokenizer->at < tokenizer->one_past_end && *tokenizer->at == '\r')
+    {
+        tokenizer->at++;
+    }
+    if(tokenizer->at < tokenizer->one_past_end && *tokenizer->at == '\n')
+    {
+        tokenizer->at++;
+    }
+}
+
+// NOTE(joon) 128 bit approximations of 5^q, for q = [-65, 38], which covers every 
+// exponent that can produce a finite, non-zero f32 from a 64 bit mantissa.
+// Generated with the same script that fast_float uses.
+#define parser_smallest_power_of_five -65
+#define parser_largest_power_of_five 38
+global u64 parser_power_of_five_128[] = 
+{
+    0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull, // q = -65
+    0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull, // q = -64
+    0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull, // q = -63
+    0x83a3eeeef9153e89ull, 0x1953cf68300424acull, // q = -62
+    0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull, // q = -61
+    0xcdb02555653131b6ull, 0x3792f412cb06794dull, // q = -60
+    0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull, // q = -59
+    0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull, // q = -58
+    0xc8de047564d20a8bull, 0xf245825a5a445275ull, // q = -57
+    0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull, // q = -56
+    0x9ced737bb6c4183dull, 0x55464dd69685606bull, // q = -55
+    0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull, // q = -54
+    0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull, // q = -53
+    0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull, // q = -52
+    0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull, // q = -51
+    0xef73d256a5c0f77cull, 0x963e66858f6d4440ull, // q = -50
+    0x95a8637627989aadull, 0xdde7001379a44aa8ull, // q = -49
+    0xbb127c53b17ec159ull, 0x5560c018580d5d52ull, // q = -48
+    0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull, // q = -47
+    0x9226712162ab070dull, 0xcab3961304ca70e8ull, // q = -46
+    0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull, // q = -45
+    0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull, // q = -44
+    0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull, // q = -43
+    0xb267ed1940f1c61cull, 0x55f038b237591ed3ull, // q = -42
+    0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull, // q = -41
+    0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull, // q = -40
+    0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull, // q = -39
+    0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull, // q = -38
+    0x881cea14545c7575ull, 0x7e50d64177da2e54ull, // q = -37
+    0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull, // q = -36
+    0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull, // q = -35
+    0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull, // q = -34
+    0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull, // q = -33
+    0xcfb11ead453994baull, 0x67de18eda5814af2ull, // q = -32
+    0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull, // q = -31
+    0xa2425ff75e14fc31ull, 0xa1258379a94d028dull, // q = -30
+    0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull, // q = -29
+    0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull, // q = -28
+    0x9e74d1b791e07e48ull, 0x775ea264cf55347eull, // q = -27
+    0xc612062576589ddaull, 0x95364afe032a819eull, // q = -26
+    0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull, // q = -25
+    0x9abe14cd44753b52ull, 0xc4926a9672793543ull, // q = -24
+    0xc16d9a0095928a27ull, 0x75b7053c0f178294ull, // q = -23
+    0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull, // q = -22
+    0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull, // q = -21
+    0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull, // q = -20
+    0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull, // q = -19
+    0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull, // q = -18
+    0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull, // q = -17
+    0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull, // q = -16
+    0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull, // q = -15
+    0xb424dc35095cd80full, 0x538484c19ef38c95ull, // q = -14
+    0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull, // q = -13
+    0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull, // q = -12
+    0xafebff0bcb24aafeull, 0xf78f69a51539d749ull, // q = -11
+    0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull, // q = -10
+    0x89705f4136b4a597ull, 0x31680a88f8953031ull, // q = -9
+    0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull, // q = -8
+    0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull, // q = -7
+    0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull, // q = -6
+    0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull, // q = -5
+    0xd1b71758e219652bull, 0xd3c36113404ea4a9ull, // q = -4
+    0x83126e978d4fdf3bull, 0x645a1cac083126eaull, // q = -3
+    0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull, // q = -2
+    0xccccccccccccccccull, 0xcccccccccccccccdull, // q = -1
+    0x8000000000000000ull, 0x0000000000000000ull, // q = 0
+    0xa000000000000000ull, 0x0000000000000000ull, // q = 1
+    0xc800000000000000ull, 0x0000000000000000ull, // q = 2
+    0xfa00000000000000ull, 0x0000000000000000ull, // q = 3
+    0x9c40000000000000ull, 0x0000000000000000ull, // q = 4
+    0xc350000000000000ull, 0x0000000000000000ull, // q = 5
+    0xf424000000000000ull, 0x0000000000000000ull, // q = 6
+    0x9896800000000000ull, 0x0000000000000000ull, // q = 7
+    0xbebc200000000000ull, 0x0000000000000000ull, // q = 8
+    0xee6b280000000000ull, 0x0000000000000000ull, // q = 9
+    0x9502f90000000000ull, 0x0000000000000000ull, // q = 10
+    0xba43b74000000000ull, 0x0000000000000000ull, // q = 11
+    0xe8d4a51000000000ull, 0x0000000000000000ull, // q = 12
+    0x9184e72a00000000ull, 0x0000000000000000ull, // q = 13
+    0xb5e620f480000000ull, 0x0000000000000000ull, // q = 14
+    0xe35fa931a0000000ull, 0x0000000000000000ull, // q = 15
+    0x8e1bc9bf04000000ull, 0x0000000000000000ull, // q = 16
+    0xb1a2bc2ec5000000ull, 0x0000000000000000ull, // q = 17
+    0xde0b6b3a76400000ull, 0x0000000000000000ull, // q = 18
+    0x8ac7230489e80000ull, 0x0000000000000000ull, // q = 19
+    0xad78ebc5ac620000ull, 0x0000000000000000ull, // q = 20
+    0xd8d726b7177a8000ull, 0x0000000000000000ull, // q = 21
+    0x878678326eac9000ull, 0x0000000000000000ull, // q = 22
+    0xa968163f0a57b400ull, 0x0000000000000000ull, // q = 23
+    0xd3c21bcecceda100ull, 0x0000000000000000ull, // q = 24
+    0x84595161401484a0ull, 0x0000000000000000ull, // q = 25
+    0xa56fa5b99019a5c8ull, 0x0000000000000000ull, // q = 26
+    0xcecb8f27f4200f3aull, 0x0000000000000000ull, // q = 27
+    0x813f3978f8940984ull, 0x4000000000000000ull, // q = 28
+    0xa18f07d736b90be5ull, 0x5000000000000000ull, // q = 29
+    0xc9f2c9cd04674edeull, 0xa400000000000000ull, // q = 30
+    0xfc6f7c4045812296ull, 0x4d00000000000000ull, // q = 31
+    0x9dc5ada82b70b59dull, 0xf020000000000000ull, // q = 32
+    0xc5371912364ce305ull, 0x6c28000000000000ull, // q = 33
+    0xf684df56c3e01bc6ull, 0xc732000000000000ull, // q = 34
+    0x9a130b963a6c115cull, 0x3c7f400000000000ull, // q = 35
+    0xc097ce7bc90715b3ull, 0x4b9f100000000000ull, // q = 36
+    0xf0bdc21abb48db20ull, 0x1e86d40000000000ull, // q = 37
+    0x96769950b50d88f4ull, 0x1314448000000000ull, // q = 38
+};
+
+struct ParserU128
+{
+    u64 low;
+    u64 high;
+};
+
+inline ParserU128
+parser_multiply_u64(u64 a, u64 b)
+{
+    ParserU128 result;
+    unsigned __int128 product = (unsigned __int128)a*b;
+    result.low = (u64)product;
+    result.high = (u64)(product >> 64);
+    return result;
+}
+
+inline u32
+parser_count_leading_zeros_u64(u64 value)
+{
+    assert(value);
+    return (u32)__builtin_clzll(value);
+}
+
+inline f32
+f32_from_bits(u32 bits)
+{
+    f32 result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+// NOTE(joon) Eisel-Lemire algorithm for f32. Returns false if the result cannot be 
+// decided with the 128 bit product(which can only happen when w was truncated).
+// The result is correctly rounded(round to nearest, ties to even), same as strtof.
+internal b32
+compute_f32_eisel_lemire(u64 w, i64 q, u32 *bits)
+{
+    // these are the constants of the binary32 format
+    i32 mantissa_explicit_bits = 23;
+    i32 minimum_exponent = -127;
+    i32 infinite_power = 0xff;
+    i32 min_exponent_round_to_even = -17;
+    i32 max_exponent_round_to_even = 10;
+
+    if(w == 0 || q < parser_smallest_power_of_five + 1)
+    {
+        *bits = 0;
+        return true;
+    }
+    if(q > parser_largest_power_of_five)
+    {
+        *bits = (u32)infinite_power << mantissa_explicit_bits;
+        return true;
+    }
+
+    u32 lz = parser_count_leading_zeros_u64(w);
+    w <<= lz;
+
+    // NOTE(joon) we only need mantissa_explicit_bits + 3 bits of precision, 
+    // only go for the second product if the lower bits of the first one are all ones
+    u32 index = 2*(u32)(q - parser_smallest_power_of_five);
+    ParserU128 product = parser_multiply_u64(w, parser_power_of_five_128[index]);
+    u64 precision_mask = 0xffffffffffffffffull >> (mantissa_explicit_bits + 3);
+    if((product.high & precision_mask) == precision_mask)
+    {
+        ParserU128 second_product = parser_multiply_u64(w, parser_power_of_five_128[index + 1]);
+        product.low += second_product.high;
+        if(second_product.high > product.low)
+        {
+            product.high++;
+        }
+    }
+
+    i32 upper_bit = (i32)(product.high >> 63);
+    i32 shift = upper_bit + 64 - mantissa_explicit_bits - 3;
+    u64 mantissa = product.high >> shift;
+    // NOTE(joon) floor(log2(10^q)) = ((152170 + 65536)*q) >> 16
+    i32 power2 = (i32)((((152170 + 65536)*q) >> 16) + 63) + upper_bit - (i32)lz - minimum_exponent;
+
+    if(power2 <= 0)
+    {
+        // subnormal
+        if(-power2 + 1 >= 64)
+        {
+            *bits = 0;
+            return true;
+        }
+
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2 = (mantissa < ((u64)1 << mantissa_explicit_bits)) ? 0 : 1;
+
+        *bits = (u32)mantissa | ((u32)power2 << mantissa_explicit_bits);
+        return true;
+    }
+
+    // NOTE(joon) exactly halfway between two floats, round to even
+    if(product.low <= 1 && 
+       q >= min_exponent_round_to_even && 
+       q <= max_exponent_round_to_even &&
+       (mantissa & 3) == 1)
+    {
+        if((mantissa << shift) == product.high)
+        {
+            mantissa &= ~(u64)1;
+        }
+    }
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if(mantissa >= ((u64)2 << mantissa_explicit_bits))
+    {
+        mantissa = ((u64)1 << mantissa_explicit_bits);
+        power2++;
+    }
+
+    mantissa &= ~((u64)1 << mantissa_explicit_bits);
+    if(power2 >= infinite_power)
+    {
+        *bits = (u32)infinite_power << mantissa_explicit_bits;
+        return true;
+    }
+
+    *bits = (u32)mantissa | ((u32)power2 << mantissa_explicit_bits);
+    return true;
+}
+
+inline b32
+is_ascii_alphanumeric(u8 c)
+{
+    b32 result = ((c >= '0' && c <= '9') || 
+                  (c >= 'a' && c <= 'z') ||
+                  (c >= 'A' && c <= 'Z'));
+    return result;
+}
+
+// NOTE(joon) case insensitive compare of the keyword, which should be in lowercase
+internal b32
+match_numeric_keyword(u8 *at, u8 *one_past_end, const char *keyword)
+{
+    while(*keyword)
+    {
+        if(at == one_past_end || (*at | 0x20) != (u8)*keyword)
+        {
+            return false;
+        }
+        at++;
+        keyword++;
+    }
+
+    return true;
+}
+
+// NOTE(joon) returns how many bytes the inf/nan token takes, or 0 if there is no inf/nan token
+internal u32
+get_inf_or_nan_length(u8 *at, u8 *one_past_end)
+{
+    u32 result = 0;
+
+    if(match_numeric_keyword(at, one_past_end, "infinity"))
+    {
+        result = 8;
+    }
+    else if(match_numeric_keyword(at, one_past_end, "inf") ||
+            match_numeric_keyword(at, one_past_end, "nan"))
+    {
+        result = 3;
+    }
+
+    // NOTE(joon) don't confuse words like 'intensity' or 'nanometer' with inf/nan
+    if(result && at + result < one_past_end && is_ascii_alphanumeric(at[result]))
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+// NOTE(joon) SWAR digit check & conversion of 8 ascii digits(little endian load)
+inline b32
+is_made_of_eight_digits(u64 value)
+{
+    b32 result = ((((value & 0xf0f0f0f0f0f0f0f0ull) | 
+                   (((value + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4)) == 
+                  0x3333333333333333ull));
+    return result;
+}
+
+inline u32
+parse_eight_digits(u64 value)
+{
+    u64 mask = 0x000000ff000000ffull;
+    u64 mul1 = 0x000f424000000064ull; // 100 + (1000000ULL << 32)
+    u64 mul2 = 0x0000271000000001ull; // 1 + (10000ULL << 32)
+    value -= 0x3030303030303030ull;
+    value = (value * 10) + (value >> 8); // value = (value * 2561) >> 8;
+    value = (((value & mask) * mul1) + (((value >> 16) & mask) * mul2)) >> 32;
+
+    return (u32)value;
+}
+
+// NOTE(joon) how many of the first 8 bytes are digits, with one SWAR compare.
+// Bytes after the first non digit can be anything(including the carry from +6),
+// since only the first non digit matters.
+inline u32
+count_leading_digits_swar(u64 value)
+{
+    u64 non_digits = (((value & 0xf0f0f0f0f0f0f0f0ull) ^ 0x3030303030303030ull) |
+                      (((value + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) ^ 0x3030303030303030ull));
+
+    u32 result = 8;
+    if(non_digits)
+    {
+        result = (u32)__builtin_ctzll(non_digits)/8;
+    }
+
+    return result;
+}
+
+#if PARSER_X64
+// NOTE(joon) same with sse2, for 16 bytes
+inline u32
+count_leading_digits_sse2(u8 *at)
+{
+    __m128i bytes = _mm_loadu_si128((__m128i *)at);
+    __m128i digits = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    // unsigned digits <= 9
+    __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+
+    u32 mask = (u32)_mm_movemask_epi8(is_digit);
+    u32 result = parser_count_trailing_zeros(~mask);
+    return result;
+}
+#endif
+
+// NOTE(joon) unsigned decimal integer, used for the face indices.
+// The digits are found with one compare mask, and up to 8 digits are converted at once
+// with the same multiply-add reduction as parse_eight_digits(after padding the front with '0's).
+// Returns where the integer ends, or 0 if there is no digit or more than 9 digits(which might overflow).
+internal u8 *
+decode_parser_small_integer(u8 *at, u8 *one_past_end, u32 *value)
+{
+    u8 *result = 0;
+
+    u32 digit_count = 0;
+#if PARSER_X64
+    if(parser_simd_level >= parser_simd_level_sse2 && at + 16 <= one_past_end)
+    {
+        digit_count = count_leading_digits_sse2(at);
+    }
+    else
+#endif
+    if(at + 10 <= one_past_end)
+    {
+        u64 word;
+        memcpy(&word, at, 8);
+        digit_count = count_leading_digits_swar(word);
+        if(digit_count == 8 && (u32)(at[8] - '0') < 10)
+        {
+            digit_count = ((u32)(at[9] - '0') < 10) ? 10 : 9;
+        }
+    }
+    else
+    {
+        // NOTE(joon) close to the end, one by one
+        while(at + digit_count < one_past_end &&
+              digit_count < 10 &&
+              (u32)(at[digit_count] - '0') < 10)
+        {
+            digit_count++;
+        }
+
+        if(digit_count && digit_count <= 9)
+        {
+            u32 integer = 0;
+            for(u32 digit_index = 0;
+                    digit_index < digit_count;
+                    ++digit_index)
+            {
+                integer = 10*integer + (at[digit_index] - '0');
+            }
+
+            *value = integer;
+            result = at + digit_count;
+        }
+
+        return result;
+    }
+
+    if(digit_count && digit_count <= 8)
+    {
+        u64 word;
+        memcpy(&word, at, 8);
+        if(digit_count < 8)
+        {
+            word = (word << (8*(8 - digit_count))) | (0x3030303030303030ull >> (8*digit_count));
+        }
+
+        *value = parse_eight_digits(word);
+        result = at + digit_count;
+    }
+    else if(digit_count == 9)
+    {
+        u64 word;
+        memcpy(&word, at, 8);
+        *value = 10*parse_eight_digits(word) + (at[8] - '0');
+        result = at + 9;
+    }
+
+    return result;
+}
+
+// NOTE(joon) f32 needs at most ~112 significant digits to round correctly, the rest only matters as 'nonzero or not'
+#define parser_strtof_max_digit_count 800
+
+// NOTE(joon) parses [+-]digits[.digits][(e|E)[+-]digits], or inf/nan.
+// Numbers without '.' and exponent are returned as i32, everything else is a 
+// correctly rounded f32(bit exact with strtof).
+internal ParseNumericResult
+eat_numeric(Tokenizer *tokenizer)
+{
+    ParseNumericResult result = {};
+
+    u8 *at = tokenizer->at;
+    u8 *one_past_end = tokenizer->one_past_end;
+
+    b32 negative = false;
+    if(at < one_past_end && (*at == '-' || *at == '+'))
+    {
+        negative = (*at == '-');
+        at++;
+    }
+
+    u32 inf_or_nan_length = get_inf_or_nan_length(at, one_past_end);
+    if(inf_or_nan_length)
+    {
+        result.is_float = true;
+        result.value_f32 = ((*at | 0x20) == 'i') ? f32_from_bits(0x7f800000) : f32_from_bits(0x7fc00000);
+        if(negative)
+        {
+            result.value_f32 = -result.value_f32;
+        }
+
+        tokenizer->at = at + inf_or_nan_length;
+        return result;
+    }
+
+    // NOTE(joon) common case : the mantissa has less than 20 digits and fits inside u64
+    u64 w = 0;
+    i64 exponent = 0;
+    b32 truncated = false;
+
+    u8 *integer_start = at;
+    while(at < one_past_end && (u32)(*at - '0') < 10)
+    {
+        w = 10*w + (*at - '0');
+        at++;
+    }
+    i64 digit_count = at - integer_start;
+
+    if(at < one_past_end && *at == '.')
+    {
+        result.is_float = true;
+        at++;
+
+        u8 *fraction_start = at;
+        u64 eight_digits;
+        while(at + 8 <= one_past_end && 
+             (memcpy(&eight_digits, at, 8), is_made_of_eight_digits(eight_digits)))
+        {
+            w = 100000000*w + parse_eight_digits(eight_digits);
+            at += 8;
+        }
+        while(at < one_past_end && (u32)(*at - '0') < 10)
+        {
+            w = 10*w + (*at - '0');
+            at++;
+        }
+
+        exponent = -(at - fraction_start);
+        digit_count += (at - fraction_start);
+    }
+
+    if(digit_count > 19)
+    {
+        // NOTE(joon) w might have overflowed, do it again slowly. 
+        // Only the first 19 significant digits go into w, 
+        // the rest only adjusts the exponent and marks the mantissa as truncated
+        w = 0;
+        exponent = 0;
+        u32 significant_digit_count = 0;
+
+        u8 *digit_at = integer_start;
+        b32 after_dot = false;
+        for(;
+            digit_at < at;
+            ++digit_at)
+        {
+            if(*digit_at == '.')
+            {
+                after_dot = true;
+                continue;
+            }
+
+            u32 digit = *digit_at - '0';
+            if(significant_digit_count < 19)
+            {
+                w = 10*w + digit;
+                significant_digit_count += (w != 0);
+                exponent -= after_dot;
+            }
+            else
+            {
+                exponent += !after_dot;
+                truncated |= (digit != 0);
+            }
+        }
+    }
+
+    u8 *mantissa_one_past_end = at;
+    i64 written_exponent = 0;
+    if(at < one_past_end && (*at == 'e' || *at == 'E'))
+    {
+        // -5.4335527188698052e-09
+        u8 *exponent_start = at;
+        at++;
+
+        b32 exponent_negative = false;
+        if(at < one_past_end && (*at == '-' || *at == '+'))
+        {
+            exponent_negative = (*at == '-');
+            at++;
+        }
+
+        if(at < one_past_end && (u32)(*at - '0') < 10)
+        {
+            result.is_float = true;
+
+            i64 explicit_exponent = 0;
+            while(at < one_past_end && (u32)(*at - '0') < 10)
+            {
+                // NOTE(joon) anything bigger than this is either 0 or inf anyway
+                if(explicit_exponent < 0x10000)
+                {
+                    explicit_exponent = 10*explicit_exponent + (*at - '0');
+                }
+                at++;
+            }
+
+            written_exponent = exponent_negative ? -explicit_exponent : explicit_exponent;
+            exponent += written_exponent;
+        }
+        else
+        {
+            // NOTE(joon) 'e' without any digits is not part of this number
+            at = exponent_start;
+        }
+    }
+
+    tokenizer->at = at;
+
+    if(!result.is_float)
+    {
+        result.value_i32 = negative ? -(i32)w : (i32)w;
+        return result;
+    }
+
+    // NOTE(joon) fast path : both w and 10^|exponent| are exact in f32, 
+    // so one IEEE multiply/divide gives the correctly rounded result
+    local_persist f32 exact_powers_of_ten[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    if(!truncated && 
+       exponent >= -10 && exponent <= 10 && 
+       w <= ((u64)1 << 24))
+    {
+        f32 value = (f32)w;
+        if(exponent < 0)
+        {
+            value = value / exact_powers_of_ten[-exponent];
+        }
+        else
+        {
+            value = value * exact_powers_of_ten[exponent];
+        }
+
+        result.value_f32 = negative ? -value : value;
+        return result;
+    }
+
+    u32 bits = 0;
+    b32 decided = compute_f32_eisel_lemire(w, exponent, &bits);
+    if(decided && truncated)
+    {
+        // NOTE(joon) the real mantissa is somewhere between w and w+1, 
+        // if both of them round to the same float, that's the answer
+        u32 upper_bits = 0;
+        if(!compute_f32_eisel_lemire(w + 1, exponent, &upper_bits) || 
+            upper_bits != bits)
+        {
+            decided = false;
+        }
+    }
+
+    if(decided)
+    {
+        result.value_f32 = f32_from_bits(bits);
+        if(negative)
+        {
+            result.value_f32 = -result.value_f32;
+        }
+    }
+    else
+    {
+        // NOTE(joon) extremely rare(more than 19 digits, sitting right on the halfway point), 
+        // let the c runtime deal with it. The number can be arbitrarily long, so only the first 
+        // parser_strtof_max_digit_count significant digits are given to strtof, plus one sticky 1 if any of 
+        // the dropped digits was not 0(that's all it needs to round the halfway cases), and the exponent is adjusted.
+        char buffer[parser_strtof_max_digit_count + 32];
+        u32 length = 0;
+        if(negative)
+        {
+            buffer[length++] = '-';
+        }
+
+        i64 digit_exponent = written_exponent;
+        u32 kept_digit_count = 0;
+        b32 dropped_nonzero = false;
+        b32 after_dot = false;
+        for(u8 *digit_at = integer_start;
+                digit_at < mantissa_one_past_end;
+                ++digit_at)
+        {
+            if(*digit_at == '.')
+            {
+                after_dot = true;
+                continue;
+            }
+
+            u8 digit = *digit_at;
+            if(kept_digit_count == 0 && digit == '0')
+            {
+                // leading zero
+                digit_exponent -= after_dot;
+            }
+            else if(kept_digit_count < parser_strtof_max_digit_count)
+            {
+                buffer[length++] = (char)digit;
+                kept_digit_count++;
+                digit_exponent -= after_dot;
+            }
+            else
+            {
+                digit_exponent += !after_dot;
+                dropped_nonzero |= (digit != '0');
+            }
+        }
+
+        if(kept_digit_count == 0)
+        {
+            buffer[length++] = '0';
+        }
+        if(dropped_nonzero)
+        {
+            buffer[length++] = '1';
+            digit_exponent--;
+        }
+        snprintf(buffer + length, sizeof(buffer) - length, "e%lld", (long long)digit_exponent);
+
+        // NOTE(joon) always the "C" locale, so that the host's LC_NUMERIC can't change the result
+        local_persist locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", 0);
+        result.value_f32 = strtof_l(buffer, 0, c_locale);
+    }
+
+    return result;
+}
+
+internal void
+numeric_obj_token_to_f32(ObjToken token, f32 *dest)
+{
+    if(token.type == obj_token_type_f32)
+    {
+        *dest = token.value_f32;
+    }
+    else if(token.type == obj_token_type_i32)
+    {
+        *dest = (f32)token.value_i32;
+    }
+    else
+    {
+        invalid_code_path;
+    }
+}
+
+
+
+// NOTE(joon) sign or digit. Written without the short circuits, 
+// so that the numbers(which are most of the tokens) only pay for one branch
+inline b32
+is_digit_or_sign(u8 c)
+{
+    b32 result = (((u32)(c - '0') < 10) | (c == '-') | (c == '+'));
+    return result;
+}
+
+// NOTE(joon) up to max_length(<= 8) bytes starting from at as a little endian u64, 
+// the bytes after that(or after the end of the file) are 0. 
+// Used to compare the keywords with one integer compare.
+inline u64
+load_parser_word(u8 *at, u8 *one_past_end, u32 max_length)
+{
+    assert(max_length <= 8);
+
+    u64 result = 0;
+    u32 length = ((size_t)(one_past_end - at) < max_length) ? (u32)(one_past_end - at) : max_length;
+    if(length == 8)
+    {
+        memcpy(&result, at, 8);
+    }
+    else
+    {
+        memcpy(&result, at, length);
+    }
+
+#if PARSER_BIG_ENDIAN
+    result = parser_byte_swap_u64(result);
+#endif
+
+    return result;
+}
+
+// NOTE(joon) keyword as the word that load_parser_word would return, and the mask of its length
+#define parser_word(a, b, c, d, e, f, g, h) \
+    ((u64)(u8)(a) | ((u64)(u8)(b) << 8) | ((u64)(u8)(c) << 16) | ((u64)(u8)(d) << 24) | \
+     ((u64)(u8)(e) << 32) | ((u64)(u8)(f) << 40) | ((u64)(u8)(g) << 48) | ((u64)(u8)(h) << 56))
+#define parser_word_mask(length) ((length) >= 8 ? 0xffffffffffffffffull : ((1ull << (8*(length))) - 1))
+
+struct PlyKeyword
+{
+    const char *string;
+    u32 length;
+    PlyTokenType type;
+};
+
+global PlyKeyword ply_keywords[] = 
+{
+    {"element", 7, ply_token_type_element},
+    {"vertex", 6, ply_token_type_vertex},
+    {"face", 4, ply_token_type_face},
+    {"end_header", 10, ply_token_type_end_header},
+    {"property", 8, ply_token_type_property},
+    {"list", 4, ply_token_type_list},
+    {"vertex_index", 12, ply_token_type_vertex_index},
+    {"vertex_indices", 14, ply_token_type_vertex_indices},
+
+    {"format", 6, ply_token_type_format},
+    {"ascii", 5, ply_token_type_ascii},
+    {"binary_little_endian", 20, ply_token_type_binary_little_endian},
+    {"binary_big_endian", 17, ply_token_type_binary_big_endian},
+
+    {"char", 4, ply_token_type_char},
+    {"int8", 4, ply_token_type_int8},
+    {"uchar", 5, ply_token_type_uchar},
+    {"uint8", 5, ply_token_type_uint8},
+    {"short", 5, ply_token_type_short},
+    {"int16", 5, ply_token_type_int16},
+    {"ushort", 6, ply_token_type_ushort},
+    {"uint16", 6, ply_token_type_uint16},
+    {"int", 3, ply_token_type_int},
+    {"int32", 5, ply_token_type_int32},
+    {"uint", 4, ply_token_type_uint},
+    {"uint32", 6, ply_token_type_uint32},
+    {"float", 5, ply_token_type_float},
+    {"float32", 7, ply_token_type_float32},
+    {"double", 6, ply_token_type_double},
+    {"float64", 7, ply_token_type_float64},
+
+    // NOTE(joon) the rest of the line is skipped for these two
+    {"comment", 7, ply_token_type_comment},
+    {"obj_info", 8, ply_token_type_comment},
+};
+
+// NOTE(joon) perfect hash of the ply keywords, from the first 8 bytes and the length of the word. 
+// The slots store the index to ply_keywords + 1(0 means empty). 
+// The multiplier was found by trying random odd numbers until none of the keywords collided, 
+// so if a keyword is added or reordered, both the multiplier and the slots have to be generated again.
+#define ply_keyword_hash_multiplier 0x56c11669a4ba3161ull
+#define ply_keyword_hash_shift 58
+global u8 ply_keyword_slots[64] = 
+{
+    9, 28, 21, 0, 8, 0, 0, 15, 0, 0, 14, 0, 10, 0, 0, 0, 
+    2, 0, 0, 0, 0, 0, 19, 0, 6, 25, 0, 0, 11, 26, 20, 0, 
+    29, 4, 0, 0, 27, 0, 30, 0, 0, 12, 0, 16, 18, 5, 3, 0, 
+    7, 0, 0, 0, 0, 17, 24, 1, 13, 0, 0, 0, 22, 0, 0, 23,
+};
+
+// NOTE(joon) returns the keyword that matches the whole word, or 0
+inline PlyKeyword *
+find_ply_keyword(u8 *word, u32 length)
+{
+    PlyKeyword *result = 0;
+
+    u64 prefix = load_parser_word(word, word + length, 8);
+    u32 slot_index = (u32)(((prefix ^ length)*ply_keyword_hash_multiplier) >> ply_keyword_hash_shift);
+    u32 keyword_index = ply_keyword_slots[slot_index];
+    if(keyword_index)
+    {
+        PlyKeyword *keyword = ply_keywords + keyword_index - 1;
+        if(keyword->length == length && 
+           memcmp(keyword->string, word, length) == 0)
+        {
+            result = keyword;
+        }
+    }
+
+    return result;
+}
+
+internal PlyToken
+eat_ply_token_no_lookahead(Tokenizer *tokenizer)
+{
+    PlyToken result = {};
+
+    // NOTE(joon) eat all the unnecessary charcters(whilespace, newline...)
+    eat_all_whitespaces(tokenizer);
+
+    if(tokenizer->at < tokenizer->one_past_end)
+    {
+        if(is_digit_or_sign(*tokenizer->at) || 
+           get_inf_or_nan_length(tokenizer->at, tokenizer->one_past_end))
+        {
+            ParseNumericResult parse_numeric_result = eat_numeric(tokenizer);
+
+            if(parse_numeric_result.is_float)
+            {
+                result.type = ply_token_type_f32;
+                result.value_f32 = parse_numeric_result.value_f32;
+                result.is_float = true;
+            }
+            else
+            {
+                result.type = ply_token_type_i32;
+                result.value_i32 = parse_numeric_result.value_i32;
+                result.is_float = false;
+            }
+        }
+        else
+        {
+            u8 *word = tokenizer->at;
+            eat_until_whitespace(tokenizer);
+
+            // NOTE(joon) words that we don't care about(ply, property names...) 
+            // are skipped too, so that the caller doesn't get stuck here
+            PlyKeyword *keyword = find_ply_keyword(word, (u32)(tokenizer->at - word));
+            if(keyword)
+            {
+                result.type = keyword->type;
+                if(result.type == ply_token_type_comment)
+                {
+                    eat_until_newline(tokenizer);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+inline b32
+has_tokenizer_lookahead(Tokenizer *tokenizer, TokenizerLookaheadType type)
+{
+    b32 result = (tokenizer->lookahead_at == tokenizer->at &&
+                  tokenizer->lookahead_type == type &&
+                  tokenizer->lookahead_one_past_end == tokenizer->one_past_end);
+    return result;
+}
+
+// NOTE(joon) remembers where the token that was just parsed by peek ends
+inline void
+set_tokenizer_lookahead(Tokenizer *tokenizer, TokenizerLookaheadType type, u8 *next_at)
+{
+    tokenizer->lookahead_type = type;
+    tokenizer->lookahead_at = tokenizer->at;
+    tokenizer->lookahead_one_past_end = tokenizer->one_past_end;
+    tokenizer->lookahead_next_at = next_at;
+}
+
+internal PlyToken
+eat_ply_token(Tokenizer *tokenizer)
+{
+    PlyToken result;
+    if(has_tokenizer_lookahead(tokenizer, tokenizer_lookahead_type_ply))
+    {
+        result = tokenizer->lookahead_ply;
+        tokenizer->at = tokenizer->lookahead_next_at;
+    }
+    else
+    {
+        result = eat_ply_token_no_lookahead(tokenizer);
+    }
+
+    return result;
+}
+
+internal PlyToken
+eat_and_check_ply_token(Tokenizer *tokenizer, PlyTokenType expected_type)
+{
+    PlyToken result = eat_ply_token(tokenizer);
+    assert(result.type == expected_type);
+
+    return result;
+}
+
+internal PlyToken
+peek_ply_token(Tokenizer *tokenizer)
+{
+    if(!has_tokenizer_lookahead(tokenizer, tokenizer_lookahead_type_ply))
+    {
+        Tokenizer peek_tokenizer = {};
+        peek_tokenizer.at = tokenizer->at;
+        peek_tokenizer.one_past_end = tokenizer->one_past_end;
+
+        tokenizer->lookahead_ply = eat_ply_token_no_lookahead(&peek_tokenizer);
+        set_tokenizer_lookahead(tokenizer, tokenizer_lookahead_type_ply, peek_tokenizer.at);
+    }
+
+    PlyToken result = tokenizer->lookahead_ply;
+    return result;
+}
+
+internal PlyScalarType
+get_ply_scalar_type(PlyTokenType token_type)
+{
+    PlyScalarType result = ply_scalar_type_null;
+    switch(token_type)
+    {
+        case ply_token_type_char:
+        case ply_token_type_int8:
+        {
+            result = ply_scalar_type_i8;
+        }break;
+        case ply_token_type_uchar:
+        case ply_token_type_uint8:
+        {
+            result = ply_scalar_type_u8;
+        }break;
+        case ply_token_type_short:
+        case ply_token_type_int16:
+        {
+            result = ply_scalar_type_i16;
+        }break;
+        case ply_token_type_ushort:
+        case ply_token_type_uint16:
+        {
+            result = ply_scalar_type_u16;
+        }break;
+        case ply_token_type_int:
+        case ply_token_type_int32:
+        {
+            result = ply_scalar_type_i32;
+        }break;
+        case ply_token_type_uint:
+        case ply_token_type_uint32:
+        {
+            result = ply_scalar_type_u32;
+        }break;
+        case ply_token_type_float:
+        case ply_token_type_float32:
+        {
+            result = ply_scalar_type_f32;
+        }break;
+        case ply_token_type_double:
+        case ply_token_type_float64:
+        {
+            result = ply_scalar_type_f64;
+        }break;
+
+        default:
+        {
+            invalid_code_path;
+        }break;
+    }
+
+    return result;
+}
+
+internal u32
+get_ply_scalar_size(PlyScalarType type)
+{
+    local_persist u32 sizes[] = {0, 1, 1, 2, 2, 4, 4, 4, 8};
+    u32 result = sizes[type];
+    return result;
+}
+
+inline PlyElement *
+get_ply_vertex_element(ParsePlyHeaderResult *header)
+{
+    PlyElement *result = header->elements + header->vertex_element_index;
+    return result;
+}
+
+inline PlyElement *
+get_ply_face_element(ParsePlyHeaderResult *header)
+{
+    PlyElement *result = header->elements + header->face_element_index;
+    return result;
+}
+
+// NOTE(joon) copies the next word as it is(element and property names can be anything), 
+// cut to fit inside ply_max_name_length
+internal void
+eat_ply_name(Tokenizer *tokenizer, char *name)
+{
+    eat_all_whitespaces(tokenizer);
+
+    u8 *word = tokenizer->at;
+    eat_until_whitespace(tokenizer);
+
+    u32 length = (u32)(tokenizer->at - word);
+    if(length > ply_max_name_length - 1)
+    {
+        length = ply_max_name_length - 1;
+    }
+    memcpy(name, word, length);
+    name[length] = 0;
+}
+
+inline b32
+is_ply_name(char *name, const char *string)
+{
+    b32 result = (strcmp(name, string) == 0);
+    return result;
+}
+
+struct PlyVertexSchemaInfo
+{
+    PlyVertexSchema schema;
+    u32 property_count;
+    const char *names[8];
+    PlyScalarType types[8];
+};
+
+// NOTE(joon) float and float32 are the same scalar type, so both spellings of the header match
+global PlyVertexSchemaInfo ply_vertex_schemas[] = 
+{
+    {ply_vertex_schema_xyz, 3, {"x", "y", "z"}, 
+        {ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32}},
+    {ply_vertex_schema_xyz_normal, 6, {"x", "y", "z", "nx", "ny", "nz"}, 
+        {ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32}},
+    {ply_vertex_schema_xyz_confidence_intensity, 5, {"x", "y", "z", "confidence", "intensity"}, 
+        {ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32}},
+    {ply_vertex_schema_xyz_rgb, 6, {"x", "y", "z", "red", "green", "blue"}, 
+        {ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_u8, ply_scalar_type_u8, ply_scalar_type_u8}},
+    {ply_vertex_schema_xyz_rgba, 7, {"x", "y", "z", "red", "green", "blue", "alpha"}, 
+        {ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_f32, ply_scalar_type_u8, ply_scalar_type_u8, ply_scalar_type_u8, ply_scalar_type_u8}},
+};
+
+internal PlyVertexSchema
+get_ply_vertex_schema(PlyElement *vertex_element)
+{
+    PlyVertexSchema result = ply_vertex_schema_generic;
+    for(u32 schema_index = 0;
+            schema_index < sizeof(ply_vertex_schemas)/sizeof(ply_vertex_schemas[0]) && !result;
+            ++schema_index)
+    {
+        PlyVertexSchemaInfo *info = ply_vertex_schemas + schema_index;
+        if(info->property_count == vertex_element->property_count)
+        {
+            b32 matched = true;
+            for(u32 property_index = 0;
+                    property_index < info->property_count && matched;
+                    ++property_index)
+            {
+                PlyProperty *property = vertex_element->properties + property_index;
+                matched = (!property->list_count_type && 
+                           property->type == info->types[property_index] && 
+                           is_ply_name(property->name, info->names[property_index]));
+            }
+
+            if(matched)
+            {
+                result = info->schema;
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE(joon) reads one binary ply scalar, which might not be aligned
+internal f64
+read_ply_scalar(u8 *at, PlyScalarType type, b32 swap)
+{
+    f64 result = 0;
+    switch(type)
+    {
+        case ply_scalar_type_i8:
+        {
+            result = (f64)(i8)*at;
+        }break;
+        case ply_scalar_type_u8:
+        {
+            result = (f64)*at;
+        }break;
+        case ply_scalar_type_i16:
+        case ply_scalar_type_u16:
+        {
+            u16 value;
+            memcpy(&value, at, sizeof(value));
+            if(swap)
+            {
+                value = parser_byte_swap_u16(value);
+            }
+            result = (type == ply_scalar_type_i16) ? (f64)(i16)value : (f64)value;
+        }break;
+        case ply_scalar_type_i32:
+        case ply_scalar_type_u32:
+        case ply_scalar_type_f32:
+        {
+            u32 value;
+            memcpy(&value, at, sizeof(value));
+            if(swap)
+            {
+                value = parser_byte_swap_u32(value);
+            }
+
+            if(type == ply_scalar_type_i32)
+            {
+                result = (f64)(i32)value;
+            }
+            else if(type == ply_scalar_type_u32)
+            {
+                result = (f64)value;
+            }
+            else
+            {
+                result = (f64)f32_from_bits(value);
+            }
+        }break;
+        case ply_scalar_type_f64:
+        {
+            u64 value;
+            memcpy(&value, at, sizeof(value));
+            if(swap)
+            {
+                value = parser_byte_swap_u64(value);
+            }
+            memcpy(&result, &value, sizeof(result));
+        }break;
+
+        default:
+        {
+            invalid_code_path;
+        }break;
+    }
+
+    return result;
+}
+
+inline u32
+read_ply_scalar_u32(u8 *at, PlyScalarType type, b32 swap)
+{
+    u32 result;
+    if(type == ply_scalar_type_u32 || type == ply_scalar_type_i32)
+    {
+        // NOTE(joon) doesn't go through f64, so that the big indices don't lose anything
+        memcpy(&result, at, sizeof(result));
+        if(swap)
+        {
+            result = parser_byte_swap_u32(result);
+        }
+    }
+    else
+    {
+        result = (u32)read_ply_scalar(at, type, swap);
+    }
+
+    return result;
+}
+
+// NOTE(joon) true if the binary body has to be byte swapped before being used on this machine
+inline b32
+is_ply_byte_swap_needed(PlyFormat format)
+{
+    b32 result = (format == ply_format_binary_big_endian) != PARSER_BIG_ENDIAN;
+    return result;
+}
+
+// NOTE(joon) if every vertex property has the same type, 
+// the whole vertex body is one contiguous run of that type
+internal PlyScalarType
+get_ply_uniform_vertex_type(ParsePlyHeaderResult *header)
+{
+    PlyScalarType result = ply_scalar_type_null;
+    if(header->vertex_property_count)
+    {
+        PlyProperty *properties = get_ply_vertex_element(header)->properties;
+        result = properties[0].type;
+        for(u32 property_index = 1;
+                property_index < header->vertex_property_count;
+                ++property_index)
+        {
+            if(properties[property_index].type != result)
+            {
+                result = ply_scalar_type_null;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE(joon) SSE2 kernels that convert a run of count scalars of the same type to f32, 
+// byte swapping them on the way if needed. Returns how many scalars were converted, 
+// the leftover is handled by the caller
+#if PARSER_X64
+inline __m128i
+byte_swap_u16x8(__m128i value)
+{
+    __m128i result = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+    return result;
+}
+
+inline __m128i
+byte_swap_u32x4(__m128i value)
+{
+    // swap the two 16 bit halves, and then the bytes inside each half
+    value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+    value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128i result = byte_swap_u16x8(value);
+    return result;
+}
+
+internal u64
+convert_ply_scalars_sse2(u8 *source, u64 count, PlyScalarType type, b32 swap, f32 *dest)
+{
+    u64 index = 0;
+    __m128i zero = _mm_setzero_si128();
+    switch(type)
+    {
+        case ply_scalar_type_u8:
+        case ply_scalar_type_i8:
+        {
+            for(;
+                index + 16 <= count;
+                index += 16)
+            {
+                __m128i value = _mm_loadu_si128((__m128i *)(source + index));
+
+                __m128i low16, high16;
+                if(type == ply_scalar_type_u8)
+                {
+                    low16 = _mm_unpacklo_epi8(value, zero);
+                    high16 = _mm_unpackhi_epi8(value, zero);
+                }
+                else
+                {
+                    // NOTE(joon) put the byte in the upper half, and then shift it down with the sign
+                    low16 = _mm_srai_epi16(_mm_unpacklo_epi8(value, value), 8);
+                    high16 = _mm_srai_epi16(_mm_unpackhi_epi8(value, value), 8);
+                }
+
+                // every value is now a valid i16, so the sign extension to i32 works for both
+                _mm_storeu_ps(dest + index + 0, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(low16, low16), 16)));
+                _mm_storeu_ps(dest + index + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(low16, low16), 16)));
+                _mm_storeu_ps(dest + index + 8, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(high16, high16), 16)));
+                _mm_storeu_ps(dest + index + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(high16, high16), 16)));
+            }
+        }break;
+
+        case ply_scalar_type_u16:
+        case ply_scalar_type_i16:
+        {
+            for(;
+                index + 8 <= count;
+                index += 8)
+            {
+                __m128i value = _mm_loadu_si128((__m128i *)(source + 2*index));
+                if(swap)
+                {
+                    value = byte_swap_u16x8(value);
+                }
+
+                __m128i low32, high32;
+                if(type == ply_scalar_type_u16)
+                {
+                    low32 = _mm_unpacklo_epi16(value, zero);
+                    high32 = _mm_unpackhi_epi16(value, zero);
+                }
+                else
+                {
+                    low32 = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+                    high32 = _mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16);
+                }
+
+                _mm_storeu_ps(dest + index + 0, _mm_cvtepi32_ps(low32));
+                _mm_storeu_ps(dest + index + 4, _mm_cvtepi32_ps(high32));
+            }
+        }break;
+
+        case ply_scalar_type_i32:
+        {
+            for(;
+                index + 4 <= count;
+                index += 4)
+            {
+                __m128i value = _mm_loadu_si128((__m128i *)(source + 4*index));
+                if(swap)
+                {
+                    value = byte_swap_u32x4(value);
+                }
+
+                _mm_storeu_ps(dest + index, _mm_cvtepi32_ps(value));
+            }
+        }break;
+
+        case ply_scalar_type_f32:
+        {
+            if(swap)
+            {
+                for(;
+                    index + 4 <= count;
+                    index += 4)
+                {
+                    __m128i value = _mm_loadu_si128((__m128i *)(source + 4*index));
+                    _mm_storeu_si128((__m128i *)(dest + index), byte_swap_u32x4(value));
+                }
+            }
+        }break;
+
+        default:
+        {
+            // NOTE(joon) u32 & f64 are rare enough, let the scalar loop handle them
+        }break;
+    }
+
+    return index;
+}
+#endif
+
+internal void
+convert_ply_scalars(u8 *source, u64 count, PlyScalarType type, b32 swap, f32 *dest)
+{
+    if(type == ply_scalar_type_f32 && !swap)
+    {
+        // NOTE(joon) fast path, already in the format that we want. 
+        // If the caller passed the records themselves(get_ply_vertices_in_place), there is nothing to do
+        if((u8 *)dest != source)
+        {
+            memcpy(dest, source, count*sizeof(f32));
+        }
+        return;
+    }
+
+    u64 index = 0;
+#if PARSER_X64
+    if(parser_simd_level >= parser_simd_level_sse2)
+    {
+        index = convert_ply_scalars_sse2(source, count, type, swap, dest);
+    }
+#endif
+
+    u32 size = get_ply_scalar_size(type);
+    for(;
+        index < count;
+        ++index)
+    {
+        dest[index] = (f32)read_ply_scalar(source + index*size, type, swap);
+    }
+}
+
+// NOTE(joon) fused decoder for the ascii face rows in the 'count i j k ...' form, 
+// using decode_parser_small_integer for all of the integers. 
+// Returns where the row ends, or 0 if the row isn't a plain list of non negative indices 
+// that ends at the newline(extra face properties, signs, big numbers, more than ply_fast_face_max_index_count indices...). 
+// In that case the caller should tokenize the row as usual.
+// at should be at the count.
+internal u8 *
+decode_ply_face_row_fast(u8 *at, u8 *one_past_end, PlyFastFace *face)
+{
+    u32 index_count;
+    at = decode_parser_small_integer(at, one_past_end, &index_count);
+    if(!at || index_count < 3 || index_count > ply_fast_face_max_index_count)
+    {
+        return 0;
+    }
+
+    for(u32 index_index = 0;
+            index_index < index_count;
+            ++index_index)
+    {
+        if(at == one_past_end || *at != ' ')
+        {
+            return 0;
+        }
+        while(at < one_past_end && *at == ' ')
+        {
+            at++;
+        }
+
+        at = decode_parser_small_integer(at, one_past_end, face->indices + index_index);
+        if(!at)
+        {
+            return 0;
+        }
+    }
+
+    while(at < one_past_end && *at == ' ')
+    {
+        at++;
+    }
+    if(at < one_past_end && !is_token_newline(*at))
+    {
+        return 0;
+    }
+
+    face->index_count = index_count;
+    return at;
+}
+
+// NOTE(joon) ascii face rows can have properties before the vertex indices(flags, or other lists), 
+// this moves the tokenizer past them so that it's at the index count. 
+// Does nothing for the usual 'count i j k ...' rows.
+internal void
+skip_ply_ascii_face_properties_before_indices(Tokenizer *tokenizer, ParsePlyHeaderResult *header)
+{
+    PlyElement *face_element = header->elements + header->face_element_index;
+    for(u32 property_index = 0;
+            property_index < header->face_index_property_index;
+            ++property_index)
+    {
+        PlyToken token = eat_ply_token(tokenizer);
+        if(face_element->properties[property_index].list_count_type)
+        {
+            assert(token.type == ply_token_type_i32 && token.value_i32 >= 0);
+            for(i32 item_index = 0;
+                    item_index < token.value_i32;
+                    ++item_index)
+            {
+                eat_ply_token(tokenizer);
+            }
+        }
+    }
+
+    if(header->face_index_property_index)
+    {
+        eat_all_whitespaces(tokenizer);
+    }
+}
+
+// NOTE(joon) returns where the next binary record of the element starts, or 0 if the record doesn't fully fit 
+// inside the memory(truncated file). Nothing past one_past_end is read, not even the list counts. 
+// For the faces, corner_count is the count of the list at index_property_index.
+internal u8 *
+skip_ply_binary_record(u8 *at, u8 *one_past_end, PlyElement *element, b32 swap, u32 index_property_index, u32 *corner_count)
+{
+    *corner_count = 0;
+    for(u32 property_index = 0;
+            at && property_index < element->property_count;
+            ++property_index)
+    {
+        PlyProperty *property = element->properties + property_index;
+        size_t size = get_ply_scalar_size(property->type);
+        if(property->list_count_type)
+        {
+            u32 count_size = get_ply_scalar_size(property->list_count_type);
+            if((size_t)(one_past_end - at) < count_size)
+            {
+                at = 0;
+                break;
+            }
+
+            u32 count = read_ply_scalar_u32(at, property->list_count_type, swap);
+            at += count_size;
+            size *= count;
+
+            if(property_index == index_property_index)
+            {
+                *corner_count = count;
+            }
+        }
+
+        if((size_t)(one_past_end - at) < size)
+        {
+            at = 0;
+        }
+        else
+        {
+            at += size;
+        }
+    }
+
+    return at;
+}
+
+// NOTE(joon) returns how many bytes the binary record takes, or 0 if the record doesn't fully fit inside the memory
+internal size_t
+get_ply_binary_record_size(u8 *start, u8 *one_past_end, PlyElement *element, b32 swap)
+{
+    size_t result = 0;
+    if(element->stride)
+    {
+        if((size_t)(one_past_end - start) >= element->stride)
+        {
+            result = element->stride;
+        }
+    }
+    else
+    {
+        u32 corner_count;
+        u8 *record_end = skip_ply_binary_record(start, one_past_end, element, swap, 0, &corner_count);
+        if(record_end)
+        {
+            result = (size_t)(record_end - start);
+        }
+    }
+
+    return result;
+}
+
+// NOTE(joon) only parses the header itself into the schema(every element and property, in the file order), 
+// without looking at the body(so index_count and the body ranges stay 0). 
+// header_size stays 0 if end_header didn't appear inside the memory.
+internal ParsePlyHeaderResult
+parse_ply_header_elements(u8 *memory, size_t size)
+{
+    ParsePlyHeaderResult result = {};
+
+    Tokenizer tokenizer = {};
+    tokenizer.at = memory;
+    tokenizer.one_past_end = memory + size;
+
+    PlyElement *current_element = 0;
+    b32 vertex_appeared = false;
+    b32 face_appeared = false;
+    b32 end_header_appeared = false;
+    while(tokenizer.at < tokenizer.one_past_end && !end_header_appeared)
+    {
+        PlyToken token = eat_ply_token(&tokenizer);
+
+        switch(token.type)
+        {
+            case ply_token_type_format:
+            {
+                PlyToken format = eat_ply_token(&tokenizer);
+                if(format.type == ply_token_type_ascii)
+                {
+                    result.format = ply_format_ascii;
+                }
+                else if(format.type == ply_token_type_binary_little_endian)
+                {
+                    result.format = ply_format_binary_little_endian;
+                }
+                else if(format.type == ply_token_type_binary_big_endian)
+                {
+                    result.format = ply_format_binary_big_endian;
+                }
+                else
+                {
+                    invalid_code_path;
+                }
+            }break;
+
+            case ply_token_type_element:
+            {
+                // syntax: element name count
+                assert(result.element_count < ply_max_element_count);
+                current_element = result.elements + result.element_count++;
+
+                eat_ply_name(&tokenizer, current_element->name);
+                PlyToken count = eat_and_check_ply_token(&tokenizer, ply_token_type_i32);
+                current_element->count = count.value_i32;
+            }break;
+
+            case ply_token_type_property:
+            {
+                // syntax: property type name 
+                // or:     property list count_type item_type name
+                PlyProperty property = {};
+
+                PlyToken type = eat_ply_token(&tokenizer); 
+                if(type.type == ply_token_type_list)
+                {
+                    PlyToken count_type = eat_ply_token(&tokenizer);
+                    PlyToken item_type = eat_ply_token(&tokenizer);
+
+                    property.list_count_type = get_ply_scalar_type(count_type.type);
+                    property.type = get_ply_scalar_type(item_type.type);
+                }
+                else
+                {
+                    property.type = get_ply_scalar_type(type.type);
+                }
+
+                eat_ply_name(&tokenizer, property.name);
+
+                assert(current_element && 
+                       current_element->property_count < ply_max_property_count);
+                current_element->properties[current_element->property_count++] = property;
+            }break;
+
+            case ply_token_type_end_header:
+            {
+                end_header_appeared = true;
+            }break;
+        }
+    }
+
+    if(end_header_appeared)
+    {
+        eat_line(&tokenizer);
+        result.header_size = (u32)(tokenizer.at - memory);
+    }
+
+    for(u32 element_index = 0;
+            element_index < result.element_count;
+            ++element_index)
+    {
+        PlyElement *element = result.elements + element_index;
+        for(u32 property_index = 0;
+                property_index < element->property_count;
+                ++property_index)
+        {
+            PlyProperty *property = element->properties + property_index;
+            if(property->list_count_type)
+            {
+                element->stride = 0;
+                break;
+            }
+            element->stride += get_ply_scalar_size(property->type);
+        }
+
+        // NOTE(joon) the loaders only care about the first vertex and face elements
+        if(!vertex_appeared && is_ply_name(element->name, "vertex"))
+        {
+            vertex_appeared = true;
+            result.vertex_element_index = element_index;
+            result.vertex_count = element->count;
+            result.vertex_property_count = element->property_count;
+            result.vertex_stride = element->stride;
+            result.vertex_schema = get_ply_vertex_schema(element);
+
+            // every vertex record should have the same size
+            assert(element->stride || !element->property_count);
+        }
+        else if(!face_appeared && is_ply_name(element->name, "face"))
+        {
+            face_appeared = true;
+            result.face_element_index = element_index;
+            result.face_count = element->count;
+            result.face_property_count = element->property_count;
+
+            // NOTE(joon) the list that is named as the indices, or the first list if there is no such name
+            b32 list_appeared = false;
+            for(u32 property_index = 0;
+                    property_index < element->property_count;
+                    ++property_index)
+            {
+                PlyProperty *property = element->properties + property_index;
+                if(property->list_count_type)
+                {
+                    if(is_ply_name(property->name, "vertex_indices") || is_ply_name(property->name, "vertex_index"))
+                    {
+                        result.face_index_property_index = property_index;
+                        break;
+                    }
+                    else if(!list_appeared)
+                    {
+                        result.face_index_property_index = property_index;
+                        list_appeared = true;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// NOTE(joon) parses the header, and then walks the body once to find where each element is 
+// (elements can come in any order, and there can be the ones that we don't read), 
+// and how many indices the faces will have after the fan triangulation.
+internal ParsePlyHeaderResult
+parse_ply_header(u8 *memory, size_t file_size)
+{
+    ParsePlyHeaderResult result = parse_ply_header_elements(memory, file_size);
+    assert(result.header_size);
+
+    Tokenizer tokenizer = {};
+    tokenizer.at = memory + result.header_size;
+    tokenizer.one_past_end = memory + file_size;
+
+    if(result.format != ply_format_ascii)
+    {
+        b32 swap = is_ply_byte_swap_needed(result.format);
+        u8 *at = tokenizer.at;
+        for(u32 element_index = 0;
+                element_index < result.element_count;
+                ++element_index)
+        {
+            PlyElement *element = result.elements + element_index;
+            element->body_offset = (u64)(at - memory);
+
+            if(element->stride)
+            {
+                if((size_t)(tokenizer.one_past_end - at)/element->stride < element->count)
+                {
+                    at = 0;
+                }
+                else
+                {
+                    at += (size_t)element->count*element->stride;
+                }
+            }
+            else
+            {
+                // NOTE(joon) the records with the lists have different sizes, so we need to walk all of them
+                b32 is_face = (result.face_count && element_index == result.face_element_index);
+                for(u32 record_index = 0;
+                        at && record_index < element->count;
+                        ++record_index)
+                {
+                    u32 corner_count;
+                    at = skip_ply_binary_record(at, tokenizer.one_past_end, element, swap, result.face_index_property_index, &corner_count);
+                    if(is_face && at)
+                    {
+                        // NOTE(joon) faces should have at least 3 corners. Without the asserts, lines and points 
+                        // don't make any triangles, and keep their corners as polygons(same as parse_ply_binary)
+                        assert(corner_count >= 3);
+                        if(corner_count >= 3)
+                        {
+                            result.index_count += 3*(corner_count - 2);
+                        }
+                        result.polygon_index_count += corner_count;
+                    }
+                }
+            }
+
+            if(!at)
+            {
+                // NOTE(joon) truncated file, the loaders get an empty mesh instead of reading past the end
+                result.is_truncated = true;
+                result.vertex_count = 0;
+                result.face_count = 0;
+                result.index_count = 0;
+                result.polygon_index_count = 0;
+                element->body_offset = 0;
+                break;
+            }
+
+            element->body_size = (u64)(at - memory) - element->body_offset;
+        }
+
+        return result;
+    }
+
+    // NOTE(joon) one record per line. 
+    // Only the faces need to be looked at, because ply files do not specify how many indices are there.
+    for(u32 element_index = 0;
+            element_index < result.element_count;
+            ++element_index)
+    {
+        PlyElement *element = result.elements + element_index;
+        element->body_offset = (u64)(tokenizer.at - memory);
+
+        if(result.face_count && element_index == result.face_element_index)
+        {
+            for(u32 face_index = 0;
+                    face_index < element->count;
+                    ++face_index)
+            {
+                eat_all_whitespaces(&tokenizer);
+                skip_ply_ascii_face_properties_before_indices(&tokenizer, &result);
+
+                u32 fast_index_count;
+                u8 *count_end = decode_parser_small_integer(tokenizer.at, tokenizer.one_past_end, &fast_index_count);
+                if(count_end && fast_index_count >= 3)
+                {
+                    result.index_count += 3 * (fast_index_count - 2);
+                    result.polygon_index_count += fast_index_count;
+                    tokenizer.at = count_end;
+                    eat_line(&tokenizer);
+                    continue;
+                }
+
+                PlyToken index_count = eat_ply_token(&tokenizer);
+                assert(index_count.type == ply_token_type_i32 &&
+                        index_count.value_i32 >= 3);
+
+                result.index_count += (u32)(3 * (index_count.value_i32 - 2));
+                result.polygon_index_count += (u32)index_count.value_i32;
+
+                eat_line(&tokenizer);
+            }
+        }
+        else
+        {
+            for(u32 record_index = 0;
+                    record_index < element->count;
+                    ++record_index)
+            {
+                eat_line(&tokenizer);
+            }
+        }
+
+        element->body_size = (u64)(tokenizer.at - memory) - element->body_offset;
+    }
+
+    return result;
+}
+
+inline u32
+get_parser_vertex_format_size(ParserVertexFormat format)
+{
+    u32 result = 0;
+    switch(format)
+    {
+        case parser_vertex_format_f32 : {result = 4;}break;
+        case parser_vertex_format_f16 : 
+        case parser_vertex_format_snorm16 : {result = 2;}break;
+        case parser_vertex_format_unorm8 : {result = 1;}break;
+        default : invalid_code_path;
+    }
+
+    return result;
+}
+
+// NOTE(joon) appends an attribute to the layout. If offset is parser_vertex_offset_append, 
+// the attribute goes right after the attributes that are already inside the same buffer, 
+// so adding everything to buffer 0 makes one tightly packed interleaved struct, 
+// and giving each attribute its own buffer makes the SoA streams.
+internal void
+add_parser_vertex_attribute(ParserVertexLayout *layout, u32 source, u32 component_count, ParserVertexFormat format, 
+                            u32 buffer_index = 0, u32 offset = parser_vertex_offset_append, f32 scale = 1.0f)
+{
+    assert(layout->attribute_count < parser_max_vertex_attribute_count);
+    assert(buffer_index < parser_max_vertex_buffer_count);
+
+    if(offset == parser_vertex_offset_append)
+    {
+        offset = 0;
+        for(u32 attribute_index = 0;
+                attribute_index < layout->attribute_count;
+                ++attribute_index)
+        {
+            ParserVertexAttribute *other = layout->attributes + attribute_index;
+            u32 end = other->offset + other->component_count*get_parser_vertex_format_size(other->format);
+            if(other->buffer_index == buffer_index && end > offset)
+            {
+                offset = end;
+            }
+        }
+    }
+
+    ParserVertexAttribute *attribute = layout->attributes + layout->attribute_count++;
+    attribute->source = source;
+    attribute->component_count = component_count;
+    attribute->format = format;
+    attribute->scale = scale;
+    attribute->buffer_index = buffer_index;
+    attribute->offset = offset;
+}
+
+// NOTE(joon) source_component_count is how many f32s each decoded row has
+// (vertex_property_count for ply, 8 for ObjVertex). The strides that were left as 0 become 
+// the end of the last attribute inside that buffer.
+internal ParserVertexBuffers
+allocate_parser_vertex_buffers(ParserArena *arena, ParserVertexLayout *layout, u32 source_component_count, u32 vertex_count)
+{
+    ParserVertexBuffers result = {};
+    result.vertex_count = vertex_count;
+
+    u32 ends[parser_max_vertex_buffer_count] = {};
+    for(u32 attribute_index = 0;
+            attribute_index < layout->attribute_count;
+            ++attribute_index)
+    {
+        ParserVertexAttribute *attribute = layout->attributes + attribute_index;
+        assert(attribute->component_count >= 1 && attribute->component_count <= 4);
+        assert(attribute->source + attribute->component_count <= source_component_count);
+        assert(attribute->buffer_index < parser_max_vertex_buffer_count);
+
+        u32 end = attribute->offset + attribute->component_count*get_parser_vertex_format_size(attribute->format);
+        if(end > ends[attribute->buffer_index])
+        {
+            ends[attribute->buffer_index] = end;
+        }
+        if(attribute->buffer_index + 1 > result.buffer_count)
+        {
+            result.buffer_count = attribute->buffer_index + 1;
+        }
+    }
+
+    for(u32 buffer_index = 0;
+            buffer_index < result.buffer_count;
+            ++buffer_index)
+    {
+        u32 stride = layout->strides[buffer_index] ? layout->strides[buffer_index] : ends[buffer_index];
+        assert(ends[buffer_index] <= stride);
+
+        result.strides[buffer_index] = stride;
+        if(stride)
+        {
+            result.buffers[buffer_index] = (u8 *)push_parser_size(arena, (size_t)stride*vertex_count);
+        }
+    }
+
+    return result;
+}
+
+// NOTE(joon) round to nearest even, same as F16C. Too big values become inf, 
+// and too small values become the f16 denormals.
+inline u16
+convert_f32_to_f16(f32 value)
+{
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    u32 sign = bits & 0x80000000;
+    bits ^= sign;
+
+    u32 result;
+    if(bits >= (143u << 23)) // 65536, out of range even before the rounding
+    {
+        result = (bits > (255u << 23)) ? 0x7e00 : 0x7c00; // nan : inf
+    }
+    else if(bits < (113u << 23)) // below 2^-14, denormal or 0
+    {
+        // NOTE(joon) adding 0.5 makes the fpu do the rounding, and leaves the f16 mantissa in the low bits
+        u32 magic_bits = 126u << 23;
+        f32 sum = f32_from_bits(bits) + f32_from_bits(magic_bits);
+        memcpy(&result, &sum, sizeof(result));
+        result -= magic_bits;
+    }
+    else
+    {
+        u32 mantissa_is_odd = (bits >> 13) & 1;
+        bits += ((u32)(15 - 127) << 23) + 0xfff + mantissa_is_odd;
+        result = bits >> 13;
+    }
+
+    result |= sign >> 16;
+    return (u16)result;
+}
+
+// NOTE(joon) round to nearest even for |value| < 2^22, same as cvtps2dq with the default rounding mode
+inline i32
+round_parser_f32_to_i32(f32 value)
+{
+    f32 magic = 12582912.0f; // 1.5 * 2^23
+    return (i32)((value + magic) - magic);
+}
+
+internal void
+convert_parser_vertices_scalar(f32 *source, u32 source_stride, u32 count, 
+                               ParserVertexAttribute *attribute, f32 scale, u8 *dest, u32 dest_stride)
+{
+    for(u32 vertex_index = 0;
+            vertex_index < count;
+            ++vertex_index)
+    {
+        for(u32 component_index = 0;
+                component_index < attribute->component_count;
+                ++component_index)
+        {
+            f32 value = scale*source[component_index];
+            switch(attribute->format)
+            {
+                case parser_vertex_format_f32 :
+                {
+                    memcpy(dest + 4*component_index, &value, 4);
+                }break;
+
+                case parser_vertex_format_f16 :
+                {
+                    u16 half = convert_f32_to_f16(value);
+                    memcpy(dest + 2*component_index, &half, 2);
+                }break;
+
+                case parser_vertex_format_snorm16 :
+                {
+                    // NOTE(joon) NaN would get through the clamp, so it becomes 0 first(same as the sse2 path)
+                    value = (value == value) ? value : 0.0f;
+                    value = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+                    i16 snorm = (i16)round_parser_f32_to_i32(32767.0f*value);
+                    memcpy(dest + 2*component_index, &snorm, 2);
+                }break;
+
+                case parser_vertex_format_unorm8 :
+                {
+                    value = (value == value) ? value : 0.0f;
+                    value = (value > 0.0f) ? ((value < 1.0f) ? value : 1.0f) : 0.0f;
+                    dest[component_index] = (u8)round_parser_f32_to_i32(255.0f*value);
+                }break;
+
+                default : invalid_code_path;
+            }
+        }
+
+        source += source_stride;
+        dest += dest_stride;
+    }
+}
+
+#if PARSER_X64
+// NOTE(joon) byte_count is one of the few sizes that an attribute can have, 
+// so the switch lets the compiler turn each memcpy into one or two plain stores
+inline void
+store_parser_vertex_bytes(u8 *dest, u8 *packed, u32 byte_count)
+{
+    switch(byte_count)
+    {
+        case 2 : {memcpy(dest, packed, 2);}break;
+        case 4 : {memcpy(dest, packed, 4);}break;
+        case 6 : {memcpy(dest, packed, 4); memcpy(dest + 4, packed + 4, 2);}break;
+        case 8 : {memcpy(dest, packed, 8);}break;
+        case 12 : {memcpy(dest, packed, 8); memcpy(dest + 8, packed + 8, 4);}break;
+        case 16 : {memcpy(dest, packed, 16);}break;
+        default : {memcpy(dest, packed, byte_count);}break;
+    }
+}
+
+// NOTE(joon) one attribute(up to 4 components) per iteration. 
+// The 4 wide load can go up to 3 f32s past the attribute, see write_parser_layout_vertices
+internal void
+convert_parser_vertices_sse2(f32 *source, u32 source_stride, u32 count, 
+                             ParserVertexAttribute *attribute, f32 scale, u8 *dest, u32 dest_stride)
+{
+    u32 byte_count = attribute->component_count*get_parser_vertex_format_size(attribute->format);
+    __m128 scale_4x = _mm_set1_ps(scale);
+    u8 packed[16];
+
+    switch(attribute->format)
+    {
+        case parser_vertex_format_f32 :
+        {
+            for(u32 vertex_index = 0;
+                    vertex_index < count;
+                    ++vertex_index)
+            {
+                _mm_storeu_ps((f32 *)packed, _mm_mul_ps(_mm_loadu_ps(source), scale_4x));
+                store_parser_vertex_bytes(dest, packed, byte_count);
+
+                source += source_stride;
+                dest += dest_stride;
+            }
+        }break;
+
+        case parser_vertex_format_snorm16 :
+        {
+            __m128 min = _mm_set1_ps(-1.0f);
+            __m128 max = _mm_set1_ps(1.0f);
+            __m128 range = _mm_set1_ps(32767.0f);
+            for(u32 vertex_index = 0;
+                    vertex_index < count;
+                    ++vertex_index)
+            {
+                __m128 value = _mm_mul_ps(_mm_loadu_ps(source), scale_4x);
+                // NOTE(joon) max_ps gives the second operand for NaN, which would be -1, so NaN lanes are zeroed first
+                value = _mm_and_ps(value, _mm_cmpord_ps(value, value));
+                value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, min), max), range);
+                __m128i snorm = _mm_cvtps_epi32(value);
+                _mm_storeu_si128((__m128i *)packed, _mm_packs_epi32(snorm, snorm));
+                store_parser_vertex_bytes(dest, packed, byte_count);
+
+                source += source_stride;
+                dest += dest_stride;
+            }
+        }break;
+
+        case parser_vertex_format_unorm8 :
+        {
+            __m128 min = _mm_setzero_ps();
+            __m128 max = _mm_set1_ps(1.0f);
+            __m128 range = _mm_set1_ps(255.0f);
+            for(u32 vertex_index = 0;
+                    vertex_index < count;
+                    ++vertex_index)
+            {
+                __m128 value = _mm_mul_ps(_mm_loadu_ps(source), scale_4x);
+                value = _mm_and_ps(value, _mm_cmpord_ps(value, value));
+                value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, min), max), range);
+                __m128i unorm = _mm_cvtps_epi32(value);
+                unorm = _mm_packs_epi32(unorm, unorm);
+                _mm_storeu_si128((__m128i *)packed, _mm_packus_epi16(unorm, unorm));
+                store_parser_vertex_bytes(dest, packed, byte_count);
+
+                source += source_stride;
+                dest += dest_stride;
+            }
+        }break;
+
+        default :
+        {
+            // NOTE(joon) f16 without F16C
+            convert_parser_vertices_scalar(source, source_stride, count, attribute, scale, dest, dest_stride);
+        }break;
+    }
+}
+
+// NOTE(joon) every cpu with avx2 also has F16C
+PARSER_TARGET_F16C internal void
+convert_parser_vertices_f16c(f32 *source, u32 source_stride, u32 count, 
+                             ParserVertexAttribute *attribute, f32 scale, u8 *dest, u32 dest_stride)
+{
+    assert(attribute->format == parser_vertex_format_f16);
+
+    u32 byte_count = 2*attribute->component_count;
+    __m128 scale_4x = _mm_set1_ps(scale);
+    u8 packed[16];
+    for(u32 vertex_index = 0;
+            vertex_index < count;
+            ++vertex_index)
+    {
+        __m128 value = _mm_mul_ps(_mm_loadu_ps(source), scale_4x);
+        _mm_storeu_si128((__m128i *)packed, _mm_cvtps_ph(value, _MM_FROUND_TO_NEAREST_INT));
+        store_parser_vertex_bytes(dest, packed, byte_count);
+
+        source += source_stride;
+        dest += dest_stride;
+    }
+}
+#endif
+
+// NOTE(joon) converts count decoded rows(row_stride f32s each) into the layout, starting from first_vertex. 
+// The rows must be readable up to 3 f32s past the last attribute, 
+// which is why every caller decodes into a scratch with one extra row.
+internal void
+write_parser_layout_vertices(ParserVertexLayout *layout, ParserVertexBuffers *layout_vertices, 
+                             f32 *rows, u32 row_stride, u32 first_vertex, u32 count)
+{
+    for(u32 attribute_index = 0;
+            attribute_index < layout->attribute_count;
+            ++attribute_index)
+    {
+        ParserVertexAttribute *attribute = layout->attributes + attribute_index;
+        u32 dest_stride = layout_vertices->strides[attribute->buffer_index];
+        u8 *dest = layout_vertices->buffers[attribute->buffer_index] + (size_t)first_vertex*dest_stride + attribute->offset;
+        f32 *source = rows + attribute->source;
+        f32 scale = (attribute->scale != 0.0f) ? attribute->scale : 1.0f;
+
+#if PARSER_X64
+        if(attribute->format == parser_vertex_format_f16 && parser_simd_level == parser_simd_level_avx2)
+        {
+            convert_parser_vertices_f16c(source, row_stride, count, attribute, scale, dest, dest_stride);
+            continue;
+        }
+        if(parser_simd_level >= parser_simd_level_sse2)
+        {
+            convert_parser_vertices_sse2(source, row_stride, count, attribute, scale, dest, dest_stride);
+            continue;
+        }
+#endif
+        convert_parser_vertices_scalar(source, row_stride, count, attribute, scale, dest, dest_stride);
+    }
+}
+
+// NOTE(joon) how many rows are decoded into the scratch at once before they are converted into the layout, 
+// small enough for the rows to be still inside L1
+#define parser_layout_batch_vertex_count 64
+
+// NOTE(joon) empty stats, the first position sets the bounds
+internal void
+init_parser_mesh_stats(ParserMeshStats *stats)
+{
+    *stats = {};
+    stats->min.x = stats->min.y = stats->min.z = FLT_MAX;
+    stats->max.x = stats->max.y = stats->max.z = -FLT_MAX;
+}
+
+inline void
+add_parser_mesh_stats_position(ParserMeshStats *stats, f32 x, f32 y, f32 z)
+{
+    stats->min.x = (x < stats->min.x) ? x : stats->min.x;
+    stats->min.y = (y < stats->min.y) ? y : stats->min.y;
+    stats->min.z = (z < stats->min.z) ? z : stats->min.z;
+    stats->max.x = (x > stats->max.x) ? x : stats->max.x;
+    stats->max.y = (y > stats->max.y) ? y : stats->max.y;
+    stats->max.z = (z > stats->max.z) ? z : stats->max.z;
+
+    stats->position_sum[0] += x;
+    stats->position_sum[1] += y;
+    stats->position_sum[2] += z;
+    stats->position_count++;
+}
+
+internal void
+merge_parser_mesh_stats(ParserMeshStats *dest, ParserMeshStats *source)
+{
+    dest->min.x = (source->min.x < dest->min.x) ? source->min.x : dest->min.x;
+    dest->min.y = (source->min.y < dest->min.y) ? source->min.y : dest->min.y;
+    dest->min.z = (source->min.z < dest->min.z) ? source->min.z : dest->min.z;
+    dest->max.x = (source->max.x > dest->max.x) ? source->max.x : dest->max.x;
+    dest->max.y = (source->max.y > dest->max.y) ? source->max.y : dest->max.y;
+    dest->max.z = (source->max.z > dest->max.z) ? source->max.z : dest->max.z;
+
+    dest->position_sum[0] += source->position_sum[0];
+    dest->position_sum[1] += source->position_sum[1];
+    dest->position_sum[2] += source->position_sum[2];
+    dest->position_count += source->position_count;
+}
+
+// NOTE(joon) makes the centroid, and zeroes the bounds if there was no position at all
+internal void
+finish_parser_mesh_stats(ParserMeshStats *stats)
+{
+    if(stats->position_count)
+    {
+        stats->centroid.x = (f32)(stats->position_sum[0]/(f64)stats->position_count);
+        stats->centroid.y = (f32)(stats->position_sum[1]/(f64)stats->position_count);
+        stats->centroid.z = (f32)(stats->position_sum[2]/(f64)stats->position_count);
+    }
+    else
+    {
+        stats->min = {};
+        stats->max = {};
+        stats->centroid = {};
+    }
+}
+
+// NOTE(joon) scanner normals are often slightly off from the unit length. 
+// Zero normals stay zero, there is no direction to keep.
+inline void
+normalize_parser_normal(f32 *x, f32 *y, f32 *z)
+{
+    f32 length_square = (*x)*(*x) + (*y)*(*y) + (*z)*(*z);
+    if(length_square > 0.0f)
+    {
+        f32 one_over_length = 1.0f/sqrtf(length_square);
+        *x *= one_over_length;
+        *y *= one_over_length;
+        *z *= one_over_length;
+    }
+}
+
+// NOTE(joon) x y z and nx ny nz can be anywhere inside the vertex row, and they don't need to be next to each other
+internal PlyVertexStatsInfo
+get_ply_vertex_stats_info(ParsePlyHeaderResult *header, b32 compute_positions, b32 normalize_normals)
+{
+    PlyVertexStatsInfo result = {};
+    result.vertex_property_count = header->vertex_property_count;
+
+    const char *position_names[] = {"x", "y", "z"};
+    const char *normal_names[] = {"nx", "ny", "nz"};
+    u32 position_found_count = 0;
+    u32 normal_found_count = 0;
+    if(header->vertex_count)
+    {
+        PlyElement *vertex_element = get_ply_vertex_element(header);
+        for(u32 component_index = 0;
+                component_index < 3;
+                ++component_index)
+        {
+            for(u32 property_index = 0;
+                    property_index < vertex_element->property_count;
+                    ++property_index)
+            {
+                PlyProperty *property = vertex_element->properties + property_index;
+                if(!property->list_count_type && is_ply_name(property->name, position_names[component_index]))
+                {
+                    result.positions[component_index] = property_index;
+                    position_found_count++;
+                }
+                else if(!property->list_count_type && is_ply_name(property->name, normal_names[component_index]))
+                {
+                    result.normals[component_index] = property_index;
+                    normal_found_count++;
+                }
+            }
+        }
+    }
+
+    result.has_positions = (compute_positions && position_found_count == 3);
+    result.normalize_normals = (normalize_normals && normal_found_count == 3);
+
+    return result;
+}
+
+#if PARSER_X64
+// NOTE(joon) bounds and the sum of one batch in the lanes, the sum goes into f64 once per batch
+internal void
+accumulate_ply_vertex_positions_sse2(PlyVertexStatsInfo *info, f32 *rows, u32 row_count, ParserMeshStats *stats)
+{
+    __m128 min = _mm_setr_ps(stats->min.x, stats->min.y, stats->min.z, 0.0f);
+    __m128 max = _mm_setr_ps(stats->max.x, stats->max.y, stats->max.z, 0.0f);
+    __m128 sum = _mm_setzero_ps();
+
+    f32 *row = rows;
+    for(u32 row_index = 0;
+            row_index < row_count;
+            ++row_index)
+    {
+        __m128 position = _mm_setr_ps(row[info->positions[0]], row[info->positions[1]], row[info->positions[2]], 0.0f);
+        min = _mm_min_ps(min, position);
+        max = _mm_max_ps(max, position);
+        sum = _mm_add_ps(sum, position);
+
+        row += info->vertex_property_count;
+    }
+
+    f32 lanes[4];
+    _mm_storeu_ps(lanes, min);
+    stats->min.x = lanes[0];
+    stats->min.y = lanes[1];
+    stats->min.z = lanes[2];
+    _mm_storeu_ps(lanes, max);
+    stats->max.x = lanes[0];
+    stats->max.y = lanes[1];
+    stats->max.z = lanes[2];
+    _mm_storeu_ps(lanes, sum);
+    stats->position_sum[0] += lanes[0];
+    stats->position_sum[1] += lanes[1];
+    stats->position_sum[2] += lanes[2];
+    stats->position_count += row_count;
+}
+#endif
+
+// NOTE(joon) called with at most parser_layout_batch_vertex_count rows that were just decoded, 
+// so the rows are still inside L1 and this doesn't cost another pass over the vertices
+internal void
+accumulate_ply_vertex_stats(PlyVertexStatsInfo *info, f32 *rows, u32 row_count, ParserMeshStats *stats)
+{
+    if(info->has_positions)
+    {
+#if PARSER_X64
+        accumulate_ply_vertex_positions_sse2(info, rows, row_count, stats);
+#else
+        for(u32 row_index = 0;
+                row_index < row_count;
+                ++row_index)
+        {
+            f32 *row = rows + (size_t)row_index*info->vertex_property_count;
+            add_parser_mesh_stats_position(stats, row[info->positions[0]], row[info->positions[1]], row[info->positions[2]]);
+        }
+#endif
+    }
+
+    if(info->normalize_normals)
+    {
+        for(u32 row_index = 0;
+                row_index < row_count;
+                ++row_index)
+        {
+            f32 *row = rows + (size_t)row_index*info->vertex_property_count;
+            normalize_parser_normal(row + info->normals[0], row + info->normals[1], row + info->normals[2]);
+        }
+    }
+}
+
+// NOTE(joon) decodes row_count vertex rows from start, one vertex per line. 
+// Returns where the next row would start.
+internal u8 *
+parse_ply_vertex_rows(u8 *start, u8 *one_past_end, u32 row_count, u32 vertex_property_count, f32 *vertices)
+{
+    Tokenizer tokenizer = {};
+    tokenizer.at = start;
+    tokenizer.one_past_end = one_past_end;
+
+    u32 vertex_index = 0;
+    for(u32 i = 0;
+            i < row_count;
+            ++i)
+    {
+        for(u32 vertex_property_index = 0;
+                vertex_property_index < vertex_property_count;
+                ++vertex_property_index)
+        {
+            PlyToken token = eat_ply_token(&tokenizer);
+            assert(token.type == ply_token_type_f32 || 
+                    token.type == ply_token_type_i32);
+
+            if(token.is_float)
+            {
+                vertices[vertex_index] = token.value_f32;
+            }
+            else
+            {
+                vertices[vertex_index] = (f32)token.value_i32;
+            }
+
+            vertex_index++;
+        }
+
+        eat_line(&tokenizer);
+    }
+
+    return tokenizer.at;
+}
+
+// NOTE(joon) row decoder for the ascii schemas. property_count is a compile time constant, 
+// so the loop is unrolled and every field is decoded as a plain number, without going through the ply tokens. 
+// Returns where the next row starts, or 0 if the row is not exactly property_count numbers 
+// (the caller falls back to parse_ply_vertex_rows for that row).
+template<u32 property_count>
+inline u8 *
+decode_ply_vertex_row_fixed(u8 *at, u8 *one_past_end, f32 *vertex)
+{
+    for(u32 property_index = 0;
+            property_index < property_count;
+            ++property_index)
+    {
+        while(at < one_past_end && *at == ' ')
+        {
+            at++;
+        }
+        if(at == one_past_end || !is_digit_or_sign(*at))
+        {
+            return 0;
+        }
+
+        Tokenizer number_tokenizer = {};
+        number_tokenizer.at = at;
+        number_tokenizer.one_past_end = one_past_end;
+        ParseNumericResult number = eat_numeric(&number_tokenizer);
+        at = number_tokenizer.at;
+        if(at < one_past_end && !is_token_whitespace(*at))
+        {
+            return 0;
+        }
+
+        vertex[property_index] = number.is_float ? number.value_f32 : (f32)number.value_i32;
+    }
+
+    while(at < one_past_end && *at == ' ')
+    {
+        at++;
+    }
+    if(at < one_past_end && *at == '\r')
+    {
+        at++;
+    }
+    if(at < one_past_end)
+    {
+        if(*at != '\n')
+        {
+            return 0;
+        }
+        at++;
+    }
+
+    return at;
+}
+
+template<u32 property_count>
+internal u8 *
+parse_ply_vertex_rows_fixed(u8 *start, u8 *one_past_end, u32 row_count, f32 *vertices)
+{
+    u8 *at = start;
+    for(u32 row_index = 0;
+            row_index < row_count;
+            ++row_index)
+    {
+        f32 *vertex = vertices + (size_t)row_index*property_count;
+
+        u8 *row_end = decode_ply_vertex_row_fixed<property_count>(at, one_past_end, vertex);
+        if(row_end)
+        {
+            at = row_end;
+        }
+        else
+        {
+            at = parse_ply_vertex_rows(at, one_past_end, 1, property_count, vertex);
+        }
+    }
+
+    return at;
+}
+
+// NOTE(joon) same as parse_ply_vertex_rows, but the schemas that we know of go to their own row decoders
+internal u8 *
+parse_ply_vertex_rows_for_schema(PlyVertexSchema schema, u8 *start, u8 *one_past_end, u32 row_count, u32 vertex_property_count, f32 *vertices)
+{
+    u8 *result = 0;
+    switch(schema)
+    {
+        case ply_vertex_schema_xyz:
+        {
+            result = parse_ply_vertex_rows_fixed<3>(start, one_past_end, row_count, vertices);
+        }break;
+
+        case ply_vertex_schema_xyz_confidence_intensity:
+        {
+            result = parse_ply_vertex_rows_fixed<5>(start, one_past_end, row_count, vertices);
+        }break;
+
+        case ply_vertex_schema_xyz_normal:
+        case ply_vertex_schema_xyz_rgb:
+        {
+            result = parse_ply_vertex_rows_fixed<6>(start, one_past_end, row_count, vertices);
+        }break;
+
+        case ply_vertex_schema_xyz_rgba:
+        {
+            result = parse_ply_vertex_rows_fixed<7>(start, one_past_end, row_count, vertices);
+        }break;
+
+        default:
+        {
+            result = parse_ply_vertex_rows(start, one_past_end, row_count, vertex_property_count, vertices);
+        }break;
+    }
+
+    return result;
+}
+
+// NOTE(joon) same as parse_ply_vertex_rows_for_schema, but the rows go into the layout
+internal u8 *
+parse_ply_vertex_rows_into_layout(PlyVertexSchema schema, u8 *start, u8 *one_past_end, u32 row_count, u32 vertex_property_count, 
+                                  ParserVertexLayout *layout, ParserVertexBuffers *layout_vertices, u32 first_vertex)
+{
+    f32 rows[(parser_layout_batch_vertex_count + 1)*ply_max_property_count];
+
+    u8 *at = start;
+    for(u32 row_index = 0;
+            row_index < row_count;
+            row_index += parser_layout_batch_vertex_count)
+    {
+        u32 batch_count = row_count - row_index;
+        if(batch_count > parser_layout_batch_vertex_count)
+        {
+            batch_count = parser_layout_batch_vertex_count;
+        }
+
+        at = parse_ply_vertex_rows_for_schema(schema, at, one_past_end, batch_count, vertex_property_count, rows);
+        write_parser_layout_vertices(layout, layout_vertices, rows, vertex_property_count, first_vertex + row_index, batch_count);
+    }
+
+    return at;
+}
+
+// NOTE(joon) same as parse_ply_vertex_rows_for_schema, but each batch of the rows goes into the stats 
+// right after it was decoded(see accumulate_ply_vertex_stats)
+internal u8 *
+parse_ply_vertex_rows_with_stats(PlyVertexSchema schema, u8 *start, u8 *one_past_end, u32 row_count, u32 vertex_property_count, 
+                                 f32 *vertices, PlyVertexStatsInfo *stats_info, ParserMeshStats *stats)
+{
+    u8 *at = start;
+    for(u32 row_index = 0;
+            row_index < row_count;
+            row_index += parser_layout_batch_vertex_count)
+    {
+        u32 batch_count = row_count - row_index;
+        if(batch_count > parser_layout_batch_vertex_count)
+        {
+            batch_count = parser_layout_batch_vertex_count;
+        }
+
+        f32 *rows = vertices + (size_t)row_index*vertex_property_count;
+        at = parse_ply_vertex_rows_for_schema(schema, at, one_past_end, batch_count, vertex_property_count, rows);
+        accumulate_ply_vertex_stats(stats_info, rows, batch_count, stats);
+    }
+
+    return at;
+}
+
+internal void
+count_ply_vertex_chunk_newlines_work(void *data)
+{
+    PlyVertexChunkWork *work = (PlyVertexChunkWork *)data;
+
+    work->newline_count = count_newlines(work->start, work->one_past_end);
+}
+
+internal void
+parse_ply_vertex_chunk_work(void *data)
+{
+    PlyVertexChunkWork *work = (PlyVertexChunkWork *)data;
+
+    if(work->layout)
+    {
+        work->rows_end = parse_ply_vertex_rows_into_layout(work->vertex_schema, work->start, work->one_past_end, 
+                                                           work->row_count, work->vertex_property_count, 
+                                                           work->layout, work->layout_vertices, work->first_vertex);
+    }
+    else if(work->stats_info)
+    {
+        work->rows_end = parse_ply_vertex_rows_with_stats(work->vertex_schema, work->start, work->one_past_end, 
+                                                          work->row_count, work->vertex_property_count, work->vertices, 
+                                                          work->stats_info, &work->stats);
+    }
+    else
+    {
+        work->rows_end = parse_ply_vertex_rows_for_schema(work->vertex_schema, work->start, work->one_past_end, 
+                                                          work->row_count, work->vertex_property_count, work->vertices);
+    }
+}
+
+// NOTE(joon) the vertex body is a fixed vertex_count x vertex_property_count grid, one vertex per line. 
+// If the pool is given, everything after the header is cut into newline aligned chunks, 
+// and the newlines of each chunk are counted in parallel. The prefix sum of the counts gives 
+// the first vertex index of each chunk, and then the chunks that have vertices in them are decoded in parallel.
+// If the layout is given, vertices is not used and each chunk converts its rows into the layout.
+// Otherwise if stats_info is given, each chunk makes its own stats and they are merged into the stats.
+// Returns the start of the face section.
+internal u8 *
+parse_ply_vertex_body(u8 *body_start, u8 *one_past_end, ParsePlyHeaderResult *header, f32 *vertices, ParserThreadPool *pool, 
+                      ParserVertexLayout *layout = 0, ParserVertexBuffers *layout_vertices = 0, 
+                      PlyVertexStatsInfo *stats_info = 0, ParserMeshStats *stats = 0)
+{
+    u32 chunk_count = get_parser_chunk_count(pool, (size_t)(one_past_end - body_start), 1024*1024);
+    if(chunk_count == 1)
+    {
+        if(layout)
+        {
+            return parse_ply_vertex_rows_into_layout(header->vertex_schema, body_start, one_past_end, 
+                                                     header->vertex_count, header->vertex_property_count, 
+                                                     layout, layout_vertices, 0);
+        }
+        if(stats_info)
+        {
+            return parse_ply_vertex_rows_with_stats(header->vertex_schema, body_start, one_past_end, 
+                                                    header->vertex_count, header->vertex_property_count, vertices, 
+                                                    stats_info, stats);
+        }
+        return parse_ply_vertex_rows_for_schema(header->vertex_schema, body_start, one_past_end, 
+                                                header->vertex_count, header->vertex_property_count, vertices);
+    }
+
+    // NOTE(joon) up to parser_max_chunk_count works is too much for the stack, 
+    // and parse_ply has no arena, so the works get their own block that only fits them
+    ParserArena work_arena = {};
+    work_arena.minimum_block_size = sizeof(PlyVertexChunkWork)*chunk_count;
+    PlyVertexChunkWork *works = push_parser_array(&work_arena, PlyVertexChunkWork, chunk_count);
+
+    u8 *chunk_start = body_start;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        u8 *chunk_end = one_past_end;
+        if(chunk_index != chunk_count - 1)
+        {
+            chunk_end = get_next_line_start(body_start, body_start + ((one_past_end - body_start)/chunk_count)*(chunk_index + 1), one_past_end);
+        }
+
+        PlyVertexChunkWork *work = works + chunk_index;
+        *work = {};
+        work->start = chunk_start;
+        work->one_past_end = chunk_end;
+        work->vertex_property_count = header->vertex_property_count;
+        work->vertex_schema = header->vertex_schema;
+
+        add_parser_work(pool, count_ply_vertex_chunk_newlines_work, work);
+
+        chunk_start = chunk_end;
+    }
+    complete_all_parser_work(pool);
+
+    // NOTE(joon) the last line might not have a newline at the end
+    PlyVertexChunkWork *last_work = works + chunk_count - 1;
+    if(last_work->start < last_work->one_past_end && last_work->one_past_end[-1] != '\n')
+    {
+        last_work->newline_count++;
+    }
+
+    u8 *face_start = body_start;
+    u64 line_index = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count && line_index < header->vertex_count;
+            ++chunk_index)
+    {
+        PlyVertexChunkWork *work = works + chunk_index;
+
+        u64 row_count = header->vertex_count - line_index;
+        if(row_count > work->newline_count)
+        {
+            row_count = work->newline_count;
+        }
+
+        work->row_count = (u32)row_count;
+        if(layout)
+        {
+            work->layout = layout;
+            work->layout_vertices = layout_vertices;
+            work->first_vertex = (u32)line_index;
+        }
+        else
+        {
+            work->vertices = vertices + line_index*header->vertex_property_count;
+            work->stats_info = stats_info;
+            init_parser_mesh_stats(&work->stats);
+        }
+        line_index += row_count;
+
+        if(work->row_count)
+        {
+            add_parser_work(pool, parse_ply_vertex_chunk_work, work);
+        }
+    }
+    complete_all_parser_work(pool);
+    assert(line_index == header->vertex_count);
+
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        if(works[chunk_index].row_count)
+        {
+            face_start = works[chunk_index].rows_end;
+            if(works[chunk_index].stats_info)
+            {
+                merge_parser_mesh_stats(stats, &works[chunk_index].stats);
+            }
+        }
+    }
+    free_parser_arena(&work_arena);
+
+    return face_start;
+}
+
+// NOTE(joon) row decoder for the binary schemas that mix float and uchar(x y z + colors). 
+// The record layout is a compile time constant, so each row is a fixed sequence of loads 
+// without looking at the property types.
+template<u32 f32_count, u32 u8_count, b32 swap>
+internal void
+decode_ply_binary_rows_fixed(u8 *records, u32 vertex_count, f32 *vertices)
+{
+    u32 stride = 4*f32_count + u8_count;
+    for(u32 vertex_index = 0;
+            vertex_index < vertex_count;
+            ++vertex_index)
+    {
+        u8 *record = records + (size_t)vertex_index*stride;
+        f32 *vertex = vertices + (size_t)vertex_index*(f32_count + u8_count);
+        for(u32 value_index = 0;
+                value_index < f32_count;
+                ++value_index)
+        {
+            u32 bits;
+            memcpy(&bits, record + 4*value_index, sizeof(bits));
+            if(swap)
+            {
+                bits = parser_byte_swap_u32(bits);
+            }
+            vertex[value_index] = f32_from_bits(bits);
+        }
+        for(u32 value_index = 0;
+                value_index < u8_count;
+                ++value_index)
+        {
+            vertex[f32_count + value_index] = (f32)record[4*f32_count + value_index];
+        }
+    }
+}
+
+// NOTE(joon) returns false if the schema doesn't have its own binary decoder. 
+// The schemas that are all float don't need one, they are already one run of f32s(see convert_ply_scalars)
+internal b32
+decode_ply_binary_rows_for_schema(PlyVertexSchema schema, b32 swap, u8 *records, u32 vertex_count, f32 *vertices)
+{
+    b32 result = true;
+    switch(schema)
+    {
+        case ply_vertex_schema_xyz_rgb:
+        {
+            if(swap)
+            {
+                decode_ply_binary_rows_fixed<3, 3, true>(records, vertex_count, vertices);
+            }
+            else
+            {
+                decode_ply_binary_rows_fixed<3, 3, false>(records, vertex_count, vertices);
+            }
+        }break;
+
+        case ply_vertex_schema_xyz_rgba:
+        {
+            if(swap)
+            {
+                decode_ply_binary_rows_fixed<3, 4, true>(records, vertex_count, vertices);
+            }
+            else
+            {
+                decode_ply_binary_rows_fixed<3, 4, false>(records, vertex_count, vertices);
+            }
+        }break;
+
+        default:
+        {
+            result = false;
+        }break;
+    }
+
+    return result;
+}
+
+internal void
+decode_ply_binary_vertices(u8 *records, u32 vertex_count, ParsePlyHeaderResult *header, f32 *vertices)
+{
+    b32 swap = is_ply_byte_swap_needed(header->format);
+
+    PlyScalarType uniform_type = get_ply_uniform_vertex_type(header);
+    if(uniform_type)
+    {
+        convert_ply_scalars(records, (u64)vertex_count*header->vertex_property_count, uniform_type, swap, vertices);
+    }
+    else if(!decode_ply_binary_rows_for_schema(header->vertex_schema, swap, records, vertex_count, vertices))
+    {
+        PlyProperty *properties = get_ply_vertex_element(header)->properties;
+
+        // NOTE(joon) mixed types(i.e float x y z + uchar red green blue), go property by property
+        u8 *at = records;
+        f32 *dest = vertices;
+        for(u32 vertex_index = 0;
+                vertex_index < vertex_count;
+                ++vertex_index)
+        {
+            for(u32 property_index = 0;
+                    property_index < header->vertex_property_count;
+                    ++property_index)
+            {
+                PlyScalarType type = properties[property_index].type;
+                *dest++ = (f32)read_ply_scalar(at, type, swap);
+                at += get_ply_scalar_size(type);
+            }
+        }
+    }
+}
+
+internal void
+decode_ply_binary_vertex_chunk_work(void *data)
+{
+    PlyBinaryVertexChunkWork *work = (PlyBinaryVertexChunkWork *)data;
+
+    if(work->layout)
+    {
+        u32 vertex_property_count = work->header->vertex_property_count;
+        f32 rows[(parser_layout_batch_vertex_count + 1)*ply_max_property_count];
+        for(u32 row_index = 0;
+                row_index < work->vertex_count;
+                row_index += parser_layout_batch_vertex_count)
+        {
+            u32 batch_count = work->vertex_count - row_index;
+            if(batch_count > parser_layout_batch_vertex_count)
+            {
+                batch_count = parser_layout_batch_vertex_count;
+            }
+
+            decode_ply_binary_vertices(work->records + (size_t)row_index*work->header->vertex_stride, batch_count, work->header, rows);
+            write_parser_layout_vertices(work->layout, work->layout_vertices, rows, vertex_property_count, 
+                                         work->first_vertex + row_index, batch_count);
+        }
+    }
+    else if(work->stats_info)
+    {
+        for(u32 row_index = 0;
+                row_index < work->vertex_count;
+                row_index += parser_layout_batch_vertex_count)
+        {
+            u32 batch_count = work->vertex_count - row_index;
+            if(batch_count > parser_layout_batch_vertex_count)
+            {
+                batch_count = parser_layout_batch_vertex_count;
+            }
+
+            f32 *rows = work->vertices + (size_t)row_index*work->header->vertex_property_count;
+            decode_ply_binary_vertices(work->records + (size_t)row_index*work->header->vertex_stride, batch_count, work->header, rows);
+            accumulate_ply_vertex_stats(work->stats_info, rows, batch_count, &work->stats);
+        }
+    }
+    else
+    {
+        decode_ply_binary_vertices(work->records, work->vertex_count, work->header, work->vertices);
+    }
+}
+
+// NOTE(joon) if the vertex records are already native endian f32 rows(and aligned), 
+// returns the records themselves so that the caller can use the file memory directly. 
+// Passing this pointer to parse_ply as vertices skips the vertex copy. 
+// Returns 0 if the records need any conversion.
+internal f32 *
+get_ply_vertices_in_place(u8 *memory, ParsePlyHeaderResult *header)
+{
+    f32 *result = 0;
+
+    u8 *records = memory + get_ply_vertex_element(header)->body_offset;
+    if(header->format != ply_format_ascii && 
+       !is_ply_byte_swap_needed(header->format) && 
+       get_ply_uniform_vertex_type(header) == ply_scalar_type_f32 && 
+       ((size_t)records & (sizeof(f32) - 1)) == 0)
+    {
+        result = (f32 *)records;
+    }
+
+    return result;
+}
+
+// NOTE(joon) vertex records have a fixed size, so the vertex body is cut into ranges of vertices 
+// that are decoded in parallel if the pool is given. Faces are decoded in order, 
+// because each record has a different size.
+internal void
+parse_ply_binary(u8 *memory, size_t file_size, ParsePlyHeaderResult *header, f32 *vertices, u32 *indices, ParserThreadPool *pool, 
+                 ParserVertexLayout *layout, ParserVertexBuffers *layout_vertices, ParserPolygons *polygons, 
+                 PlyVertexStatsInfo *stats_info, ParserMeshStats *stats)
+{
+    u8 *records = memory + get_ply_vertex_element(header)->body_offset;
+    u8 *one_past_end = memory + file_size;
+
+    size_t vertex_body_size = (size_t)header->vertex_count*header->vertex_stride;
+    assert(records + vertex_body_size <= one_past_end);
+
+    u32 chunk_count = get_parser_chunk_count(pool, vertex_body_size, 1024*1024);
+    // NOTE(joon) same as parse_ply_vertex_body, the works are too big for the stack
+    ParserArena work_arena = {};
+    work_arena.minimum_block_size = sizeof(PlyBinaryVertexChunkWork)*chunk_count;
+    PlyBinaryVertexChunkWork *works = push_parser_array(&work_arena, PlyBinaryVertexChunkWork, chunk_count);
+
+    u32 vertex_index = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        u32 next_vertex_index = (u32)(((u64)header->vertex_count*(chunk_index + 1))/chunk_count);
+
+        PlyBinaryVertexChunkWork *work = works + chunk_index;
+        *work = {};
+        work->records = records + (size_t)vertex_index*header->vertex_stride;
+        work->vertex_count = next_vertex_index - vertex_index;
+        work->header = header;
+        if(layout)
+        {
+            work->layout = layout;
+            work->layout_vertices = layout_vertices;
+            work->first_vertex = vertex_index;
+        }
+        else
+        {
+            work->vertices = vertices + (size_t)vertex_index*header->vertex_property_count;
+            work->stats_info = stats_info;
+            init_parser_mesh_stats(&work->stats);
+        }
+
+        add_parser_work(pool, decode_ply_binary_vertex_chunk_work, work);
+
+        vertex_index = next_vertex_index;
+    }
+
+    // NOTE(joon) the calling thread does the faces while the workers are doing the vertices
+    b32 swap = is_ply_byte_swap_needed(header->format);
+    PlyElement *face_element = get_ply_face_element(header);
+    u8 *at = memory + face_element->body_offset;
+    u32 index_index = 0;
+    u32 face_index = 0;
+    for(;
+            face_index < header->face_count;
+            ++face_index)
+    {
+        // NOTE(joon) the header already walked the same records, 
+        // but the header could have been made from a different(i.e longer) memory
+        u32 corner_count;
+        u8 *record_end = skip_ply_binary_record(at, one_past_end, face_element, swap, header->face_index_property_index, &corner_count);
+        if(!record_end)
+        {
+            break;
+        }
+
+        for(u32 property_index = 0;
+                property_index < header->face_property_count;
+                ++property_index)
+        {
+            PlyProperty *property = face_element->properties + property_index;
+            if(property->list_count_type)
+            {
+                u32 count = read_ply_scalar_u32(at, property->list_count_type, swap);
+                at += get_ply_scalar_size(property->list_count_type);
+
+                u32 item_size = get_ply_scalar_size(property->type);
+                b32 is_indices = (property_index == header->face_index_property_index);
+                if(is_indices && polygons)
+                {
+                    polygons->offsets[face_index] = index_index;
+                    for(u32 item_index = 0;
+                            item_index < count;
+                            ++item_index)
+                    {
+                        polygons->indices[index_index++] = read_ply_scalar_u32(at + item_index*item_size, property->type, swap);
+                    }
+                }
+                else if(is_indices && count >= 3)
+                {
+                    // fan triangulation, same as the ascii version
+                    u32 index_0 = read_ply_scalar_u32(at, property->type, swap);
+                    u32 previous_index = read_ply_scalar_u32(at + item_size, property->type, swap);
+                    for(u32 item_index = 2;
+                            item_index < count;
+                            ++item_index)
+                    {
+                        u32 index = read_ply_scalar_u32(at + item_index*item_size, property->type, swap);
+
+                        indices[index_index++] = index_0;
+                        indices[index_index++] = previous_index;
+                        indices[index_index++] = index;
+
+                        previous_index = index;
+                    }
+                }
+
+                at += count*item_size;
+            }
+            else
+            {
+                at += get_ply_scalar_size(property->type);
+            }
+        }
+    }
+    if(polygons)
+    {
+        // NOTE(joon) for a truncated file, the polygons only have the faces that were there
+        polygons->face_count = face_index;
+        polygons->index_count = index_index;
+        polygons->offsets[face_index] = index_index;
+    }
+    else
+    {
+        // NOTE(joon) for a truncated file, the triangles that were not there are degenerate
+        memset(indices + index_index, 0, sizeof(u32)*(header->index_count - index_index));
+    }
+
+    complete_all_parser_work(pool);
+
+    if(stats_info)
+    {
+        for(u32 chunk_index = 0;
+                chunk_index < chunk_count;
+                ++chunk_index)
+        {
+            merge_parser_mesh_stats(stats, &works[chunk_index].stats);
+        }
+    }
+    free_parser_arena(&work_arena);
+}
+
+// NOTE(joon) minimal ply parser, that only parses vertices for now. 
+// If the layout is given, the vertices go into layout_vertices instead(see load_ply_with_layout), 
+// and if the polygons are given, the faces go into them without the triangulation(see load_ply_polygons).
+// If the stats are given, the bounds and the centroid of x y z are made while the vertices are decoded, 
+// and normalize_normals makes nx ny nz unit length on the way. The layout path does neither.
+internal void
+parse_ply(u8 *memory, size_t file_size, ParsePlyHeaderResult header, f32 *vertices, u32 *indices, ParserThreadPool *pool = 0, 
+          ParserVertexLayout *layout = 0, ParserVertexBuffers *layout_vertices = 0, ParserPolygons *polygons = 0, 
+          ParserMeshStats *stats = 0, b32 normalize_normals = false)
+{
+    ParserMeshStats ignored_stats;
+    PlyVertexStatsInfo stats_info = get_ply_vertex_stats_info(&header, stats != 0, normalize_normals);
+    if((u8 *)vertices >= memory && (u8 *)vertices < memory + file_size)
+    {
+        // NOTE(joon) the vertices are the records themselves(get_ply_vertices_in_place), which are read only
+        stats_info.normalize_normals = false;
+    }
+    PlyVertexStatsInfo *used_stats_info = 0;
+    if(!layout && (stats_info.has_positions || stats_info.normalize_normals))
+    {
+        used_stats_info = &stats_info;
+    }
+    if(!stats)
+    {
+        stats = &ignored_stats;
+    }
+    init_parser_mesh_stats(stats);
+
+    if(header.format != ply_format_ascii)
+    {
+        parse_ply_binary(memory, file_size, &header, vertices, indices, pool, layout, layout_vertices, polygons, 
+                         used_stats_info, stats);
+        finish_parser_mesh_stats(stats);
+        return;
+    }
+
+    if(header.vertex_count)
+    {
+        PlyElement *vertex_element = get_ply_vertex_element(&header);
+        u8 *vertex_body = memory + vertex_element->body_offset;
+        parse_ply_vertex_body(vertex_body, vertex_body + vertex_element->body_size, &header, vertices, pool, layout, layout_vertices, 
+                              used_stats_info, stats);
+    }
+    finish_parser_mesh_stats(stats);
+
+    Tokenizer tokenizer = {};
+    if(header.face_count)
+    {
+        PlyElement *face_element = get_ply_face_element(&header);
+        tokenizer.at = memory + face_element->body_offset;
+        tokenizer.one_past_end = tokenizer.at + face_element->body_size;
+    }
+
+    u32 index_index = 0;
+    u32 face_index = 0;
+    PlyFastFace face;
+    while(tokenizer.at < tokenizer.one_past_end)
+    {
+        eat_all_whitespaces(&tokenizer);
+        if(tokenizer.at == tokenizer.one_past_end)
+        {
+            break;
+        }
+        skip_ply_ascii_face_properties_before_indices(&tokenizer, &header);
+
+        u8 *row_end = decode_ply_face_row_fast(tokenizer.at, tokenizer.one_past_end, &face);
+        if(row_end && polygons)
+        {
+            assert(index_index + face.index_count <= header.polygon_index_count);
+            polygons->offsets[face_index++] = index_index;
+            for(u32 item_index = 0;
+                    item_index < face.index_count;
+                    ++item_index)
+            {
+                polygons->indices[index_index++] = face.indices[item_index];
+            }
+
+            tokenizer.at = row_end;
+            continue;
+        }
+        else if(row_end)
+        {
+            assert(index_index + 3*(face.index_count - 2) <= header.index_count);
+            for(u32 item_index = 2;
+                    item_index < face.index_count;
+                    ++item_index)
+            {
+                indices[index_index++] = face.indices[0];
+                indices[index_index++] = face.indices[item_index - 1];
+                indices[index_index++] = face.indices[item_index];
+            }
+
+            tokenizer.at = row_end;
+            continue;
+        }
+
+        if(peek_ply_token(&tokenizer).type == 0) // for eof
+        {
+            break;
+        }
+
+        PlyToken index_count = eat_ply_token(&tokenizer);
+        assert(index_count.type == ply_token_type_i32 &&
+                index_count.value_i32 >= 3);
+
+        if(polygons)
+        {
+            polygons->offsets[face_index++] = index_index;
+            for(i32 item_index = 0;
+                    item_index < index_count.value_i32;
+                    ++item_index)
+            {
+                PlyToken index = eat_ply_token(&tokenizer);
+                assert(index.type == ply_token_type_i32);
+                polygons->indices[index_index++] = index.value_i32;
+            }
+
+            eat_line(&tokenizer);
+            continue;
+        }
+
+        PlyToken index_0 = eat_ply_token(&tokenizer); // will be used as a first index to the strip for this line
+        PlyToken index_1 = eat_ply_token(&tokenizer);
+        PlyToken index_2 = eat_ply_token(&tokenizer);
+
+        assert(index_0.type == ply_token_type_i32 && 
+               index_1.type == ply_token_type_i32 &&
+               index_2.type == ply_token_type_i32);
+
+        indices[index_index++] = index_0.value_i32;
+        indices[index_index++] = index_1.value_i32;
+        indices[index_index++] = index_2.value_i32;
+
+        // starting from 1, as we already parsed the first strip
+        for(u32 strip_index = 1;
+                strip_index < index_count.value_i32 - 2;
+                ++strip_index)
+        {
+            u32 second_index = indices[index_index-1];
+            
+            indices[index_index++] = index_0.value_i32;
+            indices[index_index++] = second_index;
+            indices[index_index++] = eat_ply_token(&tokenizer).value_i32;
+        }
+
+        // NOTE(joon) skip the properties after the indices, if there are any
+        eat_line(&tokenizer);
+    }
+
+    if(polygons)
+    {
+        assert(face_index == header.face_count);
+        polygons->offsets[header.face_count] = index_index;
+        assert(index_index == header.polygon_index_count);
+    }
+    else
+    {
+        assert(index_index == header.index_count);
+    }
+}
+
+// NOTE/Joon: This function is more like a general purpose token getter, with minimum erro checking.
+// the error checking itself will happen inside the parsing loop, not here.
+internal ObjToken
+eat_obj_token_no_lookahead(Tokenizer *tokenizer)
+{
+    ObjToken result = {};
+
+    eat_all_whitespaces(tokenizer);
+    
+    if(tokenizer->at < tokenizer->one_past_end)
+    {
+        u8 first = *tokenizer->at;
+
+        // NOTE(joon) numbers first, they are most of the tokens
+        if(is_digit_or_sign(first))
+        {
+            ParseNumericResult parse_result = eat_numeric(tokenizer);
+
+            if(parse_result.is_float)
+            {
+                result.type = obj_token_type_f32;
+                result.value_f32 = parse_result.value_f32;
+            }
+            else
+            {
+                result.type = obj_token_type_i32;
+                result.value_i32 = parse_result.value_i32;
+            }
+        }
+        else if(first == '/')
+        {
+            result.type = obj_token_type_slash;
+            eat(tokenizer, 1);
+        }
+        else
+        {
+            // NOTE(joon) the keywords are checked with the space after them included, 
+            // with one masked compare each
+            u64 word = load_parser_word(tokenizer->at, tokenizer->one_past_end, 8);
+            b32 skip_line = false;
+            switch(first)
+            {
+                case 'v':
+                {
+                    if((word & parser_word_mask(2)) == parser_word('v', ' ', 0, 0, 0, 0, 0, 0))
+                    {
+                        result.type = obj_token_type_v;
+                    }
+                    else if((word & parser_word_mask(3)) == parser_word('v', 'n', ' ', 0, 0, 0, 0, 0))
+                    {
+                        result.type = obj_token_type_vn;
+                    }
+                    else if((word & parser_word_mask(3)) == parser_word('v', 't', ' ', 0, 0, 0, 0, 0))
+                    {
+                        result.type = obj_token_type_vt;
+                    }
+                }break;
+
+                case 'f':
+                {
+                    if((word & parser_word_mask(2)) == parser_word('f', ' ', 0, 0, 0, 0, 0, 0))
+                    {
+                        result.type = obj_token_type_f;
+                    }
+                }break;
+
+                case 'm':
+                {
+                    skip_line = ((word & parser_word_mask(7)) == parser_word('m', 't', 'l', 'l', 'i', 'b', ' ', 0));
+                }break;
+
+                case 'o':
+                {
+                    skip_line = ((word & parser_word_mask(2)) == parser_word('o', ' ', 0, 0, 0, 0, 0, 0));
+                }break;
+
+                case '#':
+                {
+                    skip_line = true;
+                }break;
+            }
+
+            if(result.type != obj_token_type_null)
+            {
+                eat_until_whitespace(tokenizer);
+            }
+            else if(!skip_line && get_inf_or_nan_length(tokenizer->at, tokenizer->one_past_end))
+            {
+                ParseNumericResult parse_result = eat_numeric(tokenizer);
+                result.type = obj_token_type_f32;
+                result.value_f32 = parse_result.is_float ? parse_result.value_f32 : (f32)parse_result.value_i32;
+            }
+            else
+            {
+                // NOTE(joon) comments and the statements that we don't care about(s, g, usemtl...), 
+                // skip the whole line so that the caller doesn't get stuck here
+                eat_until_newline(tokenizer);
+            }
+        }
+    }
+
+    return result;
+}
+
+internal ObjToken
+eat_obj_token(Tokenizer *tokenizer)
+{
+    ObjToken result;
+    if(has_tokenizer_lookahead(tokenizer, tokenizer_lookahead_type_obj))
+    {
+        result = tokenizer->lookahead_obj;
+        tokenizer->at = tokenizer->lookahead_next_at;
+    }
+    else
+    {
+        result = eat_obj_token_no_lookahead(tokenizer);
+    }
+
+    return result;
+}
+
+internal ObjToken
+peek_obj_token(Tokenizer *tokenizer)
+{
+    if(!has_tokenizer_lookahead(tokenizer, tokenizer_lookahead_type_obj))
+    {
+        Tokenizer peek_tokenizer = {};
+        peek_tokenizer.at = tokenizer->at;
+        peek_tokenizer.one_past_end = tokenizer->one_past_end;
+
+        tokenizer->lookahead_obj = eat_obj_token_no_lookahead(&peek_tokenizer);
+        set_tokenizer_lookahead(tokenizer, tokenizer_lookahead_type_obj, peek_tokenizer.at);
+    }
+
+    ObjToken result = tokenizer->lookahead_obj;
+    return result;
+}
+
+internal ObjVertexType
+get_obj_vertex_type(b32 v_appeared, b32 vt_appeared, b32 vn_appeared)
+{
+    ObjVertexType result = obj_vertex_type_v;
+
+    if(v_appeared)
+    {
+        if(!vt_appeared && !vn_appeared)
+        {
+            result = obj_vertex_type_v;
+        }
+        else if(!vt_appeared && vn_appeared)
+        {
+            result = obj_vertex_type_v_vn;
+        }
+        else if(vt_appeared && !vn_appeared)
+        {
+            result = obj_vertex_type_v_vt;
+        }
+        else if(vt_appeared && vn_appeared)
+        {
+            result = obj_vertex_type_v_vt_vn;
+        }
+    }
+    else
+    {
+        invalid_code_path;
+    }
+
+    return result;
+}
+
+// TODO(joon): parsing positions and vertex normals work just fine,
+// but havent yet tested with the texture coords. Will do when I have a png loader :)
+// pre_parse returns how many vertices / normals / indices the user needs to allocate.
+internal PreParseObjResult
+pre_parse_obj(u8 *file, size_t file_size)
+{
+    assert(file && file_size > 0);
+
+    PreParseObjResult result = {};
+
+    Tokenizer tokenizer = {};
+    tokenizer.at = file;
+    tokenizer.one_past_end = file + file_size;
+
+    b32 v_appeared = false;
+    b32 vn_appeared = false;
+    b32 vt_appeared = false;
+
+    while(tokenizer.at < tokenizer.one_past_end)
+    {
+        ObjToken token = eat_obj_token(&tokenizer);
+        switch(token.type)
+        {
+            case obj_token_type_v:
+            {
+                result.position_count++;
+                v_appeared = true;
+            }break;
+            case obj_token_type_vn:
+            {
+                result.normal_count++;
+                vn_appeared = true;
+            }break;
+            case obj_token_type_vt:
+            {
+                result.texcoord_count++;
+                vt_appeared = true;
+            }break;
+
+            case obj_token_type_f:
+            {
+                u32 number_count = 0;
+                while(1)
+                {
+                    ObjToken t = peek_obj_token(&tokenizer);
+
+                    if(t.type == obj_token_type_i32)
+                    {
+                        number_count++;
+                        eat_obj_token(&tokenizer); // actually advance
+                    }
+                    else if(t.type == obj_token_type_slash)
+                    {
+                        eat_obj_token(&tokenizer); // actually advance
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                assert(v_appeared || vt_appeared || vn_appeared);
+
+                u32 strip_count = (number_count / (v_appeared + vt_appeared + vn_appeared));
+                result.index_count += 3 * (strip_count - 2);
+            }break;
+        }
+    }
+
+    result.vertex_type = get_obj_vertex_type(v_appeared, vt_appeared, vn_appeared);
+
+    return result;
+}
+
+internal void
+parse_obj(PreParseObjResult *pre_parse, u8 *file, u32 file_size, 
+        v3 *positions, v3 *normals, v2 *texcoords, u32 *indices)
+{
+    assert(file && file_size > 0);
+    assert(pre_parse->vertex_type == obj_vertex_type_v || 
+           pre_parse->vertex_type == obj_vertex_type_v_vn);
+
+    Tokenizer tokenizer = {};
+    tokenizer.at = file;
+    tokenizer.one_past_end = file + file_size;
+
+    u32 position_index = 0;
+    u32 normal_index = 0;
+    u32 index_index = 0;
+    while(tokenizer.at < tokenizer.one_past_end)
+    {
+        ObjToken token = eat_obj_token(&tokenizer);
+        switch(token.type)
+        {
+            case obj_token_type_v:
+            {
+                ObjToken p0 = eat_obj_token(&tokenizer);
+                ObjToken p1 = eat_obj_token(&tokenizer);
+                ObjToken p2 = eat_obj_token(&tokenizer);
+
+                v3 *position = positions + position_index++;
+
+                numeric_obj_token_to_f32(p0, &position->x);
+                numeric_obj_token_to_f32(p1, &position->y);
+                numeric_obj_token_to_f32(p2, &position->z);
+            }break;
+
+            case obj_token_type_vn:
+            {
+                ObjToken n0 = eat_obj_token(&tokenizer);
+                ObjToken n1 = eat_obj_token(&tokenizer);
+                ObjToken n2 = eat_obj_token(&tokenizer);
+
+                v3 *normal = normals + normal_index++;
+
+                numeric_obj_token_to_f32(n0, &normal->x);
+                numeric_obj_token_to_f32(n1, &normal->y);
+                numeric_obj_token_to_f32(n2, &normal->z);
+            }break;
+
+            case obj_token_type_vt:
+            {
+                // TODO(joon): add support for vt
+            }break;
+
+            case obj_token_type_f:
+            {
+                switch(pre_parse->vertex_type)
+                {
+                    case obj_vertex_type_v:
+                    {
+                        ObjToken i0 = eat_obj_token(&tokenizer);
+                        ObjToken i1 = eat_obj_token(&tokenizer);
+                        ObjToken i2 = eat_obj_token(&tokenizer);
+                        indices[index_index++] = i0.value_i32;
+                        indices[index_index++] = i1.value_i32;
+                        indices[index_index++] = i2.value_i32;
+
+                        while(1)
+                        {
+                            ObjToken t = peek_obj_token(&tokenizer);
+                            if(t.type == obj_token_type_i32)
+                            {
+                                indices[index_index++] = i0.value_i32;
+                                indices[index_index] = indices[index_index-2];
+                                index_index++;
+                                indices[index_index++] = t.value_i32;
+
+                                eat_obj_token(&tokenizer);
+                            }
+                            else
+                            {
+                                break;
+                            }
+                        }
+                    }break;
+                    case obj_vertex_type_v_vn:
+                    {
+                        ObjToken i0 = eat_obj_token(&tokenizer);
+                        ObjToken s0 = eat_obj_token(&tokenizer);
+                        ObjToken s1 = eat_obj_token(&tokenizer);
+                        ObjToken vni0 = eat_obj_token(&tokenizer);
+
+                        ObjToken i1 = eat_obj_token(&tokenizer);
+                        ObjToken s2 = eat_obj_token(&tokenizer);
+                        ObjToken s3 = eat_obj_token(&tokenizer);
+                        ObjToken vni1 = eat_obj_token(&tokenizer);
+
+                        ObjToken i2 = eat_obj_token(&tokenizer);
+                        ObjToken s4 = eat_obj_token(&tokenizer);
+                        ObjToken s5 = eat_obj_token(&tokenizer);
+                        ObjToken vni2 = eat_obj_token(&tokenizer);
+
+                        indices[index_index++] = i0.value_i32;
+                        indices[index_index++] = i1.value_i32;
+                        indices[index_index++] = i2.value_i32;
+
+                        //f 304808//304808 304802//304802 304823//304823 
+
+                        u32 number_count;
+                        while(1)
+                        {
+                            ObjToken t = peek_obj_token(&tokenizer);
+                            if(t.type == obj_token_type_i32)
+                            {
+                                if((number_count & 2) == 0)
+                                {
+                                    indices[index_index++] = i0.value_i32;
+                                    indices[index_index] = indices[index_index-2];
+                                    index_index++;
+                                    indices[index_index++] = t.value_i32;
+                                }
+
+                                number_count++;
+
+                                eat_obj_token(&tokenizer);
+                            }
+                            else if(t.type == obj_token_type_slash)
+                            {
+                                eat_obj_token(&tokenizer);
+                            }
+                            else
+                            {
+                                break;
+                            }
+                        }
+
+                    }break;
+
+                    // TODO(joon) implement these!
+                    case obj_vertex_type_v_vt:
+                    {
+                    }break;
+                    case obj_vertex_type_v_vt_vn:
+                    {
+                    }break;
+                }
+            }break;
+        }
+    }
+}
+
+inline u8 *
+skip_obj_spaces(u8 *at, u8 *one_past_end)
+{
+    while(at < one_past_end && *at == ' ')
+    {
+        at++;
+    }
+
+    return at;
+}
+
+inline b32
+is_obj_value_end(u8 *at, u8 *one_past_end)
+{
+    b32 result = (at == one_past_end || is_token_whitespace(*at));
+    return result;
+}
+
+// NOTE(joon) [+-]digits, up to 9 digits so that it can't overflow. Returns 0 if it's not a plain index.
+inline u8 *
+decode_obj_index_fast(u8 *at, u8 *one_past_end, i32 *value)
+{
+    b32 negative = false;
+    if(at < one_past_end && (*at == '-' || *at == '+'))
+    {
+        negative = (*at == '-');
+        at++;
+    }
+
+    u32 index;
+    u8 *result = decode_parser_small_integer(at, one_past_end, &index);
+    if(result)
+    {
+        *value = negative ? -(i32)index : (i32)index;
+    }
+
+    return result;
+}
+
+// NOTE(joon) space separated numbers until the end of the line
+internal u8 *
+decode_obj_values_fast(u8 *at, u8 *one_past_end, ObjFastLine *line, u32 min_count, u32 max_count)
+{
+    assert(max_count <= sizeof(line->values)/sizeof(line->values[0]));
+
+    u32 value_count = 0;
+    while(1)
+    {
+        at = skip_obj_spaces(at, one_past_end);
+        if(at == one_past_end || is_token_newline(*at))
+        {
+            break;
+        }
+
+        if(value_count == max_count || !is_digit_or_sign(*at))
+        {
+            return 0;
+        }
+
+        Tokenizer number_tokenizer = {};
+        number_tokenizer.at = at;
+        number_tokenizer.one_past_end = one_past_end;
+        ParseNumericResult number = eat_numeric(&number_tokenizer);
+        at = number_tokenizer.at;
+        if(!is_obj_value_end(at, one_past_end))
+        {
+            return 0;
+        }
+
+        line->values[value_count++] = number.is_float ? number.value_f32 : (f32)number.value_i32;
+    }
+
+    u8 *result = 0;
+    if(value_count >= min_count)
+    {
+        line->value_count = value_count;
+        result = at;
+    }
+
+    return result;
+}
+
+// NOTE(joon) corners can be v, v/vt, v//vn or v/vt/vn
+internal u8 *
+decode_obj_face_fast(u8 *at, u8 *one_past_end, ObjFastLine *line)
+{
+    u32 corner_count = 0;
+    while(1)
+    {
+        at = skip_obj_spaces(at, one_past_end);
+        if(at == one_past_end || is_token_newline(*at))
+        {
+            break;
+        }
+
+        if(corner_count == obj_fast_line_max_corner_count)
+        {
+            return 0;
+        }
+
+        ObjCorner *corner = line->corners + corner_count++;
+        *corner = {};
+        at = decode_obj_index_fast(at, one_past_end, &corner->v);
+        if(at && at < one_past_end && *at == '/')
+        {
+            at++;
+            if(at < one_past_end && *at == '/')
+            {
+                at = decode_obj_index_fast(at + 1, one_past_end, &corner->vn);
+            }
+            else
+            {
+                at = decode_obj_index_fast(at, one_past_end, &corner->vt);
+                if(at && at < one_past_end && *at == '/')
+                {
+                    at = decode_obj_index_fast(at + 1, one_past_end, &corner->vn);
+                }
+            }
+        }
+
+        if(!at || !is_obj_value_end(at, one_past_end))
+        {
+            return 0;
+        }
+    }
+
+    u8 *result = 0;
+    if(corner_count >= 3)
+    {
+        line->corner_count = corner_count;
+        result = at;
+    }
+
+    return result;
+}
+
+// NOTE(joon) fused decoder for the lines that make up most of the obj files : 
+// v with 3 or 4 values(w is ignored), vn, vt with 1 ~ 3 values, and f. 
+// Parses the whole line in one go, without going through the tokenizer for each number. 
+// Returns where the line ends, or 0 if the line is not one of them or isn't written the way that it expects
+// (comments at the end of the line, inf/nan, very big indices...). 
+// In that case the caller should tokenize the line as usual.
+// at should be at the start of the line.
+internal u8 *
+decode_obj_line_fast(u8 *at, u8 *one_past_end, ObjFastLine *line)
+{
+    u8 *result = 0;
+
+    u64 word = load_parser_word(at, one_past_end, 3);
+    if((word & parser_word_mask(2)) == parser_word('v', ' ', 0, 0, 0, 0, 0, 0))
+    {
+        line->type = obj_token_type_v;
+        result = decode_obj_values_fast(at + 2, one_past_end, line, 3, 4);
+    }
+    else if(word == parser_word('v', 'n', ' ', 0, 0, 0, 0, 0))
+    {
+        line->type = obj_token_type_vn;
+        result = decode_obj_values_fast(at + 3, one_past_end, line, 3, 3);
+    }
+    else if(word == parser_word('v', 't', ' ', 0, 0, 0, 0, 0))
+    {
+        line->type = obj_token_type_vt;
+        result = decode_obj_values_fast(at + 3, one_past_end, line, 1, 3);
+    }
+    else if((word & parser_word_mask(2)) == parser_word('f', ' ', 0, 0, 0, 0, 0, 0))
+    {
+        line->type = obj_token_type_f;
+        result = decode_obj_face_fast(at + 2, one_past_end, line);
+    }
+
+    return result;
+}
+
+internal void
+init_obj_chunk(ObjChunk *chunk)
+{
+    *chunk = {};
+    init_parser_block_list(&chunk->positions, sizeof(v3));
+    init_parser_block_list(&chunk->normals, sizeof(v3));
+    init_parser_block_list(&chunk->texcoords, sizeof(v2));
+    init_parser_block_list(&chunk->indices, sizeof(u32));
+    init_parser_block_list(&chunk->corners, sizeof(ObjCorner));
+    init_parser_block_list(&chunk->face_sizes, sizeof(u32));
+}
+
+// NOTE(joon) fan triangulation, same as parse_obj
+inline void
+push_obj_chunk_triangle(ParserArena *arena, ObjChunk *chunk, ObjCorner corner_0, ObjCorner corner_1, ObjCorner corner_2)
+{
+    if(chunk->weld)
+    {
+        *(ObjCorner *)push_parser_block_list(arena, &chunk->corners) = corner_0;
+        *(ObjCorner *)push_parser_block_list(arena, &chunk->corners) = corner_1;
+        *(ObjCorner *)push_parser_block_list(arena, &chunk->corners) = corner_2;
+    }
+    else
+    {
+        *(u32 *)push_parser_block_list(arena, &chunk->indices) = (u32)corner_0.v;
+        *(u32 *)push_parser_block_list(arena, &chunk->indices) = (u32)corner_1.v;
+        *(u32 *)push_parser_block_list(arena, &chunk->indices) = (u32)corner_2.v;
+    }
+}
+
+internal void
+push_obj_fast_line(ParserArena *arena, ObjChunk *chunk, ObjFastLine *line)
+{
+    switch(line->type)
+    {
+        case obj_token_type_v:
+        {
+            v3 *position = (v3 *)push_parser_block_list(arena, &chunk->positions);
+            position->x = line->values[0];
+            position->y = line->values[1];
+            position->z = line->values[2];
+            if(chunk->compute_stats)
+            {
+                add_parser_mesh_stats_position(&chunk->stats, line->values[0], line->values[1], line->values[2]);
+            }
+
+            chunk->v_appeared = true;
+        }break;
+
+        case obj_token_type_vn:
+        {
+            f32 x = line->values[0];
+            f32 y = line->values[1];
+            f32 z = line->values[2];
+            if(chunk->normalize_normals)
+            {
+                normalize_parser_normal(&x, &y, &z);
+            }
+
+            v3 *normal = (v3 *)push_parser_block_list(arena, &chunk->normals);
+            normal->x = x;
+            normal->y = y;
+            normal->z = z;
+
+            chunk->vn_appeared = true;
+        }break;
+
+        case obj_token_type_vt:
+        {
+            v2 *texcoord = (v2 *)push_parser_block_list(arena, &chunk->texcoords);
+            texcoord->x = line->values[0];
+            texcoord->y = (line->value_count >= 2) ? line->values[1] : 0.0f;
+
+            chunk->texcoord_count++;
+            chunk->vt_appeared = true;
+        }break;
+
+        case obj_token_type_f:
+        {
+            if(chunk->keep_polygons)
+            {
+                for(u32 corner_index = 0;
+                        corner_index < line->corner_count;
+                        ++corner_index)
+                {
+                    *(u32 *)push_parser_block_list(arena, &chunk->indices) = (u32)line->corners[corner_index].v;
+                }
+                *(u32 *)push_parser_block_list(arena, &chunk->face_sizes) = line->corner_count;
+            }
+            else
+            {
+                for(u32 corner_index = 2;
+                        corner_index < line->corner_count;
+                        ++corner_index)
+                {
+                    push_obj_chunk_triangle(arena, chunk, line->corners[0], line->corners[corner_index - 1], line->corners[corner_index]);
+                }
+            }
+        }break;
+
+        default:
+        {
+            invalid_code_path;
+        }break;
+    }
+}
+
+// NOTE(joon) parses v, vn and f statements of [start, one_past_end) in one pass, 
+// pushing the results to the growable lists inside the chunk.
+// The range should start at the beginning of a line.
+internal void
+parse_obj_chunk(ParserArena *arena, ObjChunk *chunk, u8 *start, u8 *one_past_end)
+{
+    Tokenizer tokenizer = {};
+    tokenizer.at = start;
+    tokenizer.one_past_end = one_past_end;
+
+    ObjFastLine line;
+    while(tokenizer.at < tokenizer.one_past_end)
+    {
+        eat_all_whitespaces(&tokenizer);
+
+        u8 *line_end = decode_obj_line_fast(tokenizer.at, tokenizer.one_past_end, &line);
+        if(line_end)
+        {
+            push_obj_fast_line(arena, chunk, &line);
+            tokenizer.at = line_end;
+            continue;
+        }
+
+        ObjToken token = eat_obj_token(&tokenizer);
+        switch(token.type)
+        {
+            case obj_token_type_v:
+            {
+                ObjToken p0 = eat_obj_token(&tokenizer);
+                ObjToken p1 = eat_obj_token(&tokenizer);
+                ObjToken p2 = eat_obj_token(&tokenizer);
+
+                v3 *position = (v3 *)push_parser_block_list(arena, &chunk->positions);
+
+                numeric_obj_token_to_f32(p0, &position->x);
+                numeric_obj_token_to_f32(p1, &position->y);
+                numeric_obj_token_to_f32(p2, &position->z);
+                if(chunk->compute_stats)
+                {
+                    add_parser_mesh_stats_position(&chunk->stats, position->x, position->y, position->z);
+                }
+
+                chunk->v_appeared = true;
+            }break;
+
+            case obj_token_type_vn:
+            {
+                ObjToken n0 = eat_obj_token(&tokenizer);
+                ObjToken n1 = eat_obj_token(&tokenizer);
+                ObjToken n2 = eat_obj_token(&tokenizer);
+
+                v3 *normal = (v3 *)push_parser_block_list(arena, &chunk->normals);
+
+                numeric_obj_token_to_f32(n0, &normal->x);
+                numeric_obj_token_to_f32(n1, &normal->y);
+                numeric_obj_token_to_f32(n2, &normal->z);
+                if(chunk->normalize_normals)
+                {
+                    normalize_parser_normal(&normal->x, &normal->y, &normal->z);
+                }
+
+                chunk->vn_appeared = true;
+            }break;
+
+            case obj_token_type_vt:
+            {
+                // NOTE(joon) vt u [v [w]], w is ignored
+                ObjToken t0 = eat_obj_token(&tokenizer);
+
+                v2 *texcoord = (v2 *)push_parser_block_list(arena, &chunk->texcoords);
+                numeric_obj_token_to_f32(t0, &texcoord->x);
+                texcoord->y = 0.0f;
+
+                ObjToken t1 = peek_obj_token(&tokenizer);
+                if(t1.type == obj_token_type_f32 || t1.type == obj_token_type_i32)
+                {
+                    eat_obj_token(&tokenizer);
+                    numeric_obj_token_to_f32(t1, &texcoord->y);
+                }
+
+                chunk->texcoord_count++;
+                chunk->vt_appeared = true;
+            }break;
+
+            case obj_token_type_f:
+            {
+                // NOTE(joon) each face vertex can be v, v/vt, v//vn or v/vt/vn. 
+                // Unless we are welding, we only need the position index
+                ObjCorner first_corner = {};
+                ObjCorner previous_corner = {};
+                u32 face_vertex_count = 0;
+                while(1)
+                {
+                    ObjToken t = peek_obj_token(&tokenizer);
+                    if(t.type != obj_token_type_i32)
+                    {
+                        break;
+                    }
+                    eat_obj_token(&tokenizer);
+
+                    ObjCorner corner = {};
+                    corner.v = t.value_i32;
+
+                    u32 slash_count = 0;
+                    while(peek_obj_token(&tokenizer).type == obj_token_type_slash)
+                    {
+                        eat_obj_token(&tokenizer);
+                        slash_count++;
+
+                        ObjToken after_slash = peek_obj_token(&tokenizer);
+                        if(after_slash.type == obj_token_type_i32)
+                        {
+                            eat_obj_token(&tokenizer);
+                            if(slash_count == 1)
+                            {
+                                corner.vt = after_slash.value_i32;
+                            }
+                            else
+                            {
+                                corner.vn = after_slash.value_i32;
+                            }
+                        }
+                    }
+
+                    if(chunk->keep_polygons)
+                    {
+                        *(u32 *)push_parser_block_list(arena, &chunk->indices) = (u32)corner.v;
+                    }
+                    else if(face_vertex_count == 0)
+                    {
+                        first_corner = corner;
+                    }
+                    else if(face_vertex_count >= 2)
+                    {
+                        push_obj_chunk_triangle(arena, chunk, first_corner, previous_corner, corner);
+                    }
+
+                    previous_corner = corner;
+                    face_vertex_count++;
+                }
+
+                assert(face_vertex_count >= 3);
+                if(chunk->keep_polygons)
+                {
+                    *(u32 *)push_parser_block_list(arena, &chunk->face_sizes) = face_vertex_count;
+                }
+            }break;
+        }
+    }
+}
+
+internal void
+parse_obj_chunk_work(void *data)
+{
+    ObjChunkWork *work = (ObjChunkWork *)data;
+
+    b32 weld = work->chunk.weld;
+    b32 keep_polygons = work->chunk.keep_polygons;
+    b32 compute_stats = work->chunk.compute_stats;
+    b32 normalize_normals = work->chunk.normalize_normals;
+    init_obj_chunk(&work->chunk);
+    work->chunk.weld = weld;
+    work->chunk.keep_polygons = keep_polygons;
+    work->chunk.compute_stats = compute_stats;
+    work->chunk.normalize_normals = normalize_normals;
+    init_parser_mesh_stats(&work->chunk.stats);
+    parse_obj_chunk(&work->arena, &work->chunk, work->start, work->one_past_end);
+}
+
+internal void
+copy_obj_chunk_work(void *data)
+{
+    ObjChunkWork *work = (ObjChunkWork *)data;
+
+    copy_parser_block_list(&work->chunk.positions, work->positions);
+    copy_parser_block_list(&work->chunk.normals, work->normals);
+    copy_parser_block_list(&work->chunk.texcoords, work->texcoords);
+    copy_parser_block_list(&work->chunk.indices, work->indices);
+}
+
+// NOTE(joon) parses the chunks(in parallel if the pool is given), and copies them into 
+// the final arrays inside the result. The chunk arenas are still alive after this, 
+// so that load_obj_welded can use the corners. end_load_obj frees them.
+// If keep_polygons is true, the indices are the polygon corners(see load_obj_polygons).
+// If the stats are given, each chunk adds its positions to its own stats while it parses them, 
+// and they are merged here. normalize_normals makes the vn unit length before they are stored.
+internal ObjChunkWork *
+begin_load_obj(ParserArena *arena, u8 *file, size_t file_size, ParserThreadPool *pool, b32 weld, 
+               LoadObjResult *result, u32 *chunk_count_result, b32 keep_polygons = false, 
+               ParserMeshStats *stats = 0, b32 normalize_normals = false)
+{
+    assert(!(weld && keep_polygons));
+    assert(file && file_size > 0);
+
+    *result = {};
+
+    u32 chunk_count = get_parser_chunk_count(pool, file_size, 1024*1024);
+    ObjChunkWork *works = push_parser_array(arena, ObjChunkWork, chunk_count);
+
+    u8 *one_past_end = file + file_size;
+    u8 *chunk_start = file;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        u8 *chunk_end = one_past_end;
+        if(chunk_index != chunk_count - 1)
+        {
+            chunk_end = get_next_line_start(file, file + (file_size/chunk_count)*(chunk_index + 1), one_past_end);
+        }
+
+        ObjChunkWork *work = works + chunk_index;
+        *work = {};
+        work->arena = begin_parser_sub_arena(arena);
+        work->start = chunk_start;
+        work->one_past_end = chunk_end;
+        work->chunk.weld = weld;
+        work->chunk.keep_polygons = keep_polygons;
+        work->chunk.compute_stats = (stats != 0);
+        work->chunk.normalize_normals = normalize_normals;
+
+        add_parser_work(pool, parse_obj_chunk_work, work);
+
+        chunk_start = chunk_end;
+    }
+    complete_all_parser_work(pool);
+
+    b32 v_appeared = false;
+    b32 vt_appeared = false;
+    b32 vn_appeared = false;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjChunk *chunk = &works[chunk_index].chunk;
+
+        result->counts.position_count += chunk->positions.total_count;
+        result->counts.normal_count += chunk->normals.total_count;
+        result->counts.texcoord_count += chunk->texcoord_count;
+        result->counts.index_count += weld ? chunk->corners.total_count : chunk->indices.total_count;
+
+        v_appeared |= chunk->v_appeared;
+        vt_appeared |= chunk->vt_appeared;
+        vn_appeared |= chunk->vn_appeared;
+    }
+    result->counts.vertex_type = get_obj_vertex_type(v_appeared, vt_appeared, vn_appeared);
+
+    if(stats)
+    {
+        init_parser_mesh_stats(stats);
+        for(u32 chunk_index = 0;
+                chunk_index < chunk_count;
+                ++chunk_index)
+        {
+            merge_parser_mesh_stats(stats, &works[chunk_index].chunk.stats);
+        }
+        finish_parser_mesh_stats(stats);
+    }
+
+    result->positions = push_parser_array(arena, v3, result->counts.position_count);
+    result->normals = push_parser_array(arena, v3, result->counts.normal_count);
+    result->texcoords = push_parser_array(arena, v2, result->counts.texcoord_count);
+    if(!weld)
+    {
+        result->indices = push_parser_array(arena, u32, result->counts.index_count);
+    }
+
+    // NOTE(joon) prefix sum, and then scatter the chunks into the final arrays
+    u32 position_offset = 0;
+    u32 normal_offset = 0;
+    u32 texcoord_offset = 0;
+    u32 index_offset = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjChunkWork *work = works + chunk_index;
+
+        work->positions = result->positions + position_offset;
+        work->normals = result->normals + normal_offset;
+        work->texcoords = result->texcoords + texcoord_offset;
+        work->indices = result->indices + index_offset;
+
+        position_offset += work->chunk.positions.total_count;
+        normal_offset += work->chunk.normals.total_count;
+        texcoord_offset += work->chunk.texcoords.total_count;
+        index_offset += work->chunk.indices.total_count;
+
+        add_parser_work(pool, copy_obj_chunk_work, work);
+    }
+    complete_all_parser_work(pool);
+
+    *chunk_count_result = chunk_count;
+
+    return works;
+}
+
+internal void
+end_load_obj(ObjChunkWork *works, u32 chunk_count)
+{
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        free_parser_arena(&works[chunk_index].arena);
+    }
+}
+
+// NOTE(joon) one pass version of pre_parse_obj + parse_obj. 
+// Everything is allocated inside the arena, so the caller can free them all 
+// with free_parser_arena.
+// If the pool is given, the file is cut into newline aligned chunks that are parsed in parallel, 
+// and then the chunks are copied into the final arrays using the prefix sum of the counts. 
+// The output is the same with or without the pool.
+// If the stats are given, they are made while the positions are parsed(see begin_load_obj).
+internal LoadObjResult
+load_obj(ParserArena *arena, u8 *file, size_t file_size, ParserThreadPool *pool = 0, 
+         ParserMeshStats *stats = 0, b32 normalize_normals = false)
+{
+    LoadObjResult result;
+
+    u32 chunk_count;
+    ObjChunkWork *works = begin_load_obj(arena, file, file_size, pool, false, &result, &chunk_count, false, stats, normalize_normals);
+    end_load_obj(works, chunk_count);
+
+    return result;
+}
+
+// NOTE(joon) face sizes of one chunk -> offsets, starting from the chunk's first index
+internal void
+fill_obj_polygon_offsets_work(void *data)
+{
+    ObjChunkWork *work = (ObjChunkWork *)data;
+
+    u32 offset = work->first_index;
+    u32 face_index = 0;
+    for(ParserBlock *block = work->chunk.face_sizes.first;
+            block;
+            block = block->next)
+    {
+        u32 *face_sizes = (u32 *)(block + 1);
+        for(u32 i = 0;
+                i < block->count;
+                ++i)
+        {
+            work->face_offsets[face_index++] = offset;
+            offset += face_sizes[i];
+        }
+    }
+}
+
+// NOTE(joon) same as load_obj, but the faces are not triangulated(see ParserPolygons). 
+// Each chunk keeps the number of corners of its faces, and the offsets are made from them in parallel 
+// with the prefix sum of the chunk counts.
+internal LoadObjPolygonsResult
+load_obj_polygons(ParserArena *arena, u8 *file, size_t file_size, ParserThreadPool *pool = 0, 
+                  ParserMeshStats *stats = 0, b32 normalize_normals = false)
+{
+    LoadObjPolygonsResult result = {};
+
+    LoadObjResult mesh;
+    u32 chunk_count;
+    ObjChunkWork *works = begin_load_obj(arena, file, file_size, pool, false, &mesh, &chunk_count, true, stats, normalize_normals);
+
+    result.counts = mesh.counts;
+    result.positions = mesh.positions;
+    result.normals = mesh.normals;
+    result.texcoords = mesh.texcoords;
+    result.polygons.indices = mesh.indices;
+    result.polygons.index_count = mesh.counts.index_count;
+
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        result.polygons.face_count += works[chunk_index].chunk.face_sizes.total_count;
+    }
+    result.polygons.offsets = push_parser_array(arena, u32, result.polygons.face_count + 1);
+    result.polygons.offsets[result.polygons.face_count] = result.polygons.index_count;
+
+    u32 face_offset = 0;
+    u32 index_offset = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjChunkWork *work = works + chunk_index;
+        work->face_offsets = result.polygons.offsets + face_offset;
+        work->first_index = index_offset;
+
+        face_offset += work->chunk.face_sizes.total_count;
+        index_offset += work->chunk.indices.total_count;
+
+        add_parser_work(pool, fill_obj_polygon_offsets_work, work);
+    }
+    complete_all_parser_work(pool);
+
+    end_load_obj(works, chunk_count);
+
+    return result;
+}
+
+internal void
+triangulate_parser_polygons_work(void *data)
+{
+    ParserTriangulateWork *work = (ParserTriangulateWork *)data;
+    ParserPolygons *polygons = work->polygons;
+
+    u32 *indices = work->indices;
+    for(u32 face_index = work->first_face;
+            face_index < work->first_face + work->face_count;
+            ++face_index)
+    {
+        u32 *corners = polygons->indices + polygons->offsets[face_index];
+        u32 corner_count = polygons->offsets[face_index + 1] - polygons->offsets[face_index];
+        assert(corner_count >= 3);
+
+        for(u32 corner_index = 2;
+                corner_index < corner_count;
+                ++corner_index)
+        {
+            *indices++ = corners[0];
+            *indices++ = corners[corner_index - 1];
+            *indices++ = corners[corner_index];
+        }
+    }
+}
+
+// NOTE(joon) fan triangulation of the polygons, which gives the same indices as the loaders 
+// without the polygon mode. A range of faces always has (corners - 2*faces) triangles, 
+// so each range knows where to write without counting anything, and the ranges are triangulated in parallel.
+internal u32 *
+triangulate_parser_polygons(ParserArena *arena, ParserPolygons *polygons, u32 *index_count_result, ParserThreadPool *pool = 0)
+{
+    u32 index_count = 3*(polygons->index_count - 2*polygons->face_count);
+    u32 *result = push_parser_array(arena, u32, index_count);
+
+    u32 chunk_count = get_parser_chunk_count(pool, (size_t)polygons->index_count*sizeof(u32), 1024*1024);
+    ParserArena work_arena = begin_parser_sub_arena(arena);
+    ParserTriangulateWork *works = push_parser_array(&work_arena, ParserTriangulateWork, chunk_count);
+
+    u32 face_index = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        u32 next_face_index = (u32)(((u64)polygons->face_count*(chunk_index + 1))/chunk_count);
+
+        ParserTriangulateWork *work = works + chunk_index;
+        work->polygons = polygons;
+        work->first_face = face_index;
+        work->face_count = next_face_index - face_index;
+
+        u32 corner_offset = polygons->offsets[face_index];
+        work->indices = result + 3*(corner_offset - 2*face_index);
+
+        add_parser_work(pool, triangulate_parser_polygons_work, work);
+
+        face_index = next_face_index;
+    }
+    complete_all_parser_work(pool);
+    free_parser_arena(&work_arena);
+
+    *index_count_result = index_count;
+
+    return result;
+}
+
+inline u32
+hash_obj_corner(ObjCorner corner)
+{
+    u64 hash = ((u64)(u32)corner.v*0x9e3779b97f4a7c15ull) ^ 
+               ((u64)(u32)corner.vt*0xc2b2ae3d27d4eb4full) ^ 
+               ((u64)(u32)corner.vn*0x165667b19e3779f9ull);
+    hash ^= (hash >> 29);
+
+    u32 result = (u32)(hash >> 32);
+    return result;
+}
+
+// NOTE(joon) at least twice the maximum number of the keys, so the load factor never goes above 0.5
+internal u32
+get_obj_weld_slot_count(u32 max_key_count)
+{
+    u32 result = 16;
+    while(result < 2*max_key_count)
+    {
+        result *= 2;
+    }
+
+    return result;
+}
+
+// NOTE(joon) linear probing. If the corner is not in the table, inserts it with the value next_value, 
+// and sets *inserted to true.
+inline u32
+find_or_add_obj_weld_slot(ObjWeldSlot *slots, u32 slot_count, ObjCorner corner, u32 next_value, b32 *inserted)
+{
+    assert(corner.v != 0);
+
+    u32 mask = slot_count - 1;
+    u32 slot_index = hash_obj_corner(corner) & mask;
+    while(1)
+    {
+        ObjWeldSlot *slot = slots + slot_index;
+        if(slot->key.v == 0)
+        {
+            slot->key = corner;
+            slot->value = next_value;
+            *inserted = true;
+            return next_value;
+        }
+        else if(slot->key.v == corner.v && 
+                slot->key.vt == corner.vt && 
+                slot->key.vn == corner.vn)
+        {
+            *inserted = false;
+            return slot->value;
+        }
+
+        slot_index = (slot_index + 1) & mask;
+    }
+}
+
+// NOTE(joon) first pass of the welding, each chunk finds its own unique corners
+internal void
+weld_obj_chunk_work(void *data)
+{
+    ObjChunkWork *work = (ObjChunkWork *)data;
+    ParserBlockList *corners = &work->chunk.corners;
+
+    u32 slot_count = get_obj_weld_slot_count(corners->total_count);
+    ParserArena table_arena = begin_parser_sub_arena(&work->arena);
+    ObjWeldSlot *slots = push_parser_array(&table_arena, ObjWeldSlot, slot_count);
+    memset(slots, 0, sizeof(ObjWeldSlot)*slot_count);
+
+    work->local_indices = push_parser_array(&work->arena, u32, corners->total_count);
+    work->local_uniques = push_parser_array(&work->arena, ObjCorner, corners->total_count);
+    work->local_unique_count = 0;
+
+    u32 corner_index = 0;
+    for(ParserBlock *block = corners->first;
+            block;
+            block = block->next)
+    {
+        ObjCorner *block_corners = (ObjCorner *)(block + 1);
+        for(u32 i = 0;
+                i < block->count;
+                ++i)
+        {
+            ObjCorner corner = block_corners[i];
+
+            b32 inserted;
+            u32 local_index = find_or_add_obj_weld_slot(slots, slot_count, corner, work->local_unique_count, &inserted);
+            if(inserted)
+            {
+                work->local_uniques[work->local_unique_count++] = corner;
+            }
+
+            work->local_indices[corner_index++] = local_index;
+        }
+    }
+
+    free_parser_arena(&table_arena);
+}
+
+// NOTE(joon) last pass of the welding, local indices -> global indices
+internal void
+remap_obj_chunk_work(void *data)
+{
+    ObjChunkWork *work = (ObjChunkWork *)data;
+
+    for(u32 corner_index = 0;
+            corner_index < work->chunk.corners.total_count;
+            ++corner_index)
+    {
+        work->indices[corner_index] = work->local_to_global[work->local_indices[corner_index]];
+    }
+}
+
+internal void
+fill_obj_welded_vertices(LoadObjResult *attributes, ObjCorner *corners, u32 count, ObjVertex *vertices)
+{
+    for(u32 i = 0;
+            i < count;
+            ++i)
+    {
+        ObjCorner corner = corners[i];
+        ObjVertex *vertex = vertices + i;
+        *vertex = {};
+
+        assert(corner.v > 0 && (u32)corner.v <= attributes->counts.position_count);
+        vertex->p = attributes->positions[corner.v - 1];
+        if(corner.vn)
+        {
+            assert(corner.vn > 0 && (u32)corner.vn <= attributes->counts.normal_count);
+            vertex->normal = attributes->normals[corner.vn - 1];
+        }
+        if(corner.vt)
+        {
+            assert(corner.vt > 0 && (u32)corner.vt <= attributes->counts.texcoord_count);
+            vertex->texcoord = attributes->texcoords[corner.vt - 1];
+        }
+    }
+}
+
+internal void
+fill_obj_welded_vertices_work(void *data)
+{
+    ObjWeldVertexWork *work = (ObjWeldVertexWork *)data;
+
+    if(work->layout)
+    {
+        // NOTE(joon) one more vertex, so that the 4 wide load of the last texcoord stays inside
+        ObjVertex vertices[parser_layout_batch_vertex_count + 1];
+        assert(sizeof(ObjVertex) == 8*sizeof(f32));
+
+        for(u32 vertex_index = 0;
+                vertex_index < work->count;
+                vertex_index += parser_layout_batch_vertex_count)
+        {
+            u32 batch_count = work->count - vertex_index;
+            if(batch_count > parser_layout_batch_vertex_count)
+            {
+                batch_count = parser_layout_batch_vertex_count;
+            }
+
+            fill_obj_welded_vertices(work->attributes, work->corners + vertex_index, batch_count, vertices);
+            write_parser_layout_vertices(work->layout, work->layout_vertices, (f32 *)vertices, 8, 
+                                         work->first_vertex + vertex_index, batch_count);
+        }
+    }
+    else
+    {
+        fill_obj_welded_vertices(work->attributes, work->corners, work->count, work->vertices);
+    }
+}
+
+// NOTE(joon) load_obj for the renderers. Every unique (v, vt, vn) combination becomes one vertex, 
+// and the indices point to those vertices(0 based), so there is no need for the de-indexing pass.
+// 1. each chunk welds its own corners with a local open addressing table, in parallel
+// 2. the local uniques are merged into one global table in chunk order, 
+//    so the vertex order is the same as the serial version(first appearance)
+// 3. the indices are remapped and the vertices are filled in parallel
+// The tables are always 2x the number of the keys(16 bytes per slot), and are freed before returning.
+// Negative(relative) indices are not supported.
+// If the layout is given, vertices stays 0 and the vertices go into layout_vertices instead(see load_obj_welded_with_layout).
+internal LoadObjWeldedResult
+load_obj_welded(ParserArena *arena, u8 *file, size_t file_size, ParserThreadPool *pool = 0, 
+                ParserVertexLayout *layout = 0, ParserVertexBuffers *layout_vertices = 0)
+{
+    LoadObjWeldedResult result = {};
+
+    // NOTE(joon) positions, normals and texcoords are only needed until the vertices are filled
+    ParserArena attribute_arena = begin_parser_sub_arena(arena);
+
+    LoadObjResult attributes;
+    u32 chunk_count;
+    ObjChunkWork *works = begin_load_obj(&attribute_arena, file, file_size, pool, true, &attributes, &chunk_count);
+
+    result.vertex_type = attributes.counts.vertex_type;
+    result.index_count = attributes.counts.index_count;
+    result.indices = push_parser_array(arena, u32, result.index_count);
+
+    u32 local_unique_count = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        add_parser_work(pool, weld_obj_chunk_work, works + chunk_index);
+    }
+    complete_all_parser_work(pool);
+
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        local_unique_count += works[chunk_index].local_unique_count;
+    }
+
+    u32 slot_count = get_obj_weld_slot_count(local_unique_count);
+    ObjWeldSlot *slots = push_parser_array(&attribute_arena, ObjWeldSlot, slot_count);
+    memset(slots, 0, sizeof(ObjWeldSlot)*slot_count);
+    ObjCorner *global_uniques = push_parser_array(&attribute_arena, ObjCorner, local_unique_count);
+
+    u32 index_offset = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjChunkWork *work = works + chunk_index;
+        work->local_to_global = push_parser_array(&work->arena, u32, work->local_unique_count);
+
+        for(u32 local_index = 0;
+                local_index < work->local_unique_count;
+                ++local_index)
+        {
+            ObjCorner corner = work->local_uniques[local_index];
+
+            b32 inserted;
+            u32 global_index = find_or_add_obj_weld_slot(slots, slot_count, corner, result.vertex_count, &inserted);
+            if(inserted)
+            {
+                global_uniques[result.vertex_count++] = corner;
+            }
+
+            work->local_to_global[local_index] = global_index;
+        }
+
+        work->indices = result.indices + index_offset;
+        index_offset += work->chunk.corners.total_count;
+
+        add_parser_work(pool, remap_obj_chunk_work, work);
+    }
+
+    if(layout)
+    {
+        *layout_vertices = allocate_parser_vertex_buffers(arena, layout, 8, result.vertex_count);
+    }
+    else
+    {
+        result.vertices = push_parser_array(arena, ObjVertex, result.vertex_count);
+    }
+
+    u32 vertex_chunk_count = get_parser_chunk_count(pool, (size_t)result.vertex_count*sizeof(ObjVertex), 1024*1024);
+    ObjWeldVertexWork *vertex_works = push_parser_array(&attribute_arena, ObjWeldVertexWork, vertex_chunk_count);
+    u32 vertex_index = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < vertex_chunk_count;
+            ++chunk_index)
+    {
+        u32 next_vertex_index = (u32)(((u64)result.vertex_count*(chunk_index + 1))/vertex_chunk_count);
+
+        ObjWeldVertexWork *work = vertex_works + chunk_index;
+        *work = {};
+        work->corners = global_uniques + vertex_index;
+        work->count = next_vertex_index - vertex_index;
+        work->attributes = &attributes;
+        if(layout)
+        {
+            work->layout = layout;
+            work->layout_vertices = layout_vertices;
+            work->first_vertex = vertex_index;
+        }
+        else
+        {
+            work->vertices = result.vertices + vertex_index;
+        }
+
+        add_parser_work(pool, fill_obj_welded_vertices_work, work);
+
+        vertex_index = next_vertex_index;
+    }
+    complete_all_parser_work(pool);
+
+    end_load_obj(works, chunk_count);
+    free_parser_arena(&attribute_arena);
+
+    return result;
+}
+
+// NOTE(joon) same as load_obj_welded, but the vertices are written in the layout. 
+// Sources are the ObjVertexSource offsets(position, normal, texcoord), 
+// and the attributes that are not in the file are 0 as usual.
+internal LoadObjWeldedLayoutResult
+load_obj_welded_with_layout(ParserArena *arena, u8 *file, size_t file_size, ParserVertexLayout *layout, ParserThreadPool *pool = 0)
+{
+    LoadObjWeldedLayoutResult result = {};
+
+    LoadObjWeldedResult welded = load_obj_welded(arena, file, file_size, pool, layout, &result.vertices);
+    result.vertex_type = welded.vertex_type;
+    result.indices = welded.indices;
+    result.index_count = welded.index_count;
+
+    return result;
+}
+
+// NOTE(joon) same as load_obj, but for ply. The header tells us the sizes, 
+// so there is no need for the growable lists here.
+// If the stats are given, they are made while the vertices are decoded(see parse_ply).
+internal LoadPlyResult
+load_ply(ParserArena *arena, u8 *file, size_t file_size, ParserThreadPool *pool = 0, 
+         ParserMeshStats *stats = 0, b32 normalize_normals = false)
+{
+    assert(file && file_size > 0);
+
+    LoadPlyResult result = {};
+    result.header = parse_ply_header(file, file_size);
+    result.vertices = push_parser_array(arena, f32, (size_t)result.header.vertex_count*result.header.vertex_property_count);
+    result.indices = push_parser_array(arena, u32, result.header.index_count);
+
+    parse_ply(file, file_size, result.header, result.vertices, result.indices, pool, 0, 0, 0, stats, normalize_normals);
+
+    return result;
+}
+
+// NOTE(joon) same as load_ply, but the faces are not triangulated(see ParserPolygons)
+internal LoadPlyPolygonsResult
+load_ply_polygons(ParserArena *arena, u8 *file, size_t file_size, ParserThreadPool *pool = 0, 
+                  ParserMeshStats *stats = 0, b32 normalize_normals = false)
+{
+    assert(file && file_size > 0);
+
+    LoadPlyPolygonsResult result = {};
+    result.header = parse_ply_header(file, file_size);
+    result.vertices = push_parser_array(arena, f32, (size_t)result.header.vertex_count*result.header.vertex_property_count);
+    result.polygons.face_count = result.header.face_count;
+    result.polygons.index_count = result.header.polygon_index_count;
+    result.polygons.offsets = push_parser_array(arena, u32, result.polygons.face_count + 1);
+    result.polygons.indices = push_parser_array(arena, u32, result.polygons.index_count);
+
+    parse_ply(file, file_size, result.header, result.vertices, 0, pool, 0, 0, &result.polygons, stats, normalize_normals);
+
+    return result;
+}
+
+// NOTE(joon) same as load_ply, but each vertex row is converted into the layout right after it was decoded
+// (64 rows at a time, while they are still in L1), so the f32 rows never exist as a whole 
+// and there is no re-packing pass after the load.
+internal LoadPlyLayoutResult
+load_ply_with_layout(ParserArena *arena, u8 *file, size_t file_size, ParserVertexLayout *layout, ParserThreadPool *pool = 0)
+{
+    assert(file && file_size > 0);
+
+    LoadPlyLayoutResult result = {};
+    result.header = parse_ply_header(file, file_size);
+    result.vertices = allocate_parser_vertex_buffers(arena, layout, result.header.vertex_property_count, result.header.vertex_count);
+    result.indices = push_parser_array(arena, u32, result.header.index_count);
+
+    parse_ply(file, file_size, result.header, 0, result.indices, pool, layout, &result.vertices);
+
+    return result;
+}
+
+// NOTE(joon) maps the whole file as read only, and tells the os that we are going to 
+// read it from start to end, so that it can start reading ahead right away. 
+// If use_huge_pages is true, also asks for the transparent huge pages, 
+// which only works if the kernel supports them for the page cache(otherwise it's ignored).
+// Returns a zeroed struct if the file couldn't be mapped.
+internal ParserMappedFile
+map_parser_file(char *path, b32 use_huge_pages = false)
+{
+    ParserMappedFile result = {};
+
+    int file_descriptor = open(path, O_RDONLY);
+    if(file_descriptor >= 0)
+    {
+        struct stat file_stat;
+        if(fstat(file_descriptor, &file_stat) == 0 && file_stat.st_size > 0)
+        {
+            size_t size = (size_t)file_stat.st_size;
+            void *memory = mmap(0, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+            if(memory != MAP_FAILED)
+            {
+                posix_madvise(memory, size, POSIX_MADV_SEQUENTIAL);
+                posix_madvise(memory, size, POSIX_MADV_WILLNEED);
+#if defined(MADV_HUGEPAGE)
+                if(use_huge_pages)
+                {
+                    madvise(memory, size, MADV_HUGEPAGE);
+                }
+#endif
+
+                result.memory = (u8 *)memory;
+                result.size = size;
+            }
+        }
+
+        // NOTE(joon) the mapping stays valid after closing the file
+        close(file_descriptor);
+    }
+
+    return result;
+}
+
+internal void
+unmap_parser_file(ParserMappedFile *file)
+{
+    if(file->memory)
+    {
+        munmap(file->memory, file->size);
+    }
+
+    *file = {};
+}
+
+// NOTE(joon) path versions of the loaders. The tokenizer runs directly on the mapped file, 
+// so the file is never copied into the heap. The results live inside the arena, 
+// so the file is unmapped before returning. 
+// Returns a zeroed result if the file couldn't be mapped.
+internal LoadObjResult
+load_obj(ParserArena *arena, char *path, ParserThreadPool *pool = 0, b32 use_huge_pages = false)
+{
+    LoadObjResult result = {};
+
+    ParserMappedFile file = map_parser_file(path, use_huge_pages);
+    if(file.memory)
+    {
+        result = load_obj(arena, file.memory, file.size, pool);
+        unmap_parser_file(&file);
+    }
+
+    return result;
+}
+
+internal LoadPlyResult
+load_ply(ParserArena *arena, char *path, ParserThreadPool *pool = 0, b32 use_huge_pages = false)
+{
+    LoadPlyResult result = {};
+
+    ParserMappedFile file = map_parser_file(path, use_huge_pages);
+    if(file.memory)
+    {
+        result = load_ply(arena, file.memory, file.size, pool);
+        unmap_parser_file(&file);
+    }
+
+    return result;
+}
+
+inline void
+init_parser_bvh_bounds(f32 *min, f32 *max)
+{
+    min[0] = min[1] = min[2] = FLT_MAX;
+    max[0] = max[1] = max[2] = -FLT_MAX;
+}
+
+inline void
+grow_parser_bvh_bounds(f32 *min, f32 *max, f32 *other_min, f32 *other_max)
+{
+    for(u32 axis = 0;
+            axis < 3;
+            ++axis)
+    {
+        min[axis] = (other_min[axis] < min[axis]) ? other_min[axis] : min[axis];
+        max[axis] = (other_max[axis] > max[axis]) ? other_max[axis] : max[axis];
+    }
+}
+
+// NOTE(joon) half of the surface area, SAH only cares about the ratios. Empty bounds have no area.
+inline f32
+get_parser_bvh_half_area(f32 *min, f32 *max)
+{
+    f32 result = 0.0f;
+    if(min[0] <= max[0])
+    {
+        f32 dx = max[0] - min[0];
+        f32 dy = max[1] - min[1];
+        f32 dz = max[2] - min[2];
+        result = dx*dy + dy*dz + dz*dx;
+    }
+
+    return result;
+}
+
+inline void
+get_parser_bvh_centroid(ParserBvhReference *reference, f32 *centroid)
+{
+    centroid[0] = 0.5f*(reference->min[0] + reference->max[0]);
+    centroid[1] = 0.5f*(reference->min[1] + reference->max[1]);
+    centroid[2] = 0.5f*(reference->min[2] + reference->max[2]);
+}
+
+// NOTE(joon) 0 if every centroid is at the same place on that axis, the axis can't be split then
+internal void
+get_parser_bvh_bin_scales(ParserBvhBuildTask *task, f32 *scales)
+{
+    for(u32 axis = 0;
+            axis < 3;
+            ++axis)
+    {
+        f32 extent = task->centroid_max[axis] - task->centroid_min[axis];
+        scales[axis] = (extent > 0.0f) ? (task->bin_count*(1.0f - 1e-5f))/extent : 0.0f;
+    }
+}
+
+inline u32
+get_parser_bvh_bin_index(ParserBvhReference *reference, ParserBvhBuildTask *task, f32 *scales, u32 axis)
+{
+    f32 centroid = 0.5f*(reference->min[axis] + reference->max[axis]);
+    i32 result = (i32)((centroid - task->centroid_min[axis])*scales[axis]);
+    result = (result < 0) ? 0 : result;
+    result = (result >= (i32)task->bin_count) ? ((i32)task->bin_count - 1) : result;
+
+    return (u32)result;
+}
+
+inline void
+init_parser_bvh_bin(ParserBvhBin *bin)
+{
+    init_parser_bvh_bounds(bin->min, bin->max);
+    bin->min[3] = bin->max[3] = 0.0f;
+}
+
+inline void
+grow_parser_bvh_bin(ParserBvhBin *bin, ParserBvhBin *other)
+{
+#if PARSER_X64
+    _mm_storeu_ps(bin->min, _mm_min_ps(_mm_loadu_ps(bin->min), _mm_loadu_ps(other->min)));
+    _mm_storeu_ps(bin->max, _mm_max_ps(_mm_loadu_ps(bin->max), _mm_loadu_ps(other->max)));
+#else
+    grow_parser_bvh_bounds(bin->min, bin->max, other->min, other->max);
+#endif
+}
+
+internal void
+init_parser_bvh_bins(ParserBvhBins *bins, u32 bin_count)
+{
+    for(u32 axis = 0;
+            axis < 3;
+            ++axis)
+    {
+        for(u32 bin_index = 0;
+                bin_index < bin_count;
+                ++bin_index)
+        {
+            init_parser_bvh_bin(&bins->bins[axis][bin_index]);
+            bins->counts[axis][bin_index] = 0;
+        }
+    }
+}
+
+#if PARSER_X64
+// NOTE(joon) same bin indices as get_parser_bvh_bin_index(the clamp before the truncation gives the same result), 
+// but the centroid and the indices of all 3 axes are done at once. The axes that can't be split go to the bin 0, 
+// find_parser_bvh_split doesn't look at them anyway.
+internal void
+bin_parser_bvh_references_sse2(ParserBvhReference *references, u32 count, ParserBvhBuildTask *task, f32 *scales, ParserBvhBins *bins)
+{
+    __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)); // primitive_index is in the 4th lane of min
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 zero = _mm_setzero_ps();
+    __m128 last_bin = _mm_set1_ps((f32)(task->bin_count - 1));
+    __m128 centroid_min = _mm_setr_ps(task->centroid_min[0], task->centroid_min[1], task->centroid_min[2], 0.0f);
+    __m128 scale = _mm_setr_ps(scales[0], scales[1], scales[2], 0.0f);
+
+    for(u32 reference_index = 0;
+            reference_index < count;
+            ++reference_index)
+    {
+        ParserBvhReference *reference = references + reference_index;
+        __m128 min = _mm_and_ps(_mm_loadu_ps(reference->min), xyz_mask);
+        __m128 max = _mm_and_ps(_mm_loadu_ps(reference->max), xyz_mask);
+
+        __m128 centroid = _mm_mul_ps(half, _mm_add_ps(min, max));
+        __m128 bin_position = _mm_mul_ps(_mm_sub_ps(centroid, centroid_min), scale);
+        bin_position = _mm_min_ps(_mm_max_ps(bin_position, zero), last_bin);
+
+        __m128i bin_indices = _mm_cvttps_epi32(bin_position);
+        for(u32 axis = 0;
+                axis < 3;
+                ++axis)
+        {
+            u32 bin_index = (u32)_mm_cvtsi128_si32(bin_indices);
+            bin_indices = _mm_srli_si128(bin_indices, 4);
+
+            ParserBvhBin *bin = &bins->bins[axis][bin_index];
+            _mm_storeu_ps(bin->min, _mm_min_ps(_mm_loadu_ps(bin->min), min));
+            _mm_storeu_ps(bin->max, _mm_max_ps(_mm_loadu_ps(bin->max), max));
+            bins->counts[axis][bin_index]++;
+        }
+    }
+}
+#endif
+
+internal void
+bin_parser_bvh_references(ParserBvhReference *references, u32 count, ParserBvhBuildTask *task, f32 *scales, ParserBvhBins *bins)
+{
+    init_parser_bvh_bins(bins, task->bin_count);
+#if PARSER_X64
+    bin_parser_bvh_references_sse2(references, count, task, scales, bins);
+#else
+    for(u32 reference_index = 0;
+            reference_index < count;
+            ++reference_index)
+    {
+        ParserBvhReference *reference = references + reference_index;
+        for(u32 axis = 0;
+                axis < 3;
+                ++axis)
+        {
+            if(scales[axis] > 0.0f)
+            {
+                u32 bin_index = get_parser_bvh_bin_index(reference, task, scales, axis);
+                ParserBvhBin *bin = &bins->bins[axis][bin_index];
+                grow_parser_bvh_bounds(bin->min, bin->max, reference->min, reference->max);
+                bins->counts[axis][bin_index]++;
+            }
+        }
+    }
+#endif
+}
+
+// NOTE(joon) sweeps the bins from both sides, and picks the plane between the bins that has 
+// the lowest (left area x left count + right area x right count) among every axis. 
+// The bounds of the right side are kept from the first sweep so that the winner doesn't need another pass.
+internal ParserBvhSplit
+find_parser_bvh_split(ParserBvhBins *bins, f32 *scales, u32 bin_count)
+{
+    ParserBvhSplit result = {};
+    result.cost = FLT_MAX;
+
+    ParserBvhBin best_left;
+    ParserBvhBin best_right;
+    for(u32 axis = 0;
+            axis < 3;
+            ++axis)
+    {
+        if(scales[axis] > 0.0f)
+        {
+            ParserBvhBin *axis_bins = bins->bins[axis];
+
+            ParserBvhBin rights[parser_bvh_bin_count];
+            f32 right_costs[parser_bvh_bin_count];
+            u32 right_counts[parser_bvh_bin_count];
+            ParserBvhBin right;
+            init_parser_bvh_bin(&right);
+            u32 right_count = 0;
+            for(u32 bin_index = bin_count - 1;
+                    bin_index > 0;
+                    --bin_index)
+            {
+                grow_parser_bvh_bin(&right, axis_bins + bin_index);
+                right_count += bins->counts[axis][bin_index];
+
+                rights[bin_index] = right;
+                right_costs[bin_index] = get_parser_bvh_half_area(right.min, right.max)*right_count;
+                right_counts[bin_index] = right_count;
+            }
+
+            ParserBvhBin left;
+            init_parser_bvh_bin(&left);
+            u32 left_count = 0;
+            for(u32 bin_index = 0;
+                    bin_index < bin_count - 1;
+                    ++bin_index)
+            {
+                grow_parser_bvh_bin(&left, axis_bins + bin_index);
+                left_count += bins->counts[axis][bin_index];
+
+                if(left_count && right_counts[bin_index + 1])
+                {
+                    f32 cost = get_parser_bvh_half_area(left.min, left.max)*left_count + right_costs[bin_index + 1];
+                    if(cost < result.cost)
+                    {
+                        result.is_valid = true;
+                        result.axis = axis;
+                        result.bin = bin_index;
+                        result.cost = cost;
+
+                        best_left = left;
+                        best_right = rights[bin_index + 1];
+                    }
+                }
+            }
+        }
+    }
+
+    if(result.is_valid)
+    {
+        memcpy(result.left_min, best_left.min, sizeof(result.left_min));
+        memcpy(result.left_max, best_left.max, sizeof(result.left_max));
+        memcpy(result.right_min, best_right.min, sizeof(result.right_min));
+        memcpy(result.right_max, best_right.max, sizeof(result.right_max));
+    }
+
+    return result;
+}
+
+// NOTE(joon) the references that go to the left are moved to the front, returns how many of them are there
+internal u32
+partition_parser_bvh_references(ParserBvhReference *references, u32 count, ParserBvhBuildTask *task, f32 *scales, ParserBvhSplit *split, 
+                                f32 *left_centroid_min, f32 *left_centroid_max, f32 *right_centroid_min, f32 *right_centroid_max)
+{
+    init_parser_bvh_bounds(left_centroid_min, left_centroid_max);
+    init_parser_bvh_bounds(right_centroid_min, right_centroid_max);
+
+    u32 left = 0;
+    u32 right = count;
+    while(left < right)
+    {
+        f32 centroid[3];
+        get_parser_bvh_centroid(references + left, centroid);
+        if(get_parser_bvh_bin_index(references + left, task, scales, split->axis) <= split->bin)
+        {
+            grow_parser_bvh_bounds(left_centroid_min, left_centroid_max, centroid, centroid);
+            left++;
+        }
+        else
+        {
+            grow_parser_bvh_bounds(right_centroid_min, right_centroid_max, centroid, centroid);
+            right--;
+
+            ParserBvhReference temp = references[left];
+            references[left] = references[right];
+            references[right] = temp;
+        }
+    }
+
+    return left;
+}
+
+internal void
+bin_parser_bvh_work(void *data)
+{
+    ParserBvhWork *work = (ParserBvhWork *)data;
+
+    bin_parser_bvh_references(work->builder->references + work->first, work->count, work->task, work->bin_scales, &work->bins);
+}
+
+internal void
+count_parser_bvh_left_work(void *data)
+{
+    ParserBvhWork *work = (ParserBvhWork *)data;
+
+    init_parser_bvh_bounds(work->left_centroid_min, work->left_centroid_max);
+    init_parser_bvh_bounds(work->right_centroid_min, work->right_centroid_max);
+    work->left_count = 0;
+
+    ParserBvhReference *references = work->builder->references + work->first;
+    for(u32 reference_index = 0;
+            reference_index < work->count;
+            ++reference_index)
+    {
+        f32 centroid[3];
+        get_parser_bvh_centroid(references + reference_index, centroid);
+        if(get_parser_bvh_bin_index(references + reference_index, work->task, work->bin_scales, work->split->axis) <= work->split->bin)
+        {
+            grow_parser_bvh_bounds(work->left_centroid_min, work->left_centroid_max, centroid, centroid);
+            work->left_count++;
+        }
+        else
+        {
+            grow_parser_bvh_bounds(work->right_centroid_min, work->right_centroid_max, centroid, centroid);
+        }
+    }
+}
+
+// NOTE(joon) every work knows where its left and right references go from the prefix sum of the left counts, 
+// so the scatter doesn't need any lock. Order inside each side stays the same.
+internal void
+scatter_parser_bvh_work(void *data)
+{
+    ParserBvhWork *work = (ParserBvhWork *)data;
+
+    ParserBvhReference *references = work->builder->references + work->first;
+    ParserBvhReference *left = work->builder->scratch_references + work->left_offset;
+    ParserBvhReference *right = work->builder->scratch_references + work->right_offset;
+    for(u32 reference_index = 0;
+            reference_index < work->count;
+            ++reference_index)
+    {
+        if(get_parser_bvh_bin_index(references + reference_index, work->task, work->bin_scales, work->split->axis) <= work->split->bin)
+        {
+            *left++ = references[reference_index];
+        }
+        else
+        {
+            *right++ = references[reference_index];
+        }
+    }
+}
+
+internal void
+copy_back_parser_bvh_work(void *data)
+{
+    ParserBvhWork *work = (ParserBvhWork *)data;
+
+    memcpy(work->builder->references + work->first, work->builder->scratch_references + work->first, 
+           sizeof(ParserBvhReference)*work->count);
+}
+
+// NOTE(joon) if the node should be split, makes the two children and returns true. 
+// If the pool is given, the binning and the partition of the references are done in parallel(used for the top of the tree, 
+// where there are not enough nodes for every thread yet).
+internal b32
+split_parser_bvh_node(ParserBvhBuilder *builder, ParserBvhBuildTask *task, ParserBvhBuildTask *children, 
+                      ParserArena *scratch_arena, ParserThreadPool *pool)
+{
+    ParserBvhBuildNode *node = builder->nodes + task->node_index;
+    ParserBvhReference *references = builder->references + task->first;
+    if(task->count <= 1)
+    {
+        return false;
+    }
+
+    // NOTE(joon) near the leaves there are a lot of nodes with a few references each, 
+    // where sweeping all the bins costs more than binning the references
+    task->bin_count = (task->count < parser_bvh_bin_count) ? task->count : parser_bvh_bin_count;
+
+    f32 scales[3];
+    get_parser_bvh_bin_scales(task, scales);
+
+    u32 work_count = get_parser_chunk_count(pool, (size_t)task->count*sizeof(ParserBvhReference), 256*1024);
+    ParserBvhWork *works = 0;
+    ParserBvhBins bins;
+    if(work_count > 1)
+    {
+        works = push_parser_array(scratch_arena, ParserBvhWork, work_count);
+        u32 first = 0;
+        for(u32 work_index = 0;
+                work_index < work_count;
+                ++work_index)
+        {
+            u32 next_first = (u32)(((u64)task->count*(work_index + 1))/work_count);
+
+            ParserBvhWork *work = works + work_index;
+            work->builder = builder;
+            work->first = task->first + first;
+            work->count = next_first - first;
+            work->task = task;
+            work->bin_scales = scales;
+
+            add_parser_work(pool, bin_parser_bvh_work, work);
+
+            first = next_first;
+        }
+        complete_all_parser_work(pool);
+
+        bins = works[0].bins;
+        for(u32 work_index = 1;
+                work_index < work_count;
+                ++work_index)
+        {
+            for(u32 axis = 0;
+                    axis < 3;
+                    ++axis)
+            {
+                for(u32 bin_index = 0;
+                        bin_index < task->bin_count;
+                        ++bin_index)
+                {
+                    grow_parser_bvh_bin(&bins.bins[axis][bin_index], &works[work_index].bins.bins[axis][bin_index]);
+                    bins.counts[axis][bin_index] += works[work_index].bins.counts[axis][bin_index];
+                }
+            }
+        }
+    }
+    else
+    {
+        bin_parser_bvh_references(references, task->count, task, scales, &bins);
+    }
+
+    ParserBvhSplit split = find_parser_bvh_split(&bins, scales, task->bin_count);
+
+    // NOTE(joon) traversal cost 1 and intersection cost 1, both relative to the area of the node
+    f32 node_area = get_parser_bvh_half_area(node->min, node->max);
+    if(task->count <= parser_bvh_max_leaf_size && 
+       (!split.is_valid || task->count*node_area <= node_area + split.cost))
+    {
+        return false;
+    }
+
+    u32 left_count;
+    f32 left_centroid_min[3], left_centroid_max[3], right_centroid_min[3], right_centroid_max[3];
+    if(!split.is_valid)
+    {
+        // NOTE(joon) every centroid is at the same point, so any split is as good as the others
+        left_count = task->count/2;
+        init_parser_bvh_bounds(split.left_min, split.left_max);
+        init_parser_bvh_bounds(split.right_min, split.right_max);
+        for(u32 reference_index = 0;
+                reference_index < task->count;
+                ++reference_index)
+        {
+            ParserBvhReference *reference = references + reference_index;
+            if(reference_index < left_count)
+            {
+                grow_parser_bvh_bounds(split.left_min, split.left_max, reference->min, reference->max);
+            }
+            else
+            {
+                grow_parser_bvh_bounds(split.right_min, split.right_max, reference->min, reference->max);
+            }
+        }
+
+        memcpy(left_centroid_min, task->centroid_min, sizeof(left_centroid_min));
+        memcpy(left_centroid_max, task->centroid_max, sizeof(left_centroid_max));
+        memcpy(right_centroid_min, task->centroid_min, sizeof(right_centroid_min));
+        memcpy(right_centroid_max, task->centroid_max, sizeof(right_centroid_max));
+    }
+    else if(work_count > 1)
+    {
+        for(u32 work_index = 0;
+                work_index < work_count;
+                ++work_index)
+        {
+            works[work_index].split = &split;
+            add_parser_work(pool, count_parser_bvh_left_work, works + work_index);
+        }
+        complete_all_parser_work(pool);
+
+        left_count = 0;
+        for(u32 work_index = 0;
+                work_index < work_count;
+                ++work_index)
+        {
+            left_count += works[work_index].left_count;
+        }
+
+        init_parser_bvh_bounds(left_centroid_min, left_centroid_max);
+        init_parser_bvh_bounds(right_centroid_min, right_centroid_max);
+        u32 left_offset = task->first;
+        u32 right_offset = task->first + left_count;
+        for(u32 work_index = 0;
+                work_index < work_count;
+                ++work_index)
+        {
+            ParserBvhWork *work = works + work_index;
+            work->left_offset = left_offset;
+            work->right_offset = right_offset;
+            left_offset += work->left_count;
+            right_offset += work->count - work->left_count;
+
+            grow_parser_bvh_bounds(left_centroid_min, left_centroid_max, work->left_centroid_min, work->left_centroid_max);
+            grow_parser_bvh_bounds(right_centroid_min, right_centroid_max, work->right_centroid_min, work->right_centroid_max);
+
+            add_parser_work(pool, scatter_parser_bvh_work, work);
+        }
+        complete_all_parser_work(pool);
+
+        for(u32 work_index = 0;
+                work_index < work_count;
+                ++work_index)
+        {
+            add_parser_work(pool, copy_back_parser_bvh_work, works + work_index);
+        }
+        complete_all_parser_work(pool);
+    }
+    else
+    {
+        left_count = partition_parser_bvh_references(references, task->count, task, scales, &split, 
+                                                     left_centroid_min, left_centroid_max, right_centroid_min, right_centroid_max);
+    }
+    assert(left_count > 0 && left_count < task->count);
+
+    u32 left_index = __atomic_fetch_add(&builder->node_count, 2, __ATOMIC_RELAXED);
+    ParserBvhBuildNode *left = builder->nodes + left_index;
+    ParserBvhBuildNode *right = left + 1;
+    memcpy(left->min, split.left_min, sizeof(left->min));
+    memcpy(left->max, split.left_max, sizeof(left->max));
+    memcpy(right->min, split.right_min, sizeof(right->min));
+    memcpy(right->max, split.right_max, sizeof(right->max));
+    node->first = left_index;
+    node->count = 0;
+
+    children[0].node_index = left_index;
+    children[0].first = task->first;
+    children[0].count = left_count;
+    memcpy(children[0].centroid_min, left_centroid_min, sizeof(left_centroid_min));
+    memcpy(children[0].centroid_max, left_centroid_max, sizeof(left_centroid_max));
+
+    children[1].node_index = left_index + 1;
+    children[1].first = task->first + left_count;
+    children[1].count = task->count - left_count;
+    memcpy(children[1].centroid_min, right_centroid_min, sizeof(right_centroid_min));
+    memcpy(children[1].centroid_max, right_centroid_max, sizeof(right_centroid_max));
+
+    return true;
+}
+
+// NOTE(joon) one subtree by one thread, depth first
+internal void
+build_parser_bvh_subtree_work(void *data)
+{
+    ParserBvhWork *work = (ParserBvhWork *)data;
+    ParserBvhBuilder *builder = work->builder;
+
+    ParserBvhBuildTask stack[parser_bvh_max_stack_depth];
+    u32 stack_count = 0;
+    stack[stack_count++] = work->subtree_task;
+    while(stack_count)
+    {
+        ParserBvhBuildTask task = stack[--stack_count];
+
+        ParserBvhBuildTask children[2];
+        if(stack_count + 2 <= parser_bvh_max_stack_depth && 
+           split_parser_bvh_node(builder, &task, children, 0, 0))
+        {
+            stack[stack_count++] = children[1];
+            stack[stack_count++] = children[0];
+        }
+        else
+        {
+            ParserBvhBuildNode *node = builder->nodes + task.node_index;
+            node->first = task.first;
+            node->count = task.count;
+        }
+    }
+}
+
+internal void
+make_parser_bvh_references_work(void *data)
+{
+    ParserBvhWork *work = (ParserBvhWork *)data;
+
+    init_parser_bvh_bounds(work->min, work->max);
+    init_parser_bvh_bounds(work->centroid_min, work->centroid_max);
+    for(u32 primitive_index = work->first;
+            primitive_index < work->first + work->count;
+            ++primitive_index)
+    {
+        ParserBvhReference *reference = work->builder->references + primitive_index;
+        init_parser_bvh_bounds(reference->min, reference->max);
+        reference->primitive_index = primitive_index;
+        reference->padding = 0;
+
+        for(u32 corner_index = 0;
+                corner_index < 3;
+                ++corner_index)
+        {
+            u32 vertex_index = work->indices[3*primitive_index + corner_index] - work->index_base;
+            assert(vertex_index < work->vertex_count);
+
+            f32 *position = work->positions + (size_t)vertex_index*work->position_stride;
+            grow_parser_bvh_bounds(reference->min, reference->max, position, position);
+        }
+
+        f32 centroid[3];
+        get_parser_bvh_centroid(reference, centroid);
+        grow_parser_bvh_bounds(work->min, work->max, reference->min, reference->max);
+        grow_parser_bvh_bounds(work->centroid_min, work->centroid_max, centroid, centroid);
+    }
+}
+
+// NOTE(joon) turns the binary tree into the wide nodes. Each wide node starts with the two children of 
+// a binary node, and keeps opening the internal child with the biggest area until it has width children.
+template<typename Node, u32 width>
+internal u32
+collapse_parser_bvh(ParserBvhBuilder *builder, Node *wide_nodes, u32 wide_node_capacity, ParserArena *scratch_arena)
+{
+    ParserBvhBuildNode *binary_nodes = builder->nodes;
+
+    // NOTE(joon) (binary node, wide node) pairs that are still to be filled, 
+    // every pair is a different wide node so the capacity is enough
+    u32 *pending_binary = push_parser_array(scratch_arena, u32, wide_node_capacity);
+    u32 *pending_wide = push_parser_array(scratch_arena, u32, wide_node_capacity);
+    u32 pending_count = 0;
+
+    u32 wide_node_count = 1;
+    pending_binary[pending_count] = 0;
+    pending_wide[pending_count++] = 0;
+    while(pending_count)
+    {
+        pending_count--;
+        ParserBvhBuildNode *binary = binary_nodes + pending_binary[pending_count];
+        Node *wide = wide_nodes + pending_wide[pending_count];
+
+        u32 child_indices[width];
+        u32 child_count = 0;
+        if(builder->node_count == 1)
+        {
+            // NOTE(joon) the root is the only leaf, or there are no triangles at all
+            if(binary->count)
+            {
+                child_indices[child_count++] = 0;
+            }
+        }
+        else
+        {
+            child_indices[child_count++] = binary->first;
+            child_indices[child_count++] = binary->first + 1;
+            while(child_count < width)
+            {
+                i32 open_index = -1;
+                f32 open_area = -1.0f;
+                for(u32 child_index = 0;
+                        child_index < child_count;
+                        ++child_index)
+                {
+                    ParserBvhBuildNode *child = binary_nodes + child_indices[child_index];
+                    f32 area = get_parser_bvh_half_area(child->min, child->max);
+                    if(!child->count && area > open_area)
+                    {
+                        open_index = (i32)child_index;
+                        open_area = area;
+                    }
+                }
+
+                if(open_index < 0)
+                {
+                    break;
+                }
+
+                u32 opened_first = binary_nodes[child_indices[open_index]].first;
+                child_indices[open_index] = opened_first;
+                child_indices[child_count++] = opened_first + 1;
+            }
+        }
+
+        for(u32 slot_index = 0;
+                slot_index < width;
+                ++slot_index)
+        {
+            if(slot_index < child_count)
+            {
+                ParserBvhBuildNode *child = binary_nodes + child_indices[slot_index];
+                wide->min_x[slot_index] = child->min[0];
+                wide->min_y[slot_index] = child->min[1];
+                wide->min_z[slot_index] = child->min[2];
+                wide->max_x[slot_index] = child->max[0];
+                wide->max_y[slot_index] = child->max[1];
+                wide->max_z[slot_index] = child->max[2];
+
+                if(child->count)
+                {
+                    wide->children[slot_index] = child->first;
+                    wide->primitive_counts[slot_index] = child->count;
                 }
                 else
                 {
-                    invalid_code_path;
+                    assert(wide_node_count < wide_node_capacity && pending_count < wide_node_capacity);
+                    wide->children[slot_index] = wide_node_count;
+                    wide->primitive_counts[slot_index] = 0;
+
+                    pending_binary[pending_count] = child_indices[slot_index];
+                    pending_wide[pending_count++] = wide_node_count++;
+                }
+            }
+            else
+            {
+                wide->min_x[slot_index] = wide->min_y[slot_index] = wide->min_z[slot_index] = FLT_MAX;
+                wide->max_x[slot_index] = wide->max_y[slot_index] = wide->max_z[slot_index] = -FLT_MAX;
+                wide->children[slot_index] = parser_bvh_empty_child;
+                wide->primitive_counts[slot_index] = 0;
+            }
+        }
+    }
+
+    return wide_node_count;
+}
+
+// NOTE(joon) SAH binned bvh over the triangles, width should be 4 or 8. 
+// positions are position_stride floats apart(3 for obj, vertex_property_count for ply) and 
+// the indices start from index_base(1 for obj, 0 for ply). 
+// If the pool is given, the references are made in parallel, and the top of the tree is split one node at a time 
+// with the binning and the partition spread over the pool, until there are enough subtrees for every thread. 
+// Then each subtree is built by one thread, because the pool can't wait from inside the work.
+// Only the wide nodes and the primitive indices stay inside the arena.
+internal ParserBvh
+build_parser_bvh(ParserArena *arena, f32 *positions, u32 position_stride, u32 vertex_count, 
+                 u32 *indices, u32 triangle_count, u32 index_base, u32 width = 4, ParserThreadPool *pool = 0)
+{
+    assert(width == 4 || width == 8);
+
+    ParserBvh result = {};
+    result.width = width;
+    result.primitive_count = triangle_count;
+
+    ParserArena scratch_arena = begin_parser_sub_arena(arena);
+
+    ParserBvhBuilder builder = {};
+    builder.references = push_parser_array(&scratch_arena, ParserBvhReference, triangle_count);
+    if(pool)
+    {
+        // NOTE(joon) only the parallel partition needs it
+        builder.scratch_references = push_parser_array(&scratch_arena, ParserBvhReference, triangle_count);
+    }
+    builder.nodes = push_parser_array(&scratch_arena, ParserBvhBuildNode, triangle_count ? 2*triangle_count - 1 : 1);
+    builder.node_count = 1;
+
+    u32 reference_work_count = get_parser_chunk_count(pool, (size_t)triangle_count*sizeof(ParserBvhReference), 256*1024);
+    ParserBvhWork *reference_works = push_parser_array(&scratch_arena, ParserBvhWork, reference_work_count);
+    u32 first = 0;
+    for(u32 work_index = 0;
+            work_index < reference_work_count;
+            ++work_index)
+    {
+        u32 next_first = (u32)(((u64)triangle_count*(work_index + 1))/reference_work_count);
+
+        ParserBvhWork *work = reference_works + work_index;
+        *work = {};
+        work->builder = &builder;
+        work->first = first;
+        work->count = next_first - first;
+        work->positions = positions;
+        work->position_stride = position_stride;
+        work->vertex_count = vertex_count;
+        work->indices = indices;
+        work->index_base = index_base;
+
+        add_parser_work(pool, make_parser_bvh_references_work, work);
+
+        first = next_first;
+    }
+    complete_all_parser_work(pool);
+
+    ParserBvhBuildNode *root = builder.nodes;
+    ParserBvhBuildTask root_task = {};
+    root_task.count = triangle_count;
+    init_parser_bvh_bounds(root->min, root->max);
+    init_parser_bvh_bounds(root_task.centroid_min, root_task.centroid_max);
+    for(u32 work_index = 0;
+            work_index < reference_work_count;
+            ++work_index)
+    {
+        ParserBvhWork *work = reference_works + work_index;
+        grow_parser_bvh_bounds(root->min, root->max, work->min, work->max);
+        grow_parser_bvh_bounds(root_task.centroid_min, root_task.centroid_max, work->centroid_min, work->centroid_max);
+    }
+    root->first = 0;
+    root->count = triangle_count;
+
+    if(triangle_count)
+    {
+        result.min.x = root->min[0];
+        result.min.y = root->min[1];
+        result.min.z = root->min[2];
+        result.max.x = root->max[0];
+        result.max.y = root->max[1];
+        result.max.z = root->max[2];
+
+        // NOTE(joon) split the biggest task until every thread has a few subtrees, 
+        // small tasks are not worth the parallel passes
+        u32 task_capacity = get_parser_chunk_count(pool, (size_t)triangle_count, 4096);
+        ParserBvhBuildTask *tasks = push_parser_array(&scratch_arena, ParserBvhBuildTask, task_capacity);
+        u32 task_count = 0;
+        tasks[task_count++] = root_task;
+        while(task_count < task_capacity)
+        {
+            u32 biggest_task_index = 0;
+            for(u32 task_index = 1;
+                    task_index < task_count;
+                    ++task_index)
+            {
+                if(tasks[task_index].count > tasks[biggest_task_index].count)
+                {
+                    biggest_task_index = task_index;
+                }
+            }
+
+            ParserBvhBuildTask children[2];
+            if(tasks[biggest_task_index].count < 4096 || 
+               !split_parser_bvh_node(&builder, tasks + biggest_task_index, children, &scratch_arena, pool))
+            {
+                break;
+            }
+
+            tasks[biggest_task_index] = children[0];
+            tasks[task_count++] = children[1];
+        }
+
+        ParserBvhWork *subtree_works = push_parser_array(&scratch_arena, ParserBvhWork, task_count);
+        for(u32 task_index = 0;
+                task_index < task_count;
+                ++task_index)
+        {
+            ParserBvhWork *work = subtree_works + task_index;
+            *work = {};
+            work->builder = &builder;
+            work->subtree_task = tasks[task_index];
+
+            add_parser_work(pool, build_parser_bvh_subtree_work, work);
+        }
+        complete_all_parser_work(pool);
+    }
+
+    result.primitive_indices = push_parser_array(arena, u32, triangle_count);
+    for(u32 reference_index = 0;
+            reference_index < triangle_count;
+            ++reference_index)
+    {
+        result.primitive_indices[reference_index] = builder.references[reference_index].primitive_index;
+    }
+
+    // NOTE(joon) a full binary tree has (node_count - 1)/2 internal nodes, and every wide node replaces at least one
+    u32 wide_node_capacity = (builder.node_count - 1)/2;
+    wide_node_capacity = (wide_node_capacity < 1) ? 1 : wide_node_capacity;
+    if(width == 4)
+    {
+        ParserBvh4Node *nodes = push_parser_array(&scratch_arena, ParserBvh4Node, wide_node_capacity);
+        result.node_count = collapse_parser_bvh<ParserBvh4Node, 4>(&builder, nodes, wide_node_capacity, &scratch_arena);
+        result.nodes4 = (ParserBvh4Node *)push_parser_size(arena, sizeof(ParserBvh4Node)*result.node_count, 64);
+        memcpy(result.nodes4, nodes, sizeof(ParserBvh4Node)*result.node_count);
+    }
+    else
+    {
+        ParserBvh8Node *nodes = push_parser_array(&scratch_arena, ParserBvh8Node, wide_node_capacity);
+        result.node_count = collapse_parser_bvh<ParserBvh8Node, 8>(&builder, nodes, wide_node_capacity, &scratch_arena);
+        result.nodes8 = (ParserBvh8Node *)push_parser_size(arena, sizeof(ParserBvh8Node)*result.node_count, 64);
+        memcpy(result.nodes8, nodes, sizeof(ParserBvh8Node)*result.node_count);
+    }
+
+    free_parser_arena(&scratch_arena);
+
+    return result;
+}
+
+internal ParserBvh
+build_obj_bvh(ParserArena *arena, LoadObjResult *mesh, u32 width = 4, ParserThreadPool *pool = 0)
+{
+    ParserBvh result = build_parser_bvh(arena, (f32 *)mesh->positions, 3, mesh->counts.position_count, 
+                                        mesh->indices, mesh->counts.index_count/3, 1, width, pool);
+    return result;
+}
+
+// NOTE(joon) x y z should be next to each other inside the vertex row
+internal ParserBvh
+build_ply_bvh(ParserArena *arena, LoadPlyResult *mesh, u32 width = 4, ParserThreadPool *pool = 0)
+{
+    PlyVertexStatsInfo info = get_ply_vertex_stats_info(&mesh->header, true, false);
+    assert(info.has_positions && 
+           info.positions[1] == info.positions[0] + 1 && 
+           info.positions[2] == info.positions[0] + 2);
+
+    ParserBvh result = build_parser_bvh(arena, mesh->vertices + info.positions[0], mesh->header.vertex_property_count, mesh->header.vertex_count, 
+                                        mesh->indices, mesh->header.index_count/3, 0, width, pool);
+    return result;
+}
+
+// NOTE(joon) content hash of the source file, only used when the mtime doesn't match anymore
+// but the size does(i.e the file was touched or copied), so it needs to be fast more than anything.
+// Four independent lanes so that the multiplies don't wait for each other.
+internal u64
+hash_parser_memory(u8 *memory, size_t size)
+{
+    u64 lanes[4] = {0x9e3779b97f4a7c15ull ^ size, 0xc2b2ae3d27d4eb4full, 0x165667b19e3779f9ull, 0x27d4eb2f165667c5ull};
+
+    u8 *at = memory;
+    u8 *one_past_end = memory + size;
+    while(at + 32 <= one_past_end)
+    {
+        for(u32 lane_index = 0;
+                lane_index < 4;
+                ++lane_index)
+        {
+            u64 word;
+            memcpy(&word, at + 8*lane_index, 8);
+            lanes[lane_index] = (lanes[lane_index] ^ word)*0x9e3779b97f4a7c15ull;
+            lanes[lane_index] ^= (lanes[lane_index] >> 32);
+        }
+        at += 32;
+    }
+
+    u64 result = lanes[0] ^ (lanes[1]*0xc2b2ae3d27d4eb4full) ^ (lanes[2]*0x165667b19e3779f9ull) ^ (lanes[3]*0x27d4eb2f165667c5ull);
+    while(at < one_past_end)
+    {
+        result = (result ^ *at++)*0x100000001b3ull;
+    }
+    result ^= (result >> 29);
+
+    return result;
+}
+
+// NOTE(joon) returns the header if the cache file was made from the source file as it is now.
+// Size + mtime match is trusted without reading the source,
+// if only the mtime is different the source is hashed, and if the hash matches 
+// the new mtime is written into the cache file so that the next load doesn't hash again.
+internal ParserMeshCacheHeader *
+get_valid_parser_mesh_cache_header(ParserMappedFile *cache_file, char *cache_path, char *source_path, ParserMeshCacheSourceType source_type)
+{
+    ParserMeshCacheHeader *result = 0;
+
+    struct stat source_stat;
+    if(cache_file->size >= sizeof(ParserMeshCacheHeader) &&
+       stat(source_path, &source_stat) == 0)
+    {
+        ParserMeshCacheHeader *header = (ParserMeshCacheHeader *)cache_file->memory;
+
+        b32 is_valid = (header->magic == parser_mesh_cache_magic &&
+                        header->version == parser_mesh_cache_version &&
+                        header->header_size == sizeof(ParserMeshCacheHeader) &&
+                        header->source_type == (u32)source_type &&
+                        header->array_count <= parser_mesh_cache_max_array_count &&
+                        header->source_size == (u64)source_stat.st_size);
+
+        // NOTE(joon) a truncated cache file(crash while copying...) should not be read past the end
+        for(u32 array_index = 0;
+                is_valid && array_index < header->array_count;
+                ++array_index)
+        {
+            is_valid = (header->array_offsets[array_index] + header->array_sizes[array_index] <= cache_file->size);
+        }
+
+        if(is_valid &&
+           (header->source_mtime_sec != (i64)source_stat.st_mtim.tv_sec ||
+            header->source_mtime_nsec != (i64)source_stat.st_mtim.tv_nsec))
+        {
+            ParserMappedFile source_file = map_parser_file(source_path);
+            is_valid = (source_file.memory &&
+                        hash_parser_memory(source_file.memory, source_file.size) == header->source_hash);
+            unmap_parser_file(&source_file);
+
+            if(is_valid)
+            {
+                // NOTE(joon) the cache is mapped read only, so the mtime goes straight into the file. 
+                // Failing to write is fine, the next load will just hash the source again.
+                assert(offsetof(ParserMeshCacheHeader, source_mtime_nsec) == 
+                       offsetof(ParserMeshCacheHeader, source_mtime_sec) + sizeof(i64));
+                i64 source_mtime[2] = {(i64)source_stat.st_mtim.tv_sec, (i64)source_stat.st_mtim.tv_nsec};
+
+                int cache_file_descriptor = open(cache_path, O_WRONLY);
+                if(cache_file_descriptor >= 0)
+                {
+                    pwrite(cache_file_descriptor, source_mtime, sizeof(source_mtime), 
+                           (off_t)offsetof(ParserMeshCacheHeader, source_mtime_sec));
+                    close(cache_file_descriptor);
+                }
+            }
+        }
+
+        if(is_valid)
+        {
+            result = header;
+        }
+    }
+
+    return result;
+}
+
+// NOTE(joon) writes into a temporary file first and renames it,
+// so that anyone else who maps the cache at the same time never sees a half written one.
+// Failing to write the cache is not an error, the next load will just parse again.
+internal void
+write_parser_mesh_cache(char *cache_path, ParserMeshCacheHeader *header, void **arrays, ParserMappedFile *source_file, struct stat *source_stat)
+{
+    header->magic = parser_mesh_cache_magic;
+    header->version = parser_mesh_cache_version;
+    header->header_size = sizeof(ParserMeshCacheHeader);
+    header->source_size = (u64)source_stat->st_size;
+    header->source_mtime_sec = (i64)source_stat->st_mtim.tv_sec;
+    header->source_mtime_nsec = (i64)source_stat->st_mtim.tv_nsec;
+    header->source_hash = hash_parser_memory(source_file->memory, source_file->size);
+
+    u64 offset = sizeof(ParserMeshCacheHeader);
+    for(u32 array_index = 0;
+            array_index < header->array_count;
+            ++array_index)
+    {
+        offset = (offset + parser_mesh_cache_alignment - 1) & ~((u64)parser_mesh_cache_alignment - 1);
+        header->array_offsets[array_index] = offset;
+        offset += header->array_sizes[array_index];
+    }
+
+    char temp_path[4096];
+    if(snprintf(temp_path, sizeof(temp_path), "%s.%d.tmp", cache_path, (int)getpid()) >= (int)sizeof(temp_path))
+    {
+        return;
+    }
+
+    int file_descriptor = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(file_descriptor >= 0)
+    {
+        // NOTE(joon) the padding between the arrays is left as a hole, which reads as zeros
+        b32 succeeded = (ftruncate(file_descriptor, (off_t)offset) == 0);
+        for(i32 array_index = -1;
+                succeeded && array_index < (i32)header->array_count;
+                ++array_index)
+        {
+            u8 *at = (array_index < 0) ? (u8 *)header : (u8 *)arrays[array_index];
+            u64 size = (array_index < 0) ? sizeof(ParserMeshCacheHeader) : header->array_sizes[array_index];
+            u64 file_offset = (array_index < 0) ? 0 : header->array_offsets[array_index];
+            while(succeeded && size > 0)
+            {
+                ssize_t written = pwrite(file_descriptor, at, size, (off_t)file_offset);
+                if(written > 0)
+                {
+                    at += written;
+                    size -= (u64)written;
+                    file_offset += (u64)written;
+                }
+                else if(!(written < 0 && errno == EINTR))
+                {
+                    succeeded = false;
+                }
+            }
+        }
+        close(file_descriptor);
+
+        if(!(succeeded && rename(temp_path, cache_path) == 0))
+        {
+            unlink(temp_path);
+        }
+    }
+}
+
+// NOTE(joon) the bvh arrays go right after the mesh arrays, starting from first_array_index
+internal void
+get_parser_mesh_cache_bvh(ParserMeshCacheHeader *header, ParserMappedFile *cache_file, u32 first_array_index, ParserBvh *bvh)
+{
+    *bvh = {};
+    bvh->width = header->bvh_width;
+    bvh->node_count = header->bvh_node_count;
+    bvh->primitive_count = header->bvh_primitive_count;
+    bvh->min = header->bvh_min;
+    bvh->max = header->bvh_max;
+
+    u8 *nodes = cache_file->memory + header->array_offsets[first_array_index];
+    if(bvh->width == 4)
+    {
+        bvh->nodes4 = (ParserBvh4Node *)nodes;
+    }
+    else
+    {
+        bvh->nodes8 = (ParserBvh8Node *)nodes;
+    }
+    bvh->primitive_indices = (u32 *)(cache_file->memory + header->array_offsets[first_array_index + 1]);
+}
+
+internal void
+add_parser_mesh_cache_bvh(ParserMeshCacheHeader *header, void **arrays, ParserBvh *bvh)
+{
+    header->bvh_width = bvh->width;
+    header->bvh_node_count = bvh->node_count;
+    header->bvh_primitive_count = bvh->primitive_count;
+    header->bvh_min = bvh->min;
+    header->bvh_max = bvh->max;
+
+    u32 node_size = (bvh->width == 4) ? sizeof(ParserBvh4Node) : sizeof(ParserBvh8Node);
+    header->array_sizes[header->array_count] = (u64)node_size*bvh->node_count;
+    arrays[header->array_count++] = (bvh->width == 4) ? (void *)bvh->nodes4 : (void *)bvh->nodes8;
+    header->array_sizes[header->array_count] = sizeof(u32)*(u64)bvh->primitive_count;
+    arrays[header->array_count++] = bvh->primitive_indices;
+}
+
+// NOTE(joon) same as load_obj(path), but keeps a binary copy of the result at cache_path.
+// If the cache is valid, nothing is parsed : the cache is mapped into cache_file
+// and the result points directly inside it, so the caller should keep cache_file mapped
+// while using the result, and unmap_parser_file it afterwards.
+// Otherwise the file is parsed into the arena, the cache is (re)written and cache_file stays zeroed
+// (unmap_parser_file is fine to call on it as well).
+// If bvh is given, the bvh of bvh_width is stored in the cache together with the mesh(see build_obj_bvh), 
+// and a cache that was made without it or with a different width is rebuilt.
+internal LoadObjResult
+load_obj_cached(ParserArena *arena, char *path, char *cache_path, ParserMappedFile *cache_file, ParserThreadPool *pool = 0, 
+                ParserBvh *bvh = 0, u32 bvh_width = 4)
+{
+    LoadObjResult result = {};
+    *cache_file = map_parser_file(cache_path);
+
+    ParserMeshCacheHeader *header = get_valid_parser_mesh_cache_header(cache_file, cache_path, path, parser_mesh_cache_source_type_obj);
+    if(header && bvh && header->bvh_width != bvh_width)
+    {
+        header = 0;
+    }
+
+    if(header)
+    {
+        result.counts = header->obj_counts;
+        result.positions = (v3 *)(cache_file->memory + header->array_offsets[0]);
+        result.normals = (v3 *)(cache_file->memory + header->array_offsets[1]);
+        result.texcoords = (v2 *)(cache_file->memory + header->array_offsets[2]);
+        result.indices = (u32 *)(cache_file->memory + header->array_offsets[3]);
+        if(bvh)
+        {
+            get_parser_mesh_cache_bvh(header, cache_file, 4, bvh);
+        }
+    }
+    else
+    {
+        unmap_parser_file(cache_file);
+
+        struct stat source_stat;
+        ParserMappedFile source_file = map_parser_file(path);
+        if(source_file.memory && stat(path, &source_stat) == 0)
+        {
+            result = load_obj(arena, source_file.memory, source_file.size, pool);
+
+            ParserMeshCacheHeader new_header = {};
+            new_header.source_type = parser_mesh_cache_source_type_obj;
+            new_header.obj_counts = result.counts;
+            new_header.array_count = 4;
+            new_header.array_sizes[0] = sizeof(v3)*(u64)result.counts.position_count;
+            new_header.array_sizes[1] = sizeof(v3)*(u64)result.counts.normal_count;
+            new_header.array_sizes[2] = sizeof(v2)*(u64)result.counts.texcoord_count;
+            new_header.array_sizes[3] = sizeof(u32)*(u64)result.counts.index_count;
+            void *arrays[parser_mesh_cache_max_array_count] = {result.positions, result.normals, result.texcoords, result.indices};
+            if(bvh)
+            {
+                *bvh = build_obj_bvh(arena, &result, bvh_width, pool);
+                add_parser_mesh_cache_bvh(&new_header, arrays, bvh);
+            }
+
+            write_parser_mesh_cache(cache_path, &new_header, arrays, &source_file, &source_stat);
+        }
+        unmap_parser_file(&source_file);
+    }
+
+    return result;
+}
+
+internal LoadPlyResult
+load_ply_cached(ParserArena *arena, char *path, char *cache_path, ParserMappedFile *cache_file, ParserThreadPool *pool = 0, 
+                ParserBvh *bvh = 0, u32 bvh_width = 4)
+{
+    LoadPlyResult result = {};
+    *cache_file = map_parser_file(cache_path);
+
+    ParserMeshCacheHeader *header = get_valid_parser_mesh_cache_header(cache_file, cache_path, path, parser_mesh_cache_source_type_ply);
+    if(header && bvh && header->bvh_width != bvh_width)
+    {
+        header = 0;
+    }
+
+    if(header)
+    {
+        result.header = header->ply_header;
+        result.vertices = (f32 *)(cache_file->memory + header->array_offsets[0]);
+        result.indices = (u32 *)(cache_file->memory + header->array_offsets[1]);
+        if(bvh)
+        {
+            get_parser_mesh_cache_bvh(header, cache_file, 2, bvh);
+        }
+    }
+    else
+    {
+        unmap_parser_file(cache_file);
+
+        struct stat source_stat;
+        ParserMappedFile source_file = map_parser_file(path);
+        if(source_file.memory && stat(path, &source_stat) == 0)
+        {
+            result = load_ply(arena, source_file.memory, source_file.size, pool);
+
+            ParserMeshCacheHeader new_header = {};
+            new_header.source_type = parser_mesh_cache_source_type_ply;
+            new_header.ply_header = result.header;
+            new_header.array_count = 2;
+            new_header.array_sizes[0] = sizeof(f32)*(u64)result.header.vertex_count*result.header.vertex_property_count;
+            new_header.array_sizes[1] = sizeof(u32)*(u64)result.header.index_count;
+            void *arrays[parser_mesh_cache_max_array_count] = {result.vertices, result.indices};
+            if(bvh)
+            {
+                *bvh = build_ply_bvh(arena, &result, bvh_width, pool);
+                add_parser_mesh_cache_bvh(&new_header, arrays, bvh);
+            }
+
+            write_parser_mesh_cache(cache_path, &new_header, arrays, &source_file, &source_stat);
+        }
+        unmap_parser_file(&source_file);
+    }
+
+    return result;
+}
+
+// NOTE(joon) a line start becomes a cut if the hash of its line is small enough. 
+// The chance is proportional to the length of the line, so the chunks are target_chunk_size on average 
+// whatever the lines look like. Only the first and the last 8 bytes and the length of the line are hashed, 
+// which is enough to tell the lines apart without reading every byte twice.
+internal void
+find_obj_incremental_cuts_work(void *data)
+{
+    ObjIncrementalWork *work = (ObjIncrementalWork *)data;
+    init_parser_block_list(&work->cuts, sizeof(u64));
+
+    u64 threshold_per_byte = ~0ull / work->target_chunk_size;
+    u8 *line = get_next_line_start(work->file, work->start, work->file_one_past_end);
+    while(line < work->one_past_end)
+    {
+        u8 *newline = (u8 *)memchr(line, '\n', work->file_one_past_end - line);
+        u8 *line_end = newline ? newline + 1 : work->file_one_past_end;
+        u64 length = (u64)(line_end - line);
+
+        if(line != work->file)
+        {
+            u64 first = load_parser_word(line, line_end, 8);
+            u64 last = load_parser_word((length > 8) ? line_end - 8 : line, line_end, 8);
+
+            u64 hash = (first ^ length)*0x9e3779b97f4a7c15ull;
+            hash = (hash ^ (hash >> 29) ^ last)*0xc2b2ae3d27d4eb4full;
+            hash ^= (hash >> 32);
+
+            if(length >= work->target_chunk_size || 
+               hash <= threshold_per_byte*length)
+            {
+                *(u64 *)push_parser_block_list(&work->arena, &work->cuts) = (u64)(line - work->file);
+            }
+        }
+
+        line = line_end;
+    }
+}
+
+internal void
+hash_obj_incremental_chunks_work(void *data)
+{
+    ObjIncrementalWork *work = (ObjIncrementalWork *)data;
+    for(u32 i = 0;
+            i < work->chunk_count;
+            ++i)
+    {
+        ObjIncrementalChunk *chunk = work->chunks + work->chunk_indices[i];
+        chunk->hash = hash_parser_memory(chunk->work.start, chunk->size);
+    }
+}
+
+internal void
+parse_obj_incremental_chunks_work(void *data)
+{
+    ObjIncrementalWork *work = (ObjIncrementalWork *)data;
+    for(u32 i = 0;
+            i < work->chunk_count;
+            ++i)
+    {
+        parse_obj_chunk_work(&work->chunks[work->chunk_indices[i]].work);
+    }
+}
+
+internal void
+copy_obj_incremental_chunks_work(void *data)
+{
+    ObjIncrementalWork *work = (ObjIncrementalWork *)data;
+    for(u32 i = 0;
+            i < work->chunk_count;
+            ++i)
+    {
+        copy_obj_chunk_work(&work->chunks[work->chunk_indices[i]].work);
+    }
+}
+
+// NOTE(joon) there can be more chunks than the work queue can hold, 
+// so the chunks are cut into a few ranges and each work goes through its own range.
+internal void
+do_obj_incremental_work(ParserArena *scratch_arena, ParserThreadPool *pool, parser_work_callback *callback, 
+                        ObjIncrementalChunk *chunks, u32 *chunk_indices, u32 chunk_count)
+{
+    if(chunk_count)
+    {
+        u32 work_count = get_parser_chunk_count(pool, chunk_count, 1);
+        ObjIncrementalWork *works = push_parser_array(scratch_arena, ObjIncrementalWork, work_count);
+
+        u32 first_chunk = 0;
+        for(u32 work_index = 0;
+                work_index < work_count;
+                ++work_index)
+        {
+            u32 next_first_chunk = (u32)(((u64)chunk_count*(work_index + 1))/work_count);
+
+            ObjIncrementalWork *work = works + work_index;
+            *work = {};
+            work->chunks = chunks;
+            work->chunk_indices = chunk_indices + first_chunk;
+            work->chunk_count = next_first_chunk - first_chunk;
+
+            add_parser_work(pool, callback, work);
+
+            first_chunk = next_first_chunk;
+        }
+        complete_all_parser_work(pool);
+    }
+}
+
+// NOTE(joon) the arena should outlive the state, and the state should not move 
+// while it has the chunks(the chunk arenas are the sub-arenas of the arena).
+internal void
+begin_obj_incremental(ObjIncrementalState *state, ParserArena *arena, size_t target_chunk_size = 1024*1024)
+{
+    assert(target_chunk_size >= 4096);
+
+    *state = {};
+    state->arena = arena;
+    state->target_chunk_size = target_chunk_size;
+    state->chunk_arena = begin_parser_sub_arena(arena);
+    state->result_arena = begin_parser_sub_arena(arena);
+}
+
+// NOTE(joon) same result as load_obj, but the file is cut into content defined chunks, and every chunk 
+// keeps its hash and its parse result until the next call. Only the chunks whose bytes are not 
+// in the previous version of the file are parsed again, the other chunks are just copied into the result 
+// with their new offsets. If the counts didn't change(i.e a vertex was edited in place), 
+// the result arrays stay where they were and only the chunks that changed are copied.
+// The whole file is still read once to find the cuts and the hashes, so this is bound by the memory bandwidth, 
+// not by the parser.
+// The result is valid until the next load_obj_incremental or end_obj_incremental.
+internal LoadObjResult
+load_obj_incremental(ObjIncrementalState *state, u8 *file, size_t file_size, ParserThreadPool *pool = 0)
+{
+    assert(file && file_size > 0);
+
+    ParserArena scratch_arena = begin_parser_sub_arena(state->arena);
+    u8 *one_past_end = file + file_size;
+    size_t target_chunk_size = state->target_chunk_size;
+
+    // NOTE(joon) find the cut candidates in parallel, and then drop the ones that would make the chunks 
+    // too small or add the ones that would make them too big, in order
+    u32 cut_work_count = get_parser_chunk_count(pool, file_size, 16*target_chunk_size);
+    ObjIncrementalWork *cut_works = push_parser_array(&scratch_arena, ObjIncrementalWork, cut_work_count);
+    for(u32 work_index = 0;
+            work_index < cut_work_count;
+            ++work_index)
+    {
+        ObjIncrementalWork *work = cut_works + work_index;
+        *work = {};
+        work->file = file;
+        work->start = file + (file_size/cut_work_count)*work_index;
+        work->one_past_end = (work_index == cut_work_count - 1) ? one_past_end : file + (file_size/cut_work_count)*(work_index + 1);
+        work->file_one_past_end = one_past_end;
+        work->target_chunk_size = target_chunk_size;
+        work->arena = begin_parser_sub_arena(&scratch_arena);
+
+        add_parser_work(pool, find_obj_incremental_cuts_work, work);
+    }
+    complete_all_parser_work(pool);
+
+    size_t minimum_chunk_size = target_chunk_size/4;
+    size_t maximum_chunk_size = 4*target_chunk_size;
+
+    ParserBlockList chunk_starts;
+    init_parser_block_list(&chunk_starts, sizeof(u64));
+    *(u64 *)push_parser_block_list(&scratch_arena, &chunk_starts) = 0;
+    u64 previous_cut = 0;
+    for(u32 work_index = 0;
+            work_index <= cut_work_count;
+            ++work_index)
+    {
+        ParserBlock *block = (work_index < cut_work_count) ? cut_works[work_index].cuts.first : 0;
+        u32 i = 0;
+        while(1)
+        {
+            // NOTE(joon) the end of the file is the last cut, but it doesn't start a chunk
+            b32 is_file_end = (work_index == cut_work_count);
+            if(!is_file_end && !block)
+            {
+                break;
+            }
+            u64 cut = is_file_end ? file_size : ((u64 *)(block + 1))[i];
+
+            while(cut - previous_cut > maximum_chunk_size)
+            {
+                u64 forced_cut = (u64)(get_next_line_start(file, file + previous_cut + maximum_chunk_size, one_past_end) - file);
+                if(forced_cut >= cut)
+                {
+                    break;
                 }
 
+                *(u64 *)push_parser_block_list(&scratch_arena, &chunk_starts) = forced_cut;
+                previous_cut = forced_cut;
+            }
+
+            if(is_file_end)
+            {
+                break;
+            }
+
+            if(cut - previous_cut >= minimum_chunk_size)
+            {
+                *(u64 *)push_parser_block_list(&scratch_arena, &chunk_starts) = cut;
+                previous_cut = cut;
+            }
+
+            if(++i == block->count)
+            {
+                block = block->next;
+                i = 0;
+            }
+        }
+    }
+
+    for(u32 work_index = 0;
+            work_index < cut_work_count;
+            ++work_index)
+    {
+        free_parser_arena(&cut_works[work_index].arena);
+    }
+
+    u32 chunk_count = chunk_starts.total_count;
+    u64 *chunk_offsets = push_parser_array(&scratch_arena, u64, chunk_count + 1);
+    copy_parser_block_list(&chunk_starts, chunk_offsets);
+    chunk_offsets[chunk_count] = file_size;
+
+    ParserArena chunk_arena = begin_parser_sub_arena(state->arena);
+    ObjIncrementalChunk *chunks = push_parser_array(&chunk_arena, ObjIncrementalChunk, chunk_count);
+    u32 *chunk_indices = push_parser_array(&scratch_arena, u32, chunk_count);
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjIncrementalChunk *chunk = chunks + chunk_index;
+        *chunk = {};
+        chunk->size = chunk_offsets[chunk_index + 1] - chunk_offsets[chunk_index];
+        chunk->work.start = file + chunk_offsets[chunk_index];
+        chunk->work.one_past_end = file + chunk_offsets[chunk_index + 1];
+
+        chunk_indices[chunk_index] = chunk_index;
+    }
+    do_obj_incremental_work(&scratch_arena, pool, hash_obj_incremental_chunks_work, chunks, chunk_indices, chunk_count);
+
+    // NOTE(joon) the old chunks by their hashes. A chunk takes the parse result of the old chunk 
+    // that has the same bytes, so the chunks that moved inside the file are not parsed again either.
+    u32 slot_count = 16;
+    while(slot_count < 2*state->chunk_count)
+    {
+        slot_count *= 2;
+    }
+    u32 slot_mask = slot_count - 1;
+    ObjIncrementalSlot *slots = push_parser_array(&scratch_arena, ObjIncrementalSlot, slot_count);
+    memset(slots, 0, sizeof(ObjIncrementalSlot)*slot_count);
+    for(u32 old_chunk_index = 0;
+            old_chunk_index < state->chunk_count;
+            ++old_chunk_index)
+    {
+        u64 hash = state->chunks[old_chunk_index].hash;
+        u32 slot_index = (u32)hash & slot_mask;
+        while(slots[slot_index].chunk_index_plus_one)
+        {
+            slot_index = (slot_index + 1) & slot_mask;
+        }
+
+        slots[slot_index].hash = hash;
+        slots[slot_index].chunk_index_plus_one = old_chunk_index + 1;
+    }
+
+    state->reparsed_chunk_count = 0;
+    state->reparsed_size = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjIncrementalChunk *chunk = chunks + chunk_index;
+
+        ObjIncrementalChunk *old_chunk = 0;
+        for(u32 slot_index = (u32)chunk->hash & slot_mask;
+                slots[slot_index].chunk_index_plus_one;
+                slot_index = (slot_index + 1) & slot_mask)
+        {
+            ObjIncrementalChunk *candidate = state->chunks + slots[slot_index].chunk_index_plus_one - 1;
+            if(slots[slot_index].hash == chunk->hash && 
+               candidate->size == chunk->size && 
+               !candidate->is_moved)
+            {
+                old_chunk = candidate;
+                break;
+            }
+        }
+
+        u8 *start = chunk->work.start;
+        u8 *end = chunk->work.one_past_end;
+        if(old_chunk)
+        {
+            // NOTE(joon) the arena moves with the chunk, nothing inside it points back to the old chunk
+            chunk->work = old_chunk->work;
+            old_chunk->is_moved = true;
+        }
+        else
+        {
+            chunk->work = {};
+            chunk->work.arena = begin_parser_sub_arena(state->arena, target_chunk_size);
+            chunk->is_reparsed = true;
+
+            chunk_indices[state->reparsed_chunk_count++] = chunk_index;
+            state->reparsed_size += chunk->size;
+        }
+        chunk->work.start = start;
+        chunk->work.one_past_end = end;
+    }
+    do_obj_incremental_work(&scratch_arena, pool, parse_obj_incremental_chunks_work, chunks, chunk_indices, state->reparsed_chunk_count);
+
+    for(u32 old_chunk_index = 0;
+            old_chunk_index < state->chunk_count;
+            ++old_chunk_index)
+    {
+        ObjIncrementalChunk *old_chunk = state->chunks + old_chunk_index;
+        if(!old_chunk->is_moved)
+        {
+            free_parser_arena(&old_chunk->work.arena);
+        }
+    }
+    free_parser_arena(&state->chunk_arena);
+    state->chunk_arena = chunk_arena;
+    state->chunks = chunks;
+
+    // NOTE(joon) same as begin_load_obj from here, but the chunks that are already at the right place 
+    // inside the previous result are not copied again
+    LoadObjResult *result = &state->result;
+    PreParseObjResult counts = {};
+    b32 v_appeared = false;
+    b32 vt_appeared = false;
+    b32 vn_appeared = false;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjChunk *chunk = &chunks[chunk_index].work.chunk;
+
+        counts.position_count += chunk->positions.total_count;
+        counts.normal_count += chunk->normals.total_count;
+        counts.texcoord_count += chunk->texcoord_count;
+        counts.index_count += chunk->indices.total_count;
+
+        v_appeared |= chunk->v_appeared;
+        vt_appeared |= chunk->vt_appeared;
+        vn_appeared |= chunk->vn_appeared;
+    }
+    counts.vertex_type = get_obj_vertex_type(v_appeared, vt_appeared, vn_appeared);
+
+    state->is_result_patched = (state->chunk_count && 
+                                counts.position_count == result->counts.position_count && 
+                                counts.normal_count == result->counts.normal_count && 
+                                counts.texcoord_count == result->counts.texcoord_count && 
+                                counts.index_count == result->counts.index_count);
+    if(!state->is_result_patched)
+    {
+        free_parser_arena(&state->result_arena);
+        result->positions = push_parser_array(&state->result_arena, v3, counts.position_count);
+        result->normals = push_parser_array(&state->result_arena, v3, counts.normal_count);
+        result->texcoords = push_parser_array(&state->result_arena, v2, counts.texcoord_count);
+        result->indices = push_parser_array(&state->result_arena, u32, counts.index_count);
+    }
+    result->counts = counts;
+    state->chunk_count = chunk_count;
+
+    u32 copy_count = 0;
+    u32 position_offset = 0;
+    u32 normal_offset = 0;
+    u32 texcoord_offset = 0;
+    u32 index_offset = 0;
+    for(u32 chunk_index = 0;
+            chunk_index < chunk_count;
+            ++chunk_index)
+    {
+        ObjIncrementalChunk *chunk = chunks + chunk_index;
+        ObjChunkWork *work = &chunk->work;
+
+        v3 *positions = result->positions + position_offset;
+        v3 *normals = result->normals + normal_offset;
+        v2 *texcoords = result->texcoords + texcoord_offset;
+        u32 *indices = result->indices + index_offset;
+        if(!state->is_result_patched || 
+           chunk->is_reparsed || 
+           work->positions != positions || 
+           work->normals != normals || 
+           work->texcoords != texcoords || 
+           work->indices != indices)
+        {
+            work->positions = positions;
+            work->normals = normals;
+            work->texcoords = texcoords;
+            work->indices = indices;
+            chunk_indices[copy_count++] = chunk_index;
+        }
+
+        position_offset += work->chunk.positions.total_count;
+        normal_offset += work->chunk.normals.total_count;
+        texcoord_offset += work->chunk.texcoords.total_count;
+        index_offset += work->chunk.indices.total_count;
+    }
+    do_obj_incremental_work(&scratch_arena, pool, copy_obj_incremental_chunks_work, chunks, chunk_indices, copy_count);
+
+    free_parser_arena(&scratch_arena);
+
+    return *result;
+}
+
+internal void
+end_obj_incremental(ObjIncrementalState *state)
+{
+    for(u32 chunk_index = 0;
+            chunk_index < state->chunk_count;
+            ++chunk_index)
+    {
+        free_parser_arena(&state->chunks[chunk_index].work.arena);
+    }
+    free_parser_arena(&state->chunk_arena);
+    free_parser_arena(&state->result_arena);
+
+    *state = {};
+}
+
+// NOTE(joon) reads until the chunk is full or the file is over. 
+// Read errors also end the file, and the errno goes into chunk->error(same as refill_parser_stream).
+internal void
+read_parser_chunk(int file_descriptor, ParserReadChunk *chunk, size_t chunk_size, b32 use_pread)
+{
+    while(chunk->size < chunk_size)
+    {
+        ssize_t bytes_read;
+        if(use_pread)
+        {
+            bytes_read = pread(file_descriptor, chunk->memory + chunk->size, chunk_size - chunk->size, (off_t)(chunk->offset + chunk->size));
+        }
+        else
+        {
+            bytes_read = read(file_descriptor, chunk->memory + chunk->size, chunk_size - chunk->size);
+        }
+
+        if(bytes_read > 0)
+        {
+            chunk->size += bytes_read;
+        }
+        else if(bytes_read == 0 || errno != EINTR)
+        {
+            if(bytes_read < 0)
+            {
+                chunk->error = errno;
+            }
+            chunk->reached_eof = true;
+            break;
+        }
+    }
+}
+
+internal ParserCompression
+get_parser_compression(u8 *memory, size_t size)
+{
+    ParserCompression result = parser_compression_none;
+    if(size >= 2 && memory[0] == 0x1f && memory[1] == 0x8b)
+    {
+        result = parser_compression_gzip;
+    }
+    else if(size >= 4 && memory[0] == 0x28 && memory[1] == 0xb5 && memory[2] == 0x2f && memory[3] == 0xfd)
+    {
+        result = parser_compression_zstd;
+    }
+
+    return result;
+}
+
+// NOTE(joon) moves the compressed bytes that are left to the start of the input, and reads once more
+internal void
+refill_parser_decompressor_input(ParserDecompressor *decompressor)
+{
+    size_t leftover_size = (size_t)(decompressor->input_one_past_end - decompressor->input_at);
+    memmove(decompressor->input, decompressor->input_at, leftover_size);
+    decompressor->input_at = decompressor->input;
+    decompressor->input_one_past_end = decompressor->input + leftover_size;
+
+    u8 *input_end = decompressor->input + decompressor->input_size;
+    while(!decompressor->input_reached_eof && decompressor->input_one_past_end < input_end)
+    {
+        ssize_t bytes_read = read(decompressor->file_descriptor, decompressor->input_one_past_end, 
+                                  (size_t)(input_end - decompressor->input_one_past_end));
+        if(bytes_read > 0)
+        {
+            decompressor->input_one_past_end += bytes_read;
+            break;
+        }
+        else if(bytes_read == 0 || errno != EINTR)
+        {
+            if(bytes_read < 0)
+            {
+                decompressor->error = errno;
+            }
+            decompressor->input_reached_eof = true;
+        }
+    }
+}
+
+// NOTE(joon) decompresses until the chunk is full or the stream is over. 
+// Corrupted streams end the stream with EIO, same as the read errors.
+internal void
+decompress_parser_chunk(ParserDecompressor *decompressor, ParserReadChunk *chunk, size_t chunk_size)
+{
+    while(chunk->size < chunk_size && !decompressor->reached_eof)
+    {
+        if(decompressor->input_at == decompressor->input_one_past_end)
+        {
+            refill_parser_decompressor_input(decompressor);
+        }
 
+        u8 *input_at = decompressor->input_at;
+        size_t input_size = (size_t)(decompressor->input_one_past_end - input_at);
+        size_t previous_chunk_size = chunk->size;
+        switch(decompressor->compression)
+        {
+            case parser_compression_none:
+            {
+                size_t copy_size = chunk_size - chunk->size;
+                if(copy_size > input_size)
+                {
+                    copy_size = input_size;
+                }
+                memcpy(chunk->memory + chunk->size, input_at, copy_size);
+                decompressor->input_at += copy_size;
+                chunk->size += copy_size;
             }break;
 
-            case ply_token_type_property:
+#if PARSER_ZLIB
+            case parser_compression_gzip:
             {
-                PlyToken type = eat_ply_token(&tokenizer); 
-                PlyToken axis = eat_ply_token(&tokenizer); // x or y or z
+                z_stream *stream = (z_stream *)decompressor->state;
+                stream->next_in = input_at;
+                stream->avail_in = (uInt)input_size;
+                stream->next_out = chunk->memory + chunk->size;
+                stream->avail_out = (uInt)(chunk_size - chunk->size);
 
-                result.vertex_property_count++;
+                int inflate_result = inflate(stream, Z_NO_FLUSH);
+                decompressor->input_at = stream->next_in;
+                chunk->size = (size_t)(stream->next_out - chunk->memory);
+
+                if(inflate_result == Z_STREAM_END)
+                {
+                    // NOTE(joon) gzip files can be several members glued together(i.e cat a.gz b.gz)
+                    inflateReset(stream);
+                }
+                else if(inflate_result != Z_OK && inflate_result != Z_BUF_ERROR)
+                {
+                    decompressor->error = EIO;
+                    decompressor->reached_eof = true;
+                }
             }break;
+#endif
 
-            case ply_token_type_end_header:
+#if PARSER_ZSTD
+            case parser_compression_zstd:
             {
-                end_header_appeared = true;
+                // NOTE(joon) multiple frames are decoded one after another by the same stream
+                ZSTD_inBuffer in = {input_at, input_size, 0};
+                ZSTD_outBuffer out = {chunk->memory, chunk_size, chunk->size};
+                size_t decompress_result = ZSTD_decompressStream((ZSTD_DStream *)decompressor->state, &out, &in);
+                decompressor->input_at += in.pos;
+                chunk->size = out.pos;
+
+                if(ZSTD_isError(decompress_result))
+                {
+                    decompressor->error = EIO;
+                    decompressor->reached_eof = true;
+                }
+            }break;
+#endif
+
+            default:
+            {
+                // NOTE(joon) compressed, but the support is not compiled in. 
+                // begin_parser_decompress_pipeline already ended the stream, so this is never reached.
+                decompressor->error = ENOTSUP;
+                decompressor->reached_eof = true;
             }break;
         }
+
+        if(chunk->size == previous_chunk_size && decompressor->input_at == input_at)
+        {
+            // NOTE(joon) no progress, either the input is over, or the decompressor needs more of it
+            if(decompressor->input_reached_eof)
+            {
+                decompressor->reached_eof = true;
+            }
+            else
+            {
+                refill_parser_decompressor_input(decompressor);
+            }
+        }
+    }
+
+    if(decompressor->reached_eof)
+    {
+        chunk->reached_eof = true;
+        chunk->error = decompressor->error;
+    }
+}
+
+// NOTE(joon) either reads or decompresses the next chunk
+internal void
+fill_parser_read_chunk(ParserReadPipeline *pipeline, ParserReadChunk *chunk, b32 use_pread)
+{
+    if(pipeline->decompressor)
+    {
+        decompress_parser_chunk(pipeline->decompressor, chunk, pipeline->chunk_size);
+    }
+    else
+    {
+        read_parser_chunk(pipeline->file_descriptor, chunk, pipeline->chunk_size, use_pread);
+    }
+}
+
+internal ParserReadChunk *
+get_parser_read_chunk(ParserReadPipeline *pipeline, u64 chunk_index)
+{
+    ParserReadChunk *result = pipeline->chunks + (chunk_index % pipeline->queue_depth);
+    return result;
+}
+
+internal void *
+parser_read_thread_proc(void *data)
+{
+    ParserReadPipeline *pipeline = (ParserReadPipeline *)data;
+
+    pthread_mutex_lock(&pipeline->mutex);
+    while(!pipeline->is_shutting_down)
+    {
+        if(!pipeline->reached_eof &&
+           pipeline->next_chunk_to_read < pipeline->next_chunk_to_consume + pipeline->queue_depth)
+        {
+            u64 chunk_index = pipeline->next_chunk_to_read++;
+            ParserReadChunk *chunk = get_parser_read_chunk(pipeline, chunk_index);
+            chunk->offset = pipeline->first_offset + chunk_index*pipeline->chunk_size;
+            chunk->size = 0;
+            chunk->reached_eof = false;
+            chunk->error = 0;
+            chunk->is_in_flight = true;
+            pthread_mutex_unlock(&pipeline->mutex);
+
+            fill_parser_read_chunk(pipeline, chunk, true);
+
+            pthread_mutex_lock(&pipeline->mutex);
+            chunk->is_in_flight = false;
+            chunk->is_ready = true;
+            if(chunk->reached_eof)
+            {
+                pipeline->reached_eof = true;
+            }
+            pthread_cond_broadcast(&pipeline->chunk_changed);
+        }
+        else
+        {
+            pthread_cond_wait(&pipeline->chunk_changed, &pipeline->mutex);
+        }
+    }
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    return 0;
+}
+
+#if PARSER_IO_URING
+internal b32
+begin_parser_io_uring(ParserReadPipeline *pipeline)
+{
+    io_uring_params params = {};
+    int ring_file_descriptor = (int)syscall(__NR_io_uring_setup, pipeline->queue_depth, &params);
+    if(ring_file_descriptor < 0)
+    {
+        // NOTE(joon) old kernel, or io_uring is blocked(seccomp, containers...)
+        return false;
     }
 
-    // TODO(joon) hack, probably not a bad idea (but what if .ply file only has two elements?)
-    result.vertex_property_count--;
+    // NOTE(joon) IORING_OP_READ came later than io_uring itself(5.6), so ask the kernel
+    u8 probe_memory[sizeof(io_uring_probe) + 256*sizeof(io_uring_probe_op)] = {};
+    io_uring_probe *probe = (io_uring_probe *)probe_memory;
+    if(syscall(__NR_io_uring_register, ring_file_descriptor, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+       probe->last_op < IORING_OP_READ ||
+       !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+    {
+        close(ring_file_descriptor);
+        return false;
+    }
 
-    // NOTE(joon) ply files do not specify how many indices are there, so we need to get them ourselvese
-    for(u32 vertex_index = 0;
-            vertex_index < result.vertex_count;
-            ++vertex_index)
+    size_t submission_ring_size = params.sq_off.array + params.sq_entries*sizeof(u32);
+    size_t completion_ring_size = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+    b32 is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP);
+    if(is_single_mmap)
     {
-        for(u32 property_index = 0;
-                property_index < result.vertex_property_count;
-                ++property_index)
+        if(completion_ring_size > submission_ring_size)
         {
-            PlyToken token = eat_ply_token(&tokenizer);
-
-            assert(token.type == ply_token_type_f32 ||
-                   token.type == ply_token_type_i32);
-
+            submission_ring_size = completion_ring_size;
         }
+        completion_ring_size = submission_ring_size;
     }
 
-    while(tokenizer.at < tokenizer.one_past_end && 
-            peek_ply_token(tokenizer).type != 0) // For eof
+    void *submission_ring = mmap(0, submission_ring_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, 
+                                 ring_file_descriptor, IORING_OFF_SQ_RING);
+    void *completion_ring = submission_ring;
+    if(!is_single_mmap && submission_ring != MAP_FAILED)
     {
-        PlyToken index_count = eat_ply_token(&tokenizer);
-        assert(index_count.type == ply_token_type_i32 &&
-                index_count.value_i32 >= 3);
-
-        result.index_count += (u32)(3 * (index_count.value_i32 - 2));
+        completion_ring = mmap(0, completion_ring_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, 
+                               ring_file_descriptor, IORING_OFF_CQ_RING);
+    }
+    size_t submission_entries_size = params.sq_entries*sizeof(io_uring_sqe);
+    void *submission_entries = MAP_FAILED;
+    if(submission_ring != MAP_FAILED && completion_ring != MAP_FAILED)
+    {
+        submission_entries = mmap(0, submission_entries_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, 
+                                  ring_file_descriptor, IORING_OFF_SQES);
+    }
 
-        eat_until_newline(&tokenizer);
+    if(submission_entries == MAP_FAILED)
+    {
+        if(submission_ring != MAP_FAILED)
+        {
+            munmap(submission_ring, submission_ring_size);
+        }
+        if(!is_single_mmap && completion_ring != MAP_FAILED)
+        {
+            munmap(completion_ring, completion_ring_size);
+        }
+        close(ring_file_descriptor);
+        return false;
     }
-    // NOTE(joon) now get how many indices do we need
 
-    return result;
+    pipeline->ring_file_descriptor = ring_file_descriptor;
+    pipeline->submission_ring = submission_ring;
+    pipeline->submission_ring_size = submission_ring_size;
+    pipeline->completion_ring = is_single_mmap ? 0 : completion_ring;
+    pipeline->completion_ring_size = completion_ring_size;
+    pipeline->submission_entries = submission_entries;
+    pipeline->submission_entries_size = submission_entries_size;
+
+    pipeline->submission_head = (u32 *)((u8 *)submission_ring + params.sq_off.head);
+    pipeline->submission_tail = (u32 *)((u8 *)submission_ring + params.sq_off.tail);
+    pipeline->submission_mask = (u32 *)((u8 *)submission_ring + params.sq_off.ring_mask);
+    pipeline->submission_array = (u32 *)((u8 *)submission_ring + params.sq_off.array);
+    pipeline->completion_head = (u32 *)((u8 *)completion_ring + params.cq_off.head);
+    pipeline->completion_tail = (u32 *)((u8 *)completion_ring + params.cq_off.tail);
+    pipeline->completion_mask = (u32 *)((u8 *)completion_ring + params.cq_off.ring_mask);
+    pipeline->completion_entries = (u8 *)completion_ring + params.cq_off.cqes;
+
+    return true;
 }
 
-// NOTE(joon) minimal ply parser, that only parses vertices for now. 
+// NOTE(joon) queues a read for whatever is left in the chunk, the chunk pointer comes back in the completion
 internal void
-parse_ply(u8 *memory, u32 file_size, ParsePlyHeaderResult header, f32 *vertices, u32 *indices)
+submit_parser_io_uring_read(ParserReadPipeline *pipeline, ParserReadChunk *chunk)
 {
-    Tokenizer tokenizer = {};
-    tokenizer.at = memory;
-    tokenizer.one_past_end = memory + file_size;
+    u32 tail = *pipeline->submission_tail;
+    u32 index = tail & *pipeline->submission_mask;
 
-    while(tokenizer.at < tokenizer.one_past_end)
+    io_uring_sqe *entry = (io_uring_sqe *)pipeline->submission_entries + index;
+    memset(entry, 0, sizeof(*entry));
+    entry->opcode = IORING_OP_READ;
+    entry->fd = pipeline->file_descriptor;
+    entry->addr = (u64)(chunk->memory + chunk->size);
+    entry->len = (u32)(pipeline->chunk_size - chunk->size);
+    entry->off = chunk->offset + chunk->size;
+    entry->user_data = (u64)chunk;
+
+    pipeline->submission_array[index] = index;
+    __atomic_store_n(pipeline->submission_tail, tail + 1, __ATOMIC_RELEASE);
+
+    chunk->is_in_flight = true;
+    pipeline->in_flight_count++;
+
+    while(syscall(__NR_io_uring_enter, pipeline->ring_file_descriptor, 1, 0, 0, 0, 0) < 0 && errno == EINTR)
     {
-        PlyToken token = eat_ply_token(&tokenizer);
+    }
+}
 
-        if(token.type == ply_token_type_end_header)
-        {
-            break;
-        }
+// NOTE(joon) waits for at least one read, and handles every completion that is there
+internal void
+complete_parser_io_uring_reads(ParserReadPipeline *pipeline)
+{
+    u32 head = *pipeline->completion_head;
+    if(head == __atomic_load_n(pipeline->completion_tail, __ATOMIC_ACQUIRE))
+    {
+        syscall(__NR_io_uring_enter, pipeline->ring_file_descriptor, 0, 1, IORING_ENTER_GETEVENTS, 0, 0);
     }
 
-    u32 vertex_index = 0;
-    for(u32 i = 0;
-            i < header.vertex_count;
-            ++i)
+    while(head != __atomic_load_n(pipeline->completion_tail, __ATOMIC_ACQUIRE))
     {
-        for(u32 vertex_property_index = 0;
-                vertex_property_index < header.vertex_property_count;
-                ++vertex_property_index)
-        {
-            PlyToken token = eat_ply_token(&tokenizer);
-            assert(token.type == ply_token_type_f32 || 
-                    token.type == ply_token_type_i32);
+        io_uring_cqe *entry = (io_uring_cqe *)pipeline->completion_entries + (head & *pipeline->completion_mask);
+        ParserReadChunk *chunk = (ParserReadChunk *)entry->user_data;
+        i32 bytes_read = entry->res;
+        head++;
+        __atomic_store_n(pipeline->completion_head, head, __ATOMIC_RELEASE);
 
-            if(token.is_float)
-            {
-                vertices[vertex_index] = token.value_f32;
-            }
-            else
+        chunk->is_in_flight = false;
+        pipeline->in_flight_count--;
+
+        if(bytes_read > 0)
+        {
+            chunk->size += bytes_read;
+        }
+        else if(bytes_read != -EINTR && bytes_read != -EAGAIN)
+        {
+            if(bytes_read < 0)
             {
-                vertices[vertex_index] = (f32)token.value_i32;
+                chunk->error = -bytes_read;
             }
+            chunk->reached_eof = true;
+        }
 
-            vertex_index++;
+        if(chunk->size == pipeline->chunk_size || chunk->reached_eof)
+        {
+            chunk->is_ready = true;
+        }
+        else
+        {
+            // NOTE(joon) short read, ask for the rest
+            submit_parser_io_uring_read(pipeline, chunk);
         }
+    }
+}
 
-        eat_until_newline(&tokenizer);
+internal void
+end_parser_io_uring(ParserReadPipeline *pipeline)
+{
+    // NOTE(joon) the kernel might still be writing into the chunks
+    while(pipeline->in_flight_count)
+    {
+        complete_parser_io_uring_reads(pipeline);
     }
 
-    u32 index_index = 0;
-    // NOTE(joon) this assumes that the indices will always appear at the last
-    while(tokenizer.at < tokenizer.one_past_end && 
-            peek_ply_token(tokenizer).type != 0) // for eof
+    munmap(pipeline->submission_entries, pipeline->submission_entries_size);
+    munmap(pipeline->submission_ring, pipeline->submission_ring_size);
+    if(pipeline->completion_ring)
     {
-        PlyToken index_count = eat_ply_token(&tokenizer);
-        assert(index_count.type == ply_token_type_i32 &&
-                index_count.value_i32 >= 3);
+        munmap(pipeline->completion_ring, pipeline->completion_ring_size);
+    }
+    close(pipeline->ring_file_descriptor);
+}
+#endif
 
-        PlyToken index_0 = eat_ply_token(&tokenizer); // will be used as a first index to the strip for this line
-        PlyToken index_1 = eat_ply_token(&tokenizer);
-        PlyToken index_2 = eat_ply_token(&tokenizer);
+internal void
+init_parser_read_pipeline(ParserReadPipeline *pipeline, ParserArena *arena, int file_descriptor, size_t chunk_size, u32 queue_depth)
+{
+    assert(queue_depth >= 1 && queue_depth <= parser_max_read_queue_depth);
+    assert(chunk_size > 0 && chunk_size <= 0x7fffffff);
+
+    *pipeline = {};
+    pipeline->file_descriptor = file_descriptor;
+    pipeline->chunk_size = chunk_size;
+    pipeline->queue_depth = queue_depth;
+    for(u32 chunk_index = 0;
+            chunk_index < queue_depth;
+            ++chunk_index)
+    {
+        pipeline->chunks[chunk_index].memory = (u8 *)push_parser_size(arena, chunk_size, 4096);
+    }
+}
 
-        assert(index_0.type == ply_token_type_i32 && 
-               index_1.type == ply_token_type_i32 &&
-               index_2.type == ply_token_type_i32);
+// NOTE(joon) if the thread can't be started, the chunks are filled by the parser thread when it asks for them
+internal void
+start_parser_read_thread(ParserReadPipeline *pipeline, ParserReadBackend backend)
+{
+    pthread_mutex_init(&pipeline->mutex, 0);
+    pthread_cond_init(&pipeline->chunk_changed, 0);
+    if(pthread_create(&pipeline->thread, 0, parser_read_thread_proc, pipeline) == 0)
+    {
+        pipeline->backend = backend;
+    }
+    else
+    {
+        pthread_cond_destroy(&pipeline->chunk_changed);
+        pthread_mutex_destroy(&pipeline->mutex);
+        pipeline->backend = parser_read_backend_read;
+    }
+}
 
-        indices[index_index++] = index_0.value_i32;
-        indices[index_index++] = index_1.value_i32;
-        indices[index_index++] = index_2.value_i32;
+// NOTE(joon) starts reading the chunks right away. The chunk buffers are allocated inside the arena, 
+// and the file is read from where the file descriptor is at right now. 
+// Files that can't be read with an offset(pipes, sockets) are read one chunk at a time, without the overlap.
+internal void
+begin_parser_read_pipeline(ParserReadPipeline *pipeline, ParserArena *arena, int file_descriptor, 
+                           size_t chunk_size = 1024*1024, u32 queue_depth = 4, b32 allow_io_uring = true)
+{
+    init_parser_read_pipeline(pipeline, arena, file_descriptor, chunk_size, queue_depth);
 
-        // starting from 1, as we already parsed the first strip
-        for(u32 strip_index = 1;
-                strip_index < index_count.value_i32 - 2;
-                ++strip_index)
+    off_t first_offset = lseek(file_descriptor, 0, SEEK_CUR);
+    if(first_offset < 0)
+    {
+        pipeline->backend = parser_read_backend_read;
+        return;
+    }
+    pipeline->first_offset = (u64)first_offset;
+
+#if PARSER_IO_URING
+    if(allow_io_uring && begin_parser_io_uring(pipeline))
+    {
+        pipeline->backend = parser_read_backend_io_uring;
+        for(u32 chunk_index = 0;
+                chunk_index < queue_depth;
+                ++chunk_index)
         {
-            u32 second_index = indices[index_index-1];
-            
-            indices[index_index++] = index_0.value_i32;
-            indices[index_index++] = second_index;
-            indices[index_index++] = eat_ply_token(&tokenizer).value_i32;
+            ParserReadChunk *chunk = get_parser_read_chunk(pipeline, pipeline->next_chunk_to_read);
+            chunk->offset = pipeline->first_offset + pipeline->next_chunk_to_read*chunk_size;
+            pipeline->next_chunk_to_read++;
+
+            submit_parser_io_uring_read(pipeline, chunk);
         }
+        return;
     }
+#endif
 
-    assert(index_index == header.index_count);
+    start_parser_read_thread(pipeline, parser_read_backend_pread_thread);
 }
 
-// NOTE/Joon: This function is more like a general purpose token getter, with minimum erro checking.
-// the error checking itself will happen inside the parsing loop, not here.
-internal ObjToken
-eat_obj_token(Tokenizer *tokenizer)
+// NOTE(joon) same as begin_parser_read_pipeline, but the file can be gzip or zstd(or not compressed at all, 
+// which is found out from the first bytes), and the chunks are the decompressed bytes. 
+// The decompression happens on its own thread, so it runs at the same time as the parser, 
+// and nothing is written to the disk. 
+// Memory is bounded by input_size + chunk_size*queue_depth(+ the zlib/zstd window).
+// Returns false when the file is compressed but PARSER_ZLIB / PARSER_ZSTD was not compiled in, 
+// in which case the pipeline still has to be ended, but it only gives out an empty file(with the error ENOTSUP).
+internal b32
+begin_parser_decompress_pipeline(ParserReadPipeline *pipeline, ParserArena *arena, int file_descriptor, 
+                                 size_t chunk_size = 1024*1024, u32 queue_depth = 4, size_t input_size = 256*1024)
 {
-    ObjToken result = {};
+    assert(input_size >= 4 && input_size <= 0x7fffffff);
 
-    eat_all_whitespaces(tokenizer);
-    
-    if(tokenizer->at < tokenizer->one_past_end)
+    init_parser_read_pipeline(pipeline, arena, file_descriptor, chunk_size, queue_depth);
+
+    ParserDecompressor *decompressor = push_parser_struct(arena, ParserDecompressor);
+    *decompressor = {};
+    decompressor->file_descriptor = file_descriptor;
+    decompressor->input = (u8 *)push_parser_size(arena, input_size);
+    decompressor->input_size = input_size;
+    decompressor->input_at = decompressor->input;
+    decompressor->input_one_past_end = decompressor->input;
+
+    while(!decompressor->input_reached_eof && 
+          decompressor->input_one_past_end - decompressor->input < 4)
     {
-        b32 hyphen_appeared = false;
-        if(*tokenizer->at ==  '-')
+        refill_parser_decompressor_input(decompressor);
+    }
+    decompressor->compression = get_parser_compression(decompressor->input, 
+                                                       (size_t)(decompressor->input_one_past_end - decompressor->input));
+
+    b32 result = true;
+    switch(decompressor->compression)
+    {
+        case parser_compression_none:
         {
-            // NOTE(joon) rare case where the case should go on, instead of breaking out
-            hyphen_appeared = true;
-            tokenizer->at++;
-        }
+        }break;
 
-        if(string_compare((char *)tokenizer->at, "v "))
+#if PARSER_ZLIB
+        case parser_compression_gzip:
         {
-            result.type = obj_token_type_v;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "vt "))
+            z_stream *stream = push_parser_struct(arena, z_stream);
+            *stream = {};
+            // NOTE(joon) +32 detects the gzip(or zlib) header by itself
+            int init_result = inflateInit2(stream, 15 + 32);
+            assert(init_result == Z_OK);
+            decompressor->state = stream;
+        }break;
+#endif
+
+#if PARSER_ZSTD
+        case parser_compression_zstd:
         {
-            result.type = obj_token_type_vt;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "vn "))
+            ZSTD_DStream *stream = ZSTD_createDStream();
+            assert(stream);
+            ZSTD_initDStream(stream);
+            decompressor->state = stream;
+        }break;
+#endif
+
+        default:
         {
-            result.type = obj_token_type_vn;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "f "))
+            // NOTE(joon) compile with PARSER_ZLIB / PARSER_ZSTD to read these
+            decompressor->error = ENOTSUP;
+            decompressor->reached_eof = true;
+            result = false;
+        }break;
+    }
+
+    pipeline->decompressor = decompressor;
+    start_parser_read_thread(pipeline, parser_read_backend_decompress_thread);
+
+    return result;
+}
+
+// NOTE(joon) waits for the next chunk in the file order, returns 0 when the file is over
+internal ParserReadChunk *
+get_next_parser_read_chunk(ParserReadPipeline *pipeline)
+{
+    ParserReadChunk *result = get_parser_read_chunk(pipeline, pipeline->next_chunk_to_consume);
+    switch(pipeline->backend)
+    {
+        case parser_read_backend_read:
         {
-            result.type = obj_token_type_f;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "mtllib "))
+            if(!pipeline->reached_eof)
+            {
+                result->offset = pipeline->first_offset + pipeline->next_chunk_to_consume*pipeline->chunk_size;
+                result->size = 0;
+                result->reached_eof = false;
+                result->error = 0;
+                fill_parser_read_chunk(pipeline, result, false);
+                result->is_ready = true;
+            }
+        }break;
+
+        case parser_read_backend_pread_thread:
+        case parser_read_backend_decompress_thread:
         {
-            eat_until_newline(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "o "))
+            pthread_mutex_lock(&pipeline->mutex);
+            while(!result->is_ready && 
+                  !(pipeline->reached_eof && pipeline->next_chunk_to_consume >= pipeline->next_chunk_to_read))
+            {
+                pthread_cond_wait(&pipeline->chunk_changed, &pipeline->mutex);
+            }
+            pthread_mutex_unlock(&pipeline->mutex);
+        }break;
+
+#if PARSER_IO_URING
+        case parser_read_backend_io_uring:
         {
-            eat_until_newline(tokenizer);
-        }
-        else if(*tokenizer->at == '/')
+            while(!result->is_ready && result->is_in_flight)
+            {
+                complete_parser_io_uring_reads(pipeline);
+            }
+        }break;
+#endif
+
+        default:
         {
-            result.type = obj_token_type_slash;
-            eat(tokenizer, 1);
-        }
-        else if(*tokenizer->at == '#')
+            invalid_code_path;
+        }break;
+    }
+
+    if(result->is_ready && result->error)
+    {
+        pipeline->error = result->error;
+    }
+
+    if(!result->is_ready || (result->size == 0 && result->reached_eof))
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+// NOTE(joon) the parser is done with the chunk, so the chunk can be used for the next read
+internal void
+release_parser_read_chunk(ParserReadPipeline *pipeline, ParserReadChunk *chunk)
+{
+    assert(chunk == get_parser_read_chunk(pipeline, pipeline->next_chunk_to_consume));
+
+    switch(pipeline->backend)
+    {
+        case parser_read_backend_read:
         {
-            eat_until_newline(tokenizer);
-        }
-        else if((*tokenizer->at >= '0') && 
-            (*tokenizer->at <= '9'))
+            chunk->is_ready = false;
+            pipeline->reached_eof |= chunk->reached_eof;
+            pipeline->next_chunk_to_consume++;
+        }break;
+
+        case parser_read_backend_pread_thread:
+        case parser_read_backend_decompress_thread:
         {
-            ParseNumericResult parse_result = eat_numeric(tokenizer);
+            pthread_mutex_lock(&pipeline->mutex);
+            chunk->is_ready = false;
+            pipeline->next_chunk_to_consume++;
+            pthread_cond_broadcast(&pipeline->chunk_changed);
+            pthread_mutex_unlock(&pipeline->mutex);
+        }break;
+
+#if PARSER_IO_URING
+        case parser_read_backend_io_uring:
+        {
+            chunk->is_ready = false;
+            pipeline->reached_eof |= chunk->reached_eof;
+            pipeline->next_chunk_to_consume++;
 
-            if(parse_result.is_float)
+            if(!pipeline->reached_eof)
             {
-                result.type = obj_token_type_f32;
-                result.value_f32 = parse_result.value_f32;
+                chunk->offset = pipeline->first_offset + pipeline->next_chunk_to_read*pipeline->chunk_size;
+                chunk->size = 0;
+                chunk->reached_eof = false;
+                chunk->error = 0;
+                pipeline->next_chunk_to_read++;
 
-                if(hyphen_appeared)
-                {
-                    result.value_f32 *= -1.0f;
-                    hyphen_appeared = false;
-                }
+                submit_parser_io_uring_read(pipeline, chunk);
             }
+        }break;
+#endif
 
-            else
-            {
-                result.type = obj_token_type_i32;
-                result.value_i32 = parse_result.value_i32;
+        default:
+        {
+            invalid_code_path;
+        }break;
+    }
+}
 
-                if(hyphen_appeared)
-                {
-                    result.value_i32 *= -1;
-                    hyphen_appeared = false;
-                }
+// NOTE(joon) copies up to size bytes of the file into dest, in the file order. 
+// Returns how many bytes were copied, which is less than size only when the file is over.
+internal size_t
+read_parser_pipeline(ParserReadPipeline *pipeline, u8 *dest, size_t size)
+{
+    size_t result = 0;
+    while(result < size)
+    {
+        if(!pipeline->current_chunk)
+        {
+            pipeline->current_chunk = get_next_parser_read_chunk(pipeline);
+            if(!pipeline->current_chunk)
+            {
+                break;
             }
 
+            pipeline->at = pipeline->current_chunk->memory;
+            pipeline->one_past_end = pipeline->current_chunk->memory + pipeline->current_chunk->size;
         }
-    }
 
-    return result;
-}
+        size_t copy_size = (size_t)(pipeline->one_past_end - pipeline->at);
+        if(copy_size > size - result)
+        {
+            copy_size = size - result;
+        }
+        memcpy(dest + result, pipeline->at, copy_size);
+        pipeline->at += copy_size;
+        result += copy_size;
 
-internal ObjToken
-peek_obj_token(Tokenizer tokenizer)
-{
-    ObjToken result = eat_obj_token(&tokenizer);
+        if(pipeline->at == pipeline->one_past_end)
+        {
+            release_parser_read_chunk(pipeline, pipeline->current_chunk);
+            pipeline->current_chunk = 0;
+        }
+    }
 
     return result;
 }
 
-// TODO(joon): parsing positions and vertex normals work just fine,
-// but havent yet tested with the texture coords. Will do when I have a png loader :)
-// pre_parse returns how many vertices / normals / indices the user needs to allocate.
-internal PreParseObjResult
-pre_parse_obj(u8 *file, size_t file_size)
+// NOTE(joon) waits for the reads that are still going on. The file position of the file descriptor 
+// is not moved(except for the pipes and the decompress pipeline, which use read), 
+// and the chunk buffers stay inside the arena.
+internal void
+end_parser_read_pipeline(ParserReadPipeline *pipeline)
 {
-    assert(file && file_size > 0);
-
-    PreParseObjResult result = {};
-
-    Tokenizer tokenizer = {};
-    tokenizer.at = file;
-    tokenizer.one_past_end = file + file_size;
+    switch(pipeline->backend)
+    {
+        case parser_read_backend_read:
+        {
+        }break;
 
-    b32 v_appeared = false;
-    b32 vn_appeared = false;
-    b32 vt_appeared = false;
+        case parser_read_backend_pread_thread:
+        case parser_read_backend_decompress_thread:
+        {
+            pthread_mutex_lock(&pipeline->mutex);
+            pipeline->is_shutting_down = true;
+            pthread_cond_broadcast(&pipeline->chunk_changed);
+            pthread_mutex_unlock(&pipeline->mutex);
+
+            pthread_join(pipeline->thread, 0);
+            pthread_cond_destroy(&pipeline->chunk_changed);
+            pthread_mutex_destroy(&pipeline->mutex);
+        }break;
+
+#if PARSER_IO_URING
+        case parser_read_backend_io_uring:
+        {
+            end_parser_io_uring(pipeline);
+        }break;
+#endif
 
-    while(tokenizer.at < tokenizer.one_past_end)
-    {
-        ObjToken token = eat_obj_token(&tokenizer);
-        switch(token.type)
+        default:
         {
-            case obj_token_type_v:
-            {
-                result.position_count++;
-                v_appeared = true;
-            }break;
-            case obj_token_type_vn:
-            {
-                result.normal_count++;
-                vn_appeared = true;
-            }break;
-            case obj_token_type_vt:
+            invalid_code_path;
+        }break;
+    }
+
+    ParserDecompressor *decompressor = pipeline->decompressor;
+    if(decompressor && decompressor->state)
+    {
+        switch(decompressor->compression)
+        {
+#if PARSER_ZLIB
+            case parser_compression_gzip:
             {
-                result.texcoord_count++;
-                vt_appeared = true;
+                inflateEnd((z_stream *)decompressor->state);
             }break;
+#endif
 
-            case obj_token_type_f:
+#if PARSER_ZSTD
+            case parser_compression_zstd:
             {
-                u32 number_count = 0;
-                while(1)
-                {
-                    ObjToken t = peek_obj_token(tokenizer);
-
-                    if(t.type == obj_token_type_i32)
-                    {
-                        number_count++;
-                        eat_obj_token(&tokenizer); // actually advance
-                    }
-                    else if(t.type == obj_token_type_slash)
-                    {
-                        eat_obj_token(&tokenizer); // actually advance
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-
-                assert(v_appeared || vt_appeared || vn_appeared);
+                ZSTD_freeDStream((ZSTD_DStream *)decompressor->state);
+            }break;
+#endif
 
-                u32 strip_count = (number_count / (v_appeared + vt_appeared + vn_appeared));
-                result.index_count += 3 * (strip_count - 2);
+            default:
+            {
             }break;
         }
+
+        decompressor->state = 0;
     }
+}
 
-    if(v_appeared)
+// NOTE(joon) moves whatever is left to the start of the window, and fills the rest of the window from the file
+internal void
+refill_parser_stream(ParserStream *stream)
+{
+    size_t leftover_size = (size_t)(stream->one_past_end - stream->at);
+    memmove(stream->window, stream->at, leftover_size);
+    stream->at = stream->window;
+    stream->one_past_end = stream->window + leftover_size;
+
+    u8 *window_end = stream->window + stream->window_size;
+    if(stream->pipeline && !stream->reached_eof && stream->one_past_end < window_end)
     {
-        if(!vt_appeared && !vn_appeared)
+        size_t size = (size_t)(window_end - stream->one_past_end);
+        size_t bytes_read = read_parser_pipeline(stream->pipeline, stream->one_past_end, size);
+        stream->one_past_end += bytes_read;
+        if(bytes_read < size)
         {
-            result.vertex_type = obj_vertex_type_v;
+            stream->reached_eof = true;
+            stream->error = stream->pipeline->error;
         }
-        else if(!vt_appeared && vn_appeared)
+    }
+
+    while(!stream->pipeline && !stream->reached_eof && stream->one_past_end < window_end)
+    {
+        ssize_t bytes_read = read(stream->file_descriptor, stream->one_past_end, (size_t)(window_end - stream->one_past_end));
+        if(bytes_read > 0)
         {
-            result.vertex_type = obj_vertex_type_v_vn;
+            stream->one_past_end += bytes_read;
         }
-        else if(vt_appeared && !vn_appeared)
+        else if(bytes_read == 0 || errno != EINTR)
         {
-            result.vertex_type = obj_vertex_type_v_vt;
+            // NOTE(joon) read errors also end the stream, but the errno is kept so that 
+            // the caller can tell a shorter file from a failed read
+            if(bytes_read < 0)
+            {
+                stream->error = errno;
+            }
+            stream->reached_eof = true;
         }
-        else if(vt_appeared && vn_appeared)
+    }
+}
+
+internal ParserStream
+begin_parser_stream(int file_descriptor, u8 *window, size_t window_size, ParserReadPipeline *pipeline = 0)
+{
+    ParserStream result = {};
+    result.file_descriptor = file_descriptor;
+    result.pipeline = pipeline;
+    result.window = window;
+    result.window_size = window_size;
+    result.at = window;
+    result.one_past_end = window;
+
+    refill_parser_stream(&result);
+
+    return result;
+}
+
+// NOTE(joon) returns the end of the last complete line inside the window. 
+// When the file is over, the last line doesn't need a newline.
+internal u8 *
+get_parser_stream_lines_end(ParserStream *stream)
+{
+    u8 *result = stream->one_past_end;
+    if(!stream->reached_eof)
+    {
+        while(result > stream->at && result[-1] != '\n')
         {
-            result.vertex_type = obj_vertex_type_v_vt_vn;
+            result--;
         }
+
+        // NOTE(joon) the window is full but there is no newline, which means that this line is bigger than the window
+        assert(result > stream->at || stream->at != stream->window);
     }
-    else
+
+    return result;
+}
+
+internal void
+flush_obj_stream_batch(ObjStreamBatch *batch)
+{
+    if(batch->position_count || batch->normal_count || batch->texcoord_count || batch->index_count)
     {
-        invalid_code_path;
+        batch->callback(batch, batch->user_data);
+
+        batch->first_position_index += batch->position_count;
+        batch->first_normal_index += batch->normal_count;
+        batch->first_texcoord_index += batch->texcoord_count;
+        batch->first_index_index += batch->index_count;
+
+        batch->position_count = 0;
+        batch->normal_count = 0;
+        batch->texcoord_count = 0;
+        batch->index_count = 0;
+    }
+}
+
+inline v3 *
+push_obj_stream_position(ObjStreamBatch *batch)
+{
+    if(batch->position_count == obj_stream_batch_count)
+    {
+        flush_obj_stream_batch(batch);
     }
 
+    v3 *result = batch->positions + batch->position_count++;
     return result;
 }
 
-internal void
-parse_obj(PreParseObjResult *pre_parse, u8 *file, u32 file_size, 
-        v3 *positions, v3 *normals, v2 *texcoords, u32 *indices)
+inline v3 *
+push_obj_stream_normal(ObjStreamBatch *batch)
 {
-    assert(file && file_size > 0);
-    assert(pre_parse->vertex_type == obj_vertex_type_v || 
-           pre_parse->vertex_type == obj_vertex_type_v_vn);
+    if(batch->normal_count == obj_stream_batch_count)
+    {
+        flush_obj_stream_batch(batch);
+    }
+
+    v3 *result = batch->normals + batch->normal_count++;
+    return result;
+}
+
+inline v2 *
+push_obj_stream_texcoord(ObjStreamBatch *batch)
+{
+    if(batch->texcoord_count == obj_stream_batch_count)
+    {
+        flush_obj_stream_batch(batch);
+    }
+
+    v2 *result = batch->texcoords + batch->texcoord_count++;
+    return result;
+}
+
+inline void
+push_obj_stream_triangle(ObjStreamBatch *batch, u32 index_0, u32 index_1, u32 index_2)
+{
+    if(batch->index_count + 3 > 3*obj_stream_batch_count)
+    {
+        flush_obj_stream_batch(batch);
+    }
 
+    batch->indices[batch->index_count++] = index_0;
+    batch->indices[batch->index_count++] = index_1;
+    batch->indices[batch->index_count++] = index_2;
+}
+
+// NOTE(joon) same as parse_obj_chunk, but the results go to the batch. 
+// [start, one_past_end) should only contain complete lines.
+internal void
+parse_obj_stream_lines(ObjStreamBatch *batch, u8 *start, u8 *one_past_end)
+{
     Tokenizer tokenizer = {};
-    tokenizer.at = file;
-    tokenizer.one_past_end = file + file_size;
+    tokenizer.at = start;
+    tokenizer.one_past_end = one_past_end;
 
-    u32 position_index = 0;
-    u32 normal_index = 0;
-    u32 index_index = 0;
+    ObjFastLine line;
     while(tokenizer.at < tokenizer.one_past_end)
     {
+        eat_all_whitespaces(&tokenizer);
+
+        u8 *line_end = decode_obj_line_fast(tokenizer.at, tokenizer.one_past_end, &line);
+        if(line_end)
+        {
+            switch(line.type)
+            {
+                case obj_token_type_v:
+                {
+                    v3 *position = push_obj_stream_position(batch);
+                    position->x = line.values[0];
+                    position->y = line.values[1];
+                    position->z = line.values[2];
+                }break;
+
+                case obj_token_type_vn:
+                {
+                    v3 *normal = push_obj_stream_normal(batch);
+                    normal->x = line.values[0];
+                    normal->y = line.values[1];
+                    normal->z = line.values[2];
+                }break;
+
+                case obj_token_type_vt:
+                {
+                    v2 *texcoord = push_obj_stream_texcoord(batch);
+                    texcoord->x = line.values[0];
+                    texcoord->y = (line.value_count >= 2) ? line.values[1] : 0.0f;
+                }break;
+
+                case obj_token_type_f:
+                {
+                    for(u32 corner_index = 2;
+                            corner_index < line.corner_count;
+                            ++corner_index)
+                    {
+                        push_obj_stream_triangle(batch, (u32)line.corners[0].v, 
+                                                 (u32)line.corners[corner_index - 1].v, 
+                                                 (u32)line.corners[corner_index].v);
+                    }
+                }break;
+            }
+
+            tokenizer.at = line_end;
+            continue;
+        }
+
         ObjToken token = eat_obj_token(&tokenizer);
         switch(token.type)
         {
@@ -745,7 +8341,7 @@ parse_obj(PreParseObjResult *pre_parse, u8 *file, u32 file_size,
                 ObjToken p1 = eat_obj_token(&tokenizer);
                 ObjToken p2 = eat_obj_token(&tokenizer);
 
-                v3 *position = positions + position_index++;
+                v3 *position = push_obj_stream_position(batch);
 
                 numeric_obj_token_to_f32(p0, &position->x);
                 numeric_obj_token_to_f32(p1, &position->y);
@@ -758,7 +8354,7 @@ parse_obj(PreParseObjResult *pre_parse, u8 *file, u32 file_size,
                 ObjToken n1 = eat_obj_token(&tokenizer);
                 ObjToken n2 = eat_obj_token(&tokenizer);
 
-                v3 *normal = normals + normal_index++;
+                v3 *normal = push_obj_stream_normal(batch);
 
                 numeric_obj_token_to_f32(n0, &normal->x);
                 numeric_obj_token_to_f32(n1, &normal->y);
@@ -767,240 +8363,497 @@ parse_obj(PreParseObjResult *pre_parse, u8 *file, u32 file_size,
 
             case obj_token_type_vt:
             {
-                // TODO(joon): add support for vt
+                ObjToken t0 = eat_obj_token(&tokenizer);
+
+                v2 *texcoord = push_obj_stream_texcoord(batch);
+                numeric_obj_token_to_f32(t0, &texcoord->x);
+                texcoord->y = 0.0f;
+
+                ObjToken t1 = peek_obj_token(&tokenizer);
+                if(t1.type == obj_token_type_f32 || t1.type == obj_token_type_i32)
+                {
+                    eat_obj_token(&tokenizer);
+                    numeric_obj_token_to_f32(t1, &texcoord->y);
+                }
             }break;
 
             case obj_token_type_f:
             {
-                switch(pre_parse->vertex_type)
+                u32 first_index = 0;
+                u32 previous_index = 0;
+                u32 face_vertex_count = 0;
+                while(1)
                 {
-                    case obj_vertex_type_v:
+                    ObjToken t = peek_obj_token(&tokenizer);
+                    if(t.type != obj_token_type_i32)
                     {
-                        ObjToken i0 = eat_obj_token(&tokenizer);
-                        ObjToken i1 = eat_obj_token(&tokenizer);
-                        ObjToken i2 = eat_obj_token(&tokenizer);
-                        indices[index_index++] = i0.value_i32;
-                        indices[index_index++] = i1.value_i32;
-                        indices[index_index++] = i2.value_i32;
+                        break;
+                    }
+                    eat_obj_token(&tokenizer);
 
-                        while(1)
+                    while(peek_obj_token(&tokenizer).type == obj_token_type_slash)
+                    {
+                        eat_obj_token(&tokenizer);
+                        if(peek_obj_token(&tokenizer).type == obj_token_type_i32)
                         {
-                            ObjToken t = peek_obj_token(tokenizer);
-                            if(t.type == obj_token_type_i32)
-                            {
-                                indices[index_index++] = i0.value_i32;
-                                indices[index_index] = indices[index_index-2];
-                                index_index++;
-                                indices[index_index++] = t.value_i32;
-
-                                eat_obj_token(&tokenizer);
-                            }
-                            else
-                            {
-                                break;
-                            }
+                            eat_obj_token(&tokenizer);
                         }
-                    }break;
-                    case obj_vertex_type_v_vn:
+                    }
+
+                    u32 index = (u32)t.value_i32;
+                    if(face_vertex_count == 0)
                     {
-                        ObjToken i0 = eat_obj_token(&tokenizer);
-                        ObjToken s0 = eat_obj_token(&tokenizer);
-                        ObjToken s1 = eat_obj_token(&tokenizer);
-                        ObjToken vni0 = eat_obj_token(&tokenizer);
+                        first_index = index;
+                    }
+                    else if(face_vertex_count >= 2)
+                    {
+                        push_obj_stream_triangle(batch, first_index, previous_index, index);
+                    }
 
-                        ObjToken i1 = eat_obj_token(&tokenizer);
-                        ObjToken s2 = eat_obj_token(&tokenizer);
-                        ObjToken s3 = eat_obj_token(&tokenizer);
-                        ObjToken vni1 = eat_obj_token(&tokenizer);
+                    previous_index = index;
+                    face_vertex_count++;
+                }
 
-                        ObjToken i2 = eat_obj_token(&tokenizer);
-                        ObjToken s4 = eat_obj_token(&tokenizer);
-                        ObjToken s5 = eat_obj_token(&tokenizer);
-                        ObjToken vni2 = eat_obj_token(&tokenizer);
+                assert(face_vertex_count >= 3);
+            }break;
+        }
+    }
+}
 
-                        indices[index_index++] = i0.value_i32;
-                        indices[index_index++] = i1.value_i32;
-                        indices[index_index++] = i2.value_i32;
+// NOTE(joon) bounded memory version of load_obj, for the files that don't fit in memory. 
+// Only window_size bytes of the file are in memory at once, and partial lines are carried 
+// over to the next refill, so the window should be bigger than the longest line. 
+// Everything that is parsed goes to the callback through the batch. 
+// Returns the same counts that pre_parse_obj would have returned. 
+// If a read failed, batch->read_error is the errno(the counts are what was read before it).
+// If the pipeline is given(see begin_parser_read_pipeline), the next chunks are read while this one is parsed.
+internal PreParseObjResult
+stream_obj(int file_descriptor, u8 *window, size_t window_size, 
+           ObjStreamBatch *batch, obj_stream_callback *callback, void *user_data, ParserReadPipeline *pipeline = 0)
+{
+    PreParseObjResult result = {};
 
-                        //f 304808//304808 304802//304802 304823//304823 
+    batch->callback = callback;
+    batch->user_data = user_data;
+    batch->first_position_index = 0;
+    batch->first_normal_index = 0;
+    batch->first_texcoord_index = 0;
+    batch->first_index_index = 0;
+    batch->position_count = 0;
+    batch->normal_count = 0;
+    batch->texcoord_count = 0;
+    batch->index_count = 0;
+    batch->read_error = 0;
+
+    ParserStream stream = begin_parser_stream(file_descriptor, window, window_size, pipeline);
+    while(stream.at < stream.one_past_end)
+    {
+        u8 *lines_end = get_parser_stream_lines_end(&stream);
+        parse_obj_stream_lines(batch, stream.at, lines_end);
+        stream.at = lines_end;
 
-                        u32 number_count;
-                        while(1)
-                        {
-                            ObjToken t = peek_obj_token(tokenizer);
-                            if(t.type == obj_token_type_i32)
-                            {
-                                if((number_count & 2) == 0)
-                                {
-                                    indices[index_index++] = i0.value_i32;
-                                    indices[index_index] = indices[index_index-2];
-                                    index_index++;
-                                    indices[index_index++] = t.value_i32;
-                                }
+        refill_parser_stream(&stream);
+    }
 
-                                number_count++;
+    flush_obj_stream_batch(batch);
+    batch->read_error = stream.error;
 
-                                eat_obj_token(&tokenizer);
-                            }
-                            else if(t.type == obj_token_type_slash)
-                            {
-                                eat_obj_token(&tokenizer);
-                            }
-                            else
-                            {
-                                break;
-                            }
-                        }
+    result.position_count = batch->first_position_index;
+    result.normal_count = batch->first_normal_index;
+    result.texcoord_count = batch->first_texcoord_index;
+    result.index_count = batch->first_index_index;
+    // NOTE(joon) an empty stream(i.e the compression was not compiled in) keeps the default vertex type
+    if(result.position_count)
+    {
+        result.vertex_type = get_obj_vertex_type(true, 
+                                                 result.texcoord_count > 0, 
+                                                 result.normal_count > 0);
+    }
 
-                    }break;
+    return result;
+}
 
-                    // TODO(joon) implement these!
-                    case obj_vertex_type_v_vt:
-                    {
-                    }break;
-                    case obj_vertex_type_v_vt_vn:
-                    {
-                    }break;
-                }
-            }break;
-        }
+internal void
+flush_ply_stream_batch(ParsePlyHeaderResult *header, PlyStreamBatch *batch)
+{
+    if(batch->vertex_count || batch->index_count)
+    {
+        batch->callback(header, batch, batch->user_data);
+
+        batch->first_vertex_index += batch->vertex_count;
+        batch->first_index_index += batch->index_count;
+
+        batch->vertex_count = 0;
+        batch->index_count = 0;
+    }
+}
+
+// NOTE(joon) returns where the next vertex should be written, flushing the batch if there is no space left
+inline f32 *
+push_ply_stream_vertex(ParsePlyHeaderResult *header, PlyStreamBatch *batch)
+{
+    if((batch->vertex_count + 1)*header->vertex_property_count > ply_stream_batch_value_count)
+    {
+        flush_ply_stream_batch(header, batch);
+    }
+
+    f32 *result = batch->vertices + (size_t)batch->vertex_count*header->vertex_property_count;
+    batch->vertex_count++;
+
+    return result;
+}
+
+inline void
+push_ply_stream_triangle(ParsePlyHeaderResult *header, PlyStreamBatch *batch, u32 index_0, u32 index_1, u32 index_2)
+{
+    if(batch->index_count + 3 > ply_stream_batch_value_count)
+    {
+        flush_ply_stream_batch(header, batch);
+    }
+
+    batch->indices[batch->index_count++] = index_0;
+    batch->indices[batch->index_count++] = index_1;
+    batch->indices[batch->index_count++] = index_2;
+}
+
+// NOTE(joon) moves the stream to the next record, and to the next element(skipping the empty ones) 
+// when the current one is done. element_index == element_count means that the body is done.
+internal void
+advance_ply_stream_records(ParsePlyHeaderResult *header, u32 *element_index, u32 *record_index, u32 record_count)
+{
+    *record_index += record_count;
+    while(*element_index < header->element_count && 
+          *record_index >= header->elements[*element_index].count)
+    {
+        (*element_index)++;
+        *record_index = 0;
     }
 }
 
-#if 0
-internal SceneToken
-eat_scn_token(Tokenizer *tokenizer)
+// NOTE(joon) decodes the ascii lines inside [at, one_past_end), returns where it stopped
+internal u8 *
+stream_ply_ascii_lines(ParsePlyHeaderResult *header, PlyStreamBatch *batch, u8 *at, u8 *one_past_end, 
+                       u32 *element_index, u32 *record_index)
 {
-    SceneToken result = {};
-
-    // NOTE(joon) eat all the unnecessary charcters(whilespace, newline...)
-    eat_all_whitespaces(tokenizer);
+    Tokenizer tokenizer = {};
+    tokenizer.at = at;
+    tokenizer.one_past_end = one_past_end;
 
-    if(tokenizer->at < tokenizer->one_past_end)
+    while(*element_index < header->element_count)
     {
-        if(string_compare((char *)tokenizer->at, "screen"))
-        {
-            result.type = scene_token_type_screen;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "camera"))
-        {
-            result.type = scene_token_type_camera;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "ambient"))
-        {
-            result.type = scene_token_type_ambient;
-            eat_until_whitespace(tokenizer);
-        }
-        else if(string_compare((char *)tokenizer->at, "light"))
+        eat_all_whitespaces(&tokenizer);
+        if(tokenizer.at == tokenizer.one_past_end)
         {
-            result.type = scene_token_type_light;
-            eat_until_whitespace(tokenizer);
+            break;
         }
-        else if(string_compare((char *)tokenizer->at, "sphere"))
+
+        if(header->vertex_count && *element_index == header->vertex_element_index)
         {
-            result.type = scene_token_type_sphere;
-            eat_until_whitespace(tokenizer);
+            f32 *vertex = push_ply_stream_vertex(header, batch);
+            tokenizer.at = parse_ply_vertex_rows_for_schema(header->vertex_schema, tokenizer.at, tokenizer.one_past_end, 
+                                                            1, header->vertex_property_count, vertex);
         }
-        else if(string_compare((char *)tokenizer->at, "brdf"))
+        else if(header->face_count && *element_index == header->face_element_index)
         {
-            result.type = scene_token_type_brdf;
-            eat_until_whitespace(tokenizer);
+            skip_ply_ascii_face_properties_before_indices(&tokenizer, header);
+
+            PlyFastFace face;
+            u8 *row_end = decode_ply_face_row_fast(tokenizer.at, tokenizer.one_past_end, &face);
+            if(row_end)
+            {
+                for(u32 item_index = 2;
+                        item_index < face.index_count;
+                        ++item_index)
+                {
+                    push_ply_stream_triangle(header, batch, face.indices[0], face.indices[item_index - 1], face.indices[item_index]);
+                }
+
+                tokenizer.at = row_end;
+            }
+            else
+            {
+                PlyToken index_count = eat_ply_token(&tokenizer);
+                assert(index_count.type == ply_token_type_i32 &&
+                        index_count.value_i32 >= 3);
+
+                u32 index_0 = eat_ply_token(&tokenizer).value_i32;
+                u32 previous_index = eat_ply_token(&tokenizer).value_i32;
+                for(i32 item_index = 2;
+                        item_index < index_count.value_i32;
+                        ++item_index)
+                {
+                    u32 index = eat_ply_token(&tokenizer).value_i32;
+                    push_ply_stream_triangle(header, batch, index_0, previous_index, index);
+                    previous_index = index;
+                }
+            }
+
+            eat_line(&tokenizer);
         }
-        else if(string_compare((char *)tokenizer->at, "box"))
+        else
         {
-            result.type = scene_token_type_box;
-            eat_until_whitespace(tokenizer);
+            // NOTE(joon) elements that we don't read, one record per line
+            eat_line(&tokenizer);
         }
-        else if(string_compare((char *)tokenizer->at, "cylinder"))
+
+        advance_ply_stream_records(header, element_index, record_index, 1);
+    }
+
+    return tokenizer.at;
+}
+
+// NOTE(joon) decodes as many binary records as there are inside [at, one_past_end), returns where it stopped
+internal u8 *
+stream_ply_binary_records(ParsePlyHeaderResult *header, PlyStreamBatch *batch, u8 *at, u8 *one_past_end, 
+                          u32 *element_index, u32 *record_index)
+{
+    b32 swap = is_ply_byte_swap_needed(header->format);
+    u32 batch_vertex_capacity = ply_stream_batch_value_count/header->vertex_property_count;
+
+    while(*element_index < header->element_count)
+    {
+        PlyElement *element = header->elements + *element_index;
+        if(header->vertex_count && *element_index == header->vertex_element_index)
         {
-            result.type = scene_token_type_cylinder;
-            eat_until_whitespace(tokenizer);
+            u32 vertex_count = element->count - *record_index;
+            size_t records_in_window = (size_t)(one_past_end - at)/header->vertex_stride;
+            if(vertex_count > records_in_window)
+            {
+                vertex_count = (u32)records_in_window;
+            }
+            if(batch->vertex_count == batch_vertex_capacity)
+            {
+                flush_ply_stream_batch(header, batch);
+            }
+            if(vertex_count > batch_vertex_capacity - batch->vertex_count)
+            {
+                vertex_count = batch_vertex_capacity - batch->vertex_count;
+            }
+
+            if(vertex_count == 0)
+            {
+                return at;
+            }
+
+            decode_ply_binary_vertices(at, vertex_count, header, 
+                                       batch->vertices + (size_t)batch->vertex_count*header->vertex_property_count);
+            batch->vertex_count += vertex_count;
+            at += (size_t)vertex_count*header->vertex_stride;
+            advance_ply_stream_records(header, element_index, record_index, vertex_count);
         }
-        else if(string_compare((char *)tokenizer->at, "mesh"))
+        else
         {
-            result.type = scene_token_type_mesh;
-            eat_until_whitespace(tokenizer);
+            size_t record_size = get_ply_binary_record_size(at, one_past_end, element, swap);
+            if(record_size == 0)
+            {
+                return at;
+            }
+
+            if(header->face_count && *element_index == header->face_element_index)
+            {
+                u8 *property_at = at;
+                for(u32 property_index = 0;
+                        property_index < element->property_count;
+                        ++property_index)
+                {
+                    PlyProperty *property = element->properties + property_index;
+                    if(property->list_count_type)
+                    {
+                        u32 count = read_ply_scalar_u32(property_at, property->list_count_type, swap);
+                        property_at += get_ply_scalar_size(property->list_count_type);
+
+                        u32 item_size = get_ply_scalar_size(property->type);
+                        if(property_index == header->face_index_property_index && count >= 3)
+                        {
+                            u32 index_0 = read_ply_scalar_u32(property_at, property->type, swap);
+                            u32 previous_index = read_ply_scalar_u32(property_at + item_size, property->type, swap);
+                            for(u32 item_index = 2;
+                                    item_index < count;
+                                    ++item_index)
+                            {
+                                u32 index = read_ply_scalar_u32(property_at + item_index*item_size, property->type, swap);
+                                push_ply_stream_triangle(header, batch, index_0, previous_index, index);
+                                previous_index = index;
+                            }
+                        }
+
+                        property_at += count*item_size;
+                    }
+                    else
+                    {
+                        property_at += get_ply_scalar_size(property->type);
+                    }
+                }
+            }
+
+            // NOTE(joon) records of the elements that we don't read are just skipped
+            at += record_size;
+            advance_ply_stream_records(header, element_index, record_index, 1);
         }
+    }
+
+    // NOTE(joon) everything is decoded
+    return one_past_end;
+}
+
+// NOTE(joon) bounded memory version of load_ply, works for both ascii and binary. 
+// The header should fit inside the window, and for the ascii files, 
+// the window should be bigger than the longest line. 
+// Returns the header, with index_count filled with how many indices were handed to the callback. 
+// If a read failed, batch->read_error is the errno, same as stream_obj.
+internal ParsePlyHeaderResult
+stream_ply(int file_descriptor, u8 *window, size_t window_size, 
+           PlyStreamBatch *batch, ply_stream_callback *callback, void *user_data, ParserReadPipeline *pipeline = 0)
+{
+    batch->callback = callback;
+    batch->user_data = user_data;
+    batch->first_vertex_index = 0;
+    batch->first_index_index = 0;
+    batch->vertex_count = 0;
+    batch->index_count = 0;
+    batch->read_error = 0;
+
+    ParserStream stream = begin_parser_stream(file_descriptor, window, window_size, pipeline);
+
+    // NOTE(joon) an empty stream(i.e the compression was not compiled in) returns an empty header
+    ParsePlyHeaderResult header = {};
+    if(stream.at < stream.one_past_end)
+    {
+        header = parse_ply_header_elements(stream.at, (size_t)(stream.one_past_end - stream.at));
+        assert(header.header_size); // header is bigger than the window
+        assert(header.vertex_property_count > 0 && 
+               header.vertex_property_count <= ply_stream_batch_value_count);
+        stream.at += header.header_size;
+    }
 
-        else if(*tokenizer->at == 'b' && *(tokenizer->at + 1) == ' ')
+    // NOTE(joon) elements are decoded in the file order, whatever that order is
+    u32 element_index = 0;
+    u32 record_index = 0;
+    advance_ply_stream_records(&header, &element_index, &record_index, 0);
+    while(stream.at < stream.one_past_end && element_index < header.element_count)
+    {
+        if(header.format == ply_format_ascii)
         {
-            // TODO(joon) more solid way to differentiate this with the string that has this letter as a starting character? (i.e box?)
-            result.type = scene_token_type_b;
-            eat_until_whitespace(tokenizer);
+            u8 *lines_end = get_parser_stream_lines_end(&stream);
+            stream.at = stream_ply_ascii_lines(&header, batch, stream.at, lines_end, &element_index, &record_index);
         }
-        else if(*tokenizer->at == 'q' && *(tokenizer->at + 1) == ' ')
+        else
         {
-            result.type = scene_token_type_q;
-            eat_until_whitespace(tokenizer);
+            u8 *previous_at = stream.at;
+            stream.at = stream_ply_binary_records(&header, batch, stream.at, stream.one_past_end, &element_index, &record_index);
+
+            // NOTE(joon) a record that doesn't fit inside the full window will never fit
+            assert(stream.at != previous_at || stream.at != stream.window || stream.reached_eof);
+            if(stream.at == previous_at && stream.reached_eof)
+            {
+                // truncated file
+                break;
+            }
         }
-        else if(*tokenizer->at == 'z' && *(tokenizer->at + 1) == ' ')
+
+        refill_parser_stream(&stream);
+    }
+
+    flush_ply_stream_batch(&header, batch);
+    header.index_count = batch->first_index_index;
+    batch->read_error = stream.error;
+
+    return header;
+}
+
+// NOTE(joon) keywords only match when the whole word matches, so that the file names 
+// that start with the keyword(i.e boxes.obj) are still strings
+internal b32
+is_scn_keyword(Tokenizer *tokenizer, const char *keyword)
+{
+    b32 result = true;
+
+    u8 *at = tokenizer->at;
+    while(*keyword != '\0')
+    {
+        if(at == tokenizer->one_past_end || *at != (u8)*keyword)
         {
-            result.type = scene_token_type_z;
-            eat_until_whitespace(tokenizer);
+            result = false;
+            break;
         }
 
-        // NOTE(joon) This check should happen after the other string checks
-        else if((*tokenizer->at >= 'a' && *tokenizer->at < 'z') || 
-                (*tokenizer->at >= 'A' && *tokenizer->at < 'Z'))
+        at++;
+        keyword++;
+    }
+
+    if(result && at < tokenizer->one_past_end && !is_token_whitespace(*at))
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+global SceneKeyword scene_keywords[] = 
+{
+    {"screen", scene_token_type_screen},
+    {"camera", scene_token_type_camera},
+    {"ambient", scene_token_type_ambient},
+    {"light", scene_token_type_light},
+    {"sphere", scene_token_type_sphere},
+    {"brdf", scene_token_type_brdf},
+    {"box", scene_token_type_box},
+    {"cylinder", scene_token_type_cylinder},
+    {"mesh", scene_token_type_mesh},
+    {"b", scene_token_type_b},
+    {"q", scene_token_type_q},
+    {"z", scene_token_type_z},
+};
+
+internal SceneToken
+eat_scn_token(Tokenizer *tokenizer)
+{
+    SceneToken result = {};
+
+    // NOTE(joon) eat all the unnecessary charcters(whilespace, newline...)
+    eat_all_whitespaces(tokenizer);
+
+    if(tokenizer->at < tokenizer->one_past_end)
+    {
+        for(u32 keyword_index = 0;
+                keyword_index < sizeof(scene_keywords)/sizeof(scene_keywords[0]);
+                ++keyword_index)
         {
-            // string start
-            result.type = scene_token_type_string;
-            result.start = tokenizer->at;
-            eat_until_whitespace(tokenizer);
-            result.value_i32 = tokenizer->at - result.start;
+            if(is_scn_keyword(tokenizer, scene_keywords[keyword_index].name))
+            {
+                result.type = scene_keywords[keyword_index].type;
+                break;
+            }
         }
 
-        else
+        // NOTE(joon) This check should happen after the keyword checks
+        u8 c = *tokenizer->at;
+        if(result.type == scene_token_type_null)
         {
-            b32 hyphen_appeared = false;
-            switch(*tokenizer->at)
+            if((c >= 'a' && c <= 'z') || 
+               (c >= 'A' && c <= 'Z') ||
+               c == '.' || c == '/' || c == '_')
             {
-                case '-':
-                {
-                    hyphen_appeared = true;
-                    tokenizer->at++;
-                };
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
-                {
-                    ParseNumericResult parse_numeric_result = eat_numeric(tokenizer);
-
-                    if(parse_numeric_result.is_float)
-                    {
-                        result.type = scene_token_type_f32;
-                        result.value_f32 = parse_numeric_result.value_f32;
-
-                        if(hyphen_appeared)
-                        {
-                            result.value_f32 *= -1.0f;
-                            hyphen_appeared = false;
-                        }
-                    }
-                    else
-                    {
-                        result.type = scene_token_type_i32;
-                        result.value_i32 = parse_numeric_result.value_i32;
-                        if(hyphen_appeared)
-                        {
-                            result.value_i32 *= -1;
-                            hyphen_appeared = false;
-                        }
-                    }
-                }break;
+                // string start
+                result.type = scene_token_type_string;
+                result.start = tokenizer->at;
+                eat_until_whitespace(tokenizer);
+                result.value_i32 = (i32)(tokenizer->at - result.start);
+            }
+            else if(c == '-' || c == '+' || (c >= '0' && c <= '9'))
+            {
+                ParseNumericResult parse_numeric_result = eat_numeric(tokenizer);
 
-                default:
+                if(parse_numeric_result.is_float)
                 {
-                }break;
+                    result.type = scene_token_type_f32;
+                    result.value_f32 = parse_numeric_result.value_f32;
+                }
+                else
+                {
+                    result.type = scene_token_type_i32;
+                    result.value_i32 = parse_numeric_result.value_i32;
+                }
             }
         }
 
@@ -1010,10 +8863,16 @@ eat_scn_token(Tokenizer *tokenizer)
     return result;
 }
 
+// NOTE(joon) scenes only peek once per brdf, so unlike peek_obj_token / peek_ply_token 
+// this doesn't fill the lookahead, and the next eat parses the token again
 internal SceneToken
-peek_scn_token(Tokenizer tokenizer)
+peek_scn_token(Tokenizer *tokenizer)
 {
-    SceneToken result = eat_scn_token(&tokenizer);
+    Tokenizer peek_tokenizer = {};
+    peek_tokenizer.at = tokenizer->at;
+    peek_tokenizer.one_past_end = tokenizer->one_past_end;
+
+    SceneToken result = eat_scn_token(&peek_tokenizer);
 
     return result;
 }
@@ -1027,19 +8886,207 @@ eat_and_check_scn_token(Tokenizer *tokenizer, SceneTokenType expected_type)
     return result;
 }
 
+// NOTE(joon) numbers like 0 or 255 are written without the '.', so this takes both
+internal f32
+eat_scn_f32(Tokenizer *tokenizer)
+{
+    f32 result = 0.0f;
+
+    SceneToken token = eat_scn_token(tokenizer);
+    if(token.type == scene_token_type_i32)
+    {
+        result = (f32)token.value_i32;
+    }
+    else
+    {
+        assert(token.type == scene_token_type_f32);
+        result = token.value_f32;
+    }
+
+    return result;
+}
+
+internal v3
+eat_scn_v3(Tokenizer *tokenizer)
+{
+    v3 result;
+    result.x = eat_scn_f32(tokenizer);
+    result.y = eat_scn_f32(tokenizer);
+    result.z = eat_scn_f32(tokenizer);
+
+    return result;
+}
+
+internal SceneMeshType
+get_scene_mesh_type(char *file_path)
+{
+    char *extension = 0;
+    for(char *at = file_path;
+            *at != '\0';
+            ++at)
+    {
+        if(*at == '.')
+        {
+            extension = at + 1;
+        }
+        else if(*at == '/')
+        {
+            extension = 0;
+        }
+    }
+
+    SceneMeshType result = scene_mesh_type_obj;
+    if(extension &&
+       (extension[0] | 0x20) == 'p' &&
+       (extension[1] | 0x20) == 'l' &&
+       (extension[2] | 0x20) == 'y' &&
+       extension[3] == '\0')
+    {
+        result = scene_mesh_type_ply;
+    }
+
+    return result;
+}
+
+internal void
+load_scene_mesh_work(void *data)
+{
+    SceneMesh *mesh = (SceneMesh *)data;
+
+    // NOTE(joon) the pool cannot wait for the work from inside the work, 
+    // so one mesh is loaded by one thread, and the meshes are loaded in parallel instead.
+    switch(mesh->type)
+    {
+        case scene_mesh_type_obj:
+        {
+            mesh->obj = load_obj(&mesh->arena, mesh->file_path);
+        }break;
+        case scene_mesh_type_ply:
+        {
+            mesh->ply = load_ply(&mesh->arena, mesh->file_path);
+        }break;
+    }
+}
+
 internal void
-parse_scene(ParseSceneResult *scene, u8 *file, u32 file_size, char *base_file_path)
+add_scene_mesh_slot(SceneMeshTable *table, u64 hash, u32 mesh_index)
 {
-    scene->mat_count = 1; // 0th mat is a default mat 
+    u32 mask = table->slot_count - 1;
+    u32 slot_index = (u32)hash & mask;
+    while(table->slots[slot_index].file_path)
+    {
+        slot_index = (slot_index + 1) & mask;
+    }
+
+    table->slots[slot_index].hash = hash;
+    table->slots[slot_index].file_path = table->file_paths[mesh_index];
+    table->slots[slot_index].mesh_index = mesh_index;
+}
+
+// NOTE(joon) returns the index of the mesh that has the same path, or adds a new one. 
+// added_mesh is only set when the mesh is new.
+internal u32
+find_or_add_scene_mesh(ParserArena *scratch_arena, SceneMeshTable *table, char *file_path, SceneMesh **added_mesh)
+{
+    *added_mesh = 0;
+
+    u64 hash = hash_parser_memory((u8 *)file_path, strlen(file_path));
+    if(table->slots)
+    {
+        u32 mask = table->slot_count - 1;
+        u32 slot_index = (u32)hash & mask;
+        while(table->slots[slot_index].file_path)
+        {
+            SceneMeshSlot *slot = table->slots + slot_index;
+            if(slot->hash == hash && strcmp(slot->file_path, file_path) == 0)
+            {
+                return slot->mesh_index;
+            }
+
+            slot_index = (slot_index + 1) & mask;
+        }
+    }
+
+    u32 mesh_index = table->meshes.total_count;
+    SceneMesh *mesh = push_parser_struct(scratch_arena, SceneMesh);
+    *mesh = {};
+    *(SceneMesh **)push_parser_block_list(scratch_arena, &table->meshes) = mesh;
+    mesh->file_path = file_path;
+    mesh->type = get_scene_mesh_type(file_path);
+
+    // NOTE(joon) keep the load factor under 1/2, the paths are kept in a separate array so that 
+    // the table can be rebuilt without walking the block list
+    if(2*(mesh_index + 1) > table->slot_count)
+    {
+        u32 new_slot_count = table->slot_count ? 2*table->slot_count : 64;
+        char **new_file_paths = push_parser_array(scratch_arena, char *, new_slot_count/2);
+        if(mesh_index)
+        {
+            memcpy(new_file_paths, table->file_paths, sizeof(char *)*mesh_index);
+        }
+
+        table->file_paths = new_file_paths;
+        table->slot_count = new_slot_count;
+        table->slots = push_parser_array(scratch_arena, SceneMeshSlot, new_slot_count);
+        memset(table->slots, 0, sizeof(SceneMeshSlot)*new_slot_count);
+        for(u32 old_mesh_index = 0;
+                old_mesh_index < mesh_index;
+                ++old_mesh_index)
+        {
+            char *old_file_path = table->file_paths[old_mesh_index];
+            add_scene_mesh_slot(table, hash_parser_memory((u8 *)old_file_path, strlen(old_file_path)), old_mesh_index);
+        }
+    }
+
+    table->file_paths[mesh_index] = file_path;
+    add_scene_mesh_slot(table, hash, mesh_index);
+
+    *added_mesh = mesh;
+
+    return mesh_index;
+}
+
+// NOTE(joon) the mesh files are relative to base_file_path. 
+// Each unique mesh file is loaded on the pool as soon as the scene mentions it, 
+// while this thread keeps parsing the rest of the scene, and the same file is only loaded once.
+// There is no limit on how many unique meshes a scene can have : at most parser_max_work_count/2 loads 
+// are queued at once, and then this thread waits for(and helps with) them before it queues more.
+// Everything(including the meshes) is allocated inside the arena.
+internal ParseSceneResult
+parse_scene(ParserArena *arena, u8 *file, size_t file_size, char *base_file_path, ParserThreadPool *pool = 0)
+{
+    ParseSceneResult result = {};
+
+    // NOTE(joon) the lists only live until the final arrays are made
+    ParserArena scratch_arena = begin_parser_sub_arena(arena);
+
+    ParserBlockList spheres;
+    ParserBlockList boxes;
+    ParserBlockList cylinders;
+    ParserBlockList materials;
+    ParserBlockList mesh_infos;
+    init_parser_block_list(&spheres, sizeof(SceneSphere));
+    init_parser_block_list(&boxes, sizeof(SceneBox));
+    init_parser_block_list(&cylinders, sizeof(SceneCylinder));
+    init_parser_block_list(&materials, sizeof(SceneMaterial));
+    init_parser_block_list(&mesh_infos, sizeof(MeshInfo));
+
+    SceneMeshTable mesh_table = {};
+    init_parser_block_list(&mesh_table.meshes, sizeof(SceneMesh *));
+    u32 queued_mesh_count = 0;
+
+    // 0th mat is a default mat 
+    *(SceneMaterial *)push_parser_block_list(&scratch_arena, &materials) = {};
 
     Tokenizer tokenizer = {};
     tokenizer.at = file;
     tokenizer.one_past_end = file + file_size;
     
-    while(tokenizer.at != tokenizer.one_past_end)
+    while(tokenizer.at < tokenizer.one_past_end)
     {
         SceneToken token = eat_scn_token(&tokenizer);
 
+        u32 mat_index = materials.total_count - 1;
         switch(token.type)
         {
             case scene_token_type_screen:
@@ -1048,119 +9095,82 @@ parse_scene(ParseSceneResult *scene, u8 *file, u32 file_size, char *base_file_pa
                 SceneToken output_width = eat_and_check_scn_token(&tokenizer, scene_token_type_i32);
                 SceneToken output_height = eat_and_check_scn_token(&tokenizer, scene_token_type_i32);
 
-                scene->output_width = output_width.value_i32;
-                scene->output_height = output_height.value_i32;
+                result.output_width = output_width.value_i32;
+                result.output_height = output_height.value_i32;
             }break;
             case scene_token_type_camera:
             {
                 // syntax: camera x y z   ry   <orientation spec>
-                SceneToken p_x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken p_y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken p_z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken b = eat_and_check_scn_token(&tokenizer, scene_token_type_b);
-                SceneToken height_ratio = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken q = eat_and_check_scn_token(&tokenizer, scene_token_type_q);
-
-                SceneToken orientation_w = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken orientation_x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken orientation_y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken orientation_z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-
-                scene->camera_p = v3_(p_x.value_f32, p_y.value_f32, p_z.value_f32);
-                scene->camera_height_ratio = height_ratio.value_f32;
-                scene->camera_quarternion = v4_(orientation_x.value_f32, orientation_y.value_f32, orientation_z.value_f32, orientation_w.value_f32);
+                result.camera_p = eat_scn_v3(&tokenizer);
+                eat_and_check_scn_token(&tokenizer, scene_token_type_b);
+                result.camera_height_ratio = eat_scn_f32(&tokenizer);
+                eat_and_check_scn_token(&tokenizer, scene_token_type_q);
+
+                result.camera_quarternion.w = eat_scn_f32(&tokenizer);
+                result.camera_quarternion.x = eat_scn_f32(&tokenizer);
+                result.camera_quarternion.y = eat_scn_f32(&tokenizer);
+                result.camera_quarternion.z = eat_scn_f32(&tokenizer);
             }break;
             case scene_token_type_ambient:
             {
                 // syntax: ambient r g b
-                SceneToken r = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken g = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken b = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-
-                scene->ambient = v3_(r.value_f32, g.value_f32, b.value_f32);
+                result.ambient = eat_scn_v3(&tokenizer);
             }break;
             case scene_token_type_light:
             {
                 // syntax: light  r g b   
-                SceneToken r = eat_and_check_scn_token(&tokenizer, scene_token_type_i32);
-                SceneToken g = eat_and_check_scn_token(&tokenizer, scene_token_type_i32);
-                SceneToken b = eat_and_check_scn_token(&tokenizer, scene_token_type_i32);
-                
-                Material *mat = scene->materials + scene->mat_count++;
-                mat->emissive_color = v3_(r.value_i32, g.value_i32, b.value_i32);
+                SceneMaterial *mat = (SceneMaterial *)push_parser_block_list(&scratch_arena, &materials);
+                *mat = {};
+                mat->emissive_color = eat_scn_v3(&tokenizer);
             }break;
             case scene_token_type_sphere:
             {
                 // syntax: sphere x y z   r
-                SceneToken x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken r = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-
-                Sphere *sphere = scene->spheres + scene->sphere_count++;
-                sphere->p = v3_(x.value_f32, y.value_f32, z.value_f32);
-                sphere->r = r.value_f32;
-                sphere->mat_index = scene->mat_count - 1;
+                SceneSphere *sphere = (SceneSphere *)push_parser_block_list(&scratch_arena, &spheres);
+                sphere->p = eat_scn_v3(&tokenizer);
+                sphere->r = eat_scn_f32(&tokenizer);
+                sphere->mat_index = mat_index;
             }break;
             case scene_token_type_brdf:
             {
                 // syntax: brdf  r g b   r g b  alpha
                 // later:  brdf  r g b   r g b  alpha  r g b ior
-                SceneToken diffuse_r = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken diffuse_g = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken diffuse_b = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-
-                SceneToken specular_r = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken specular_g = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken specular_b = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken specular_a = eat_and_check_scn_token(&tokenizer, scene_token_type_i32);
-
-                SceneToken check = peek_scn_token(tokenizer);
+                SceneMaterial *mat = (SceneMaterial *)push_parser_block_list(&scratch_arena, &materials);
+                *mat = {};
+                mat->diffuse = eat_scn_v3(&tokenizer);
+                v3 specular = eat_scn_v3(&tokenizer);
+                mat->specular.x = specular.x;
+                mat->specular.y = specular.y;
+                mat->specular.z = specular.z;
+                mat->specular.w = eat_scn_f32(&tokenizer);
+
+                SceneToken check = peek_scn_token(&tokenizer);
                 if(check.type == scene_token_type_f32 || check.type == scene_token_type_i32)
                 {
                     // TODO(joon) This will be used when we start to use the proper brdf equation!
-                    SceneToken ignored_0 = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                    SceneToken ignored_1 = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                    SceneToken ignored_2 = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                    SceneToken ignored_3 = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
+                    eat_scn_v3(&tokenizer);
+                    eat_scn_f32(&tokenizer);
                 }
-
-                Material *mat = scene->materials + scene->mat_count++;
-                mat->diffuse = v3_(diffuse_r.value_f32, diffuse_g.value_f32, diffuse_b.value_f32);
-                mat->specular = v4_(specular_r.value_f32, specular_g.value_f32, specular_b.value_f32, specular_a.value_f32);
             }break;
             case scene_token_type_box:
-            
             {
                 // syntax: box bx by bz   dx dy dz
-                SceneToken min_x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken min_y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken min_z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken max_x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken max_y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken max_z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-
-                Box *box = scene->boxes + scene->box_count++;
-                box->min = v3_(min_x.value_f32, min_y.value_f32, min_z.value_f32);
-                box->max = box->min + v3_(max_x.value_f32, max_y.value_f32, max_z.value_f32);
-                box->mat_index = scene->mat_count - 1;
+                SceneBox *box = (SceneBox *)push_parser_block_list(&scratch_arena, &boxes);
+                box->min = eat_scn_v3(&tokenizer);
+                v3 dim = eat_scn_v3(&tokenizer);
+                box->max.x = box->min.x + dim.x;
+                box->max.y = box->min.y + dim.y;
+                box->max.z = box->min.z + dim.z;
+                box->mat_index = mat_index;
             }break;
             case scene_token_type_cylinder:
             {
                 // syntax: cylinder bx by bz   ax ay az  r
-                SceneToken base_x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken base_y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken base_z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken axis_x = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken axis_y = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken axis_z = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-                SceneToken r = eat_and_check_scn_token(&tokenizer, scene_token_type_f32);
-
-                Cylinder *cylinder = scene->cylinders + scene->cylinder_count++;
-                cylinder->base = v3_(base_x.value_f32, base_y.value_f32, base_z.value_f32);
-                cylinder->axis = v3_(axis_x.value_f32, axis_y.value_f32, axis_z.value_f32);
-                cylinder->r = r.value_f32;
-                cylinder->mat_index = scene->mat_count - 1;
+                SceneCylinder *cylinder = (SceneCylinder *)push_parser_block_list(&scratch_arena, &cylinders);
+                cylinder->base = eat_scn_v3(&tokenizer);
+                cylinder->axis = eat_scn_v3(&tokenizer);
+                cylinder->r = eat_scn_f32(&tokenizer);
+                cylinder->mat_index = mat_index;
             }break;
             case scene_token_type_mesh:
             {
@@ -1168,21 +9178,98 @@ parse_scene(ParseSceneResult *scene, u8 *file, u32 file_size, char *base_file_pa
                 // syntax: mesh   filename   tx ty tz   s   <orientation>
                 SceneToken file_name = eat_and_check_scn_token(&tokenizer, scene_token_type_string);
 
-                MeshInfo *mesh_info = scene->mesh_infos + scene->mesh_count++;
+                MeshInfo *mesh_info = (MeshInfo *)push_parser_block_list(&scratch_arena, &mesh_infos);
 
-                // TODO(joon) We can just not do it this way, and just store the file start & end
-                u32 file_path_size = 256;
-                mesh_info->file_path =(char *)malloc(sizeof(char) * file_path_size);
-                zero_memory((void *)mesh_info->file_path, file_path_size);
+                u32 file_path_size = (u32)strlen(base_file_path) + file_name.value_i32 + 1;
+                mesh_info->file_path = push_parser_array(arena, char, file_path_size);
+                memset(mesh_info->file_path, 0, file_path_size);
                 unsafe_string_append(mesh_info->file_path, base_file_path);
                 unsafe_string_append(mesh_info->file_path, (char *)file_name.start, file_name.value_i32);
 
-                mesh_info->mat_index = scene->mat_count - 1;
+                SceneMesh *added_mesh;
+                mesh_info->mesh_index = find_or_add_scene_mesh(&scratch_arena, &mesh_table, mesh_info->file_path, &added_mesh);
+                mesh_info->mat_index = mat_index;
+
+                if(added_mesh)
+                {
+                    // NOTE(joon) the ring buffer of the pool has a limit, so wait for the queued ones once in a while
+                    if(queued_mesh_count == parser_max_work_count/2)
+                    {
+                        complete_all_parser_work(pool);
+                        queued_mesh_count = 0;
+                    }
+
+                    added_mesh->arena = begin_parser_sub_arena(arena);
+                    add_parser_work(pool, load_scene_mesh_work, added_mesh);
+                    queued_mesh_count++;
+                }
+            }break;
+
+            default:
+            {
             }break;
         }
     }
+    complete_all_parser_work(pool);
+
+    result.sphere_count = spheres.total_count;
+    result.box_count = boxes.total_count;
+    result.cylinder_count = cylinders.total_count;
+    result.mat_count = materials.total_count;
+    result.mesh_count = mesh_infos.total_count;
+    result.unique_mesh_count = mesh_table.meshes.total_count;
+
+    result.spheres = push_parser_array(arena, SceneSphere, result.sphere_count);
+    result.boxes = push_parser_array(arena, SceneBox, result.box_count);
+    result.cylinders = push_parser_array(arena, SceneCylinder, result.cylinder_count);
+    result.materials = push_parser_array(arena, SceneMaterial, result.mat_count);
+    result.mesh_infos = push_parser_array(arena, MeshInfo, result.mesh_count);
+    result.meshes = push_parser_array(arena, SceneMesh, result.unique_mesh_count);
+
+    copy_parser_block_list(&spheres, result.spheres);
+    copy_parser_block_list(&boxes, result.boxes);
+    copy_parser_block_list(&cylinders, result.cylinders);
+    copy_parser_block_list(&materials, result.materials);
+    copy_parser_block_list(&mesh_infos, result.mesh_infos);
+
+    SceneMesh *mesh = result.meshes;
+    for(ParserBlock *block = mesh_table.meshes.first;
+            block;
+            block = block->next)
+    {
+        SceneMesh **block_meshes = (SceneMesh **)(block + 1);
+        for(u32 i = 0;
+                i < block->count;
+                ++i)
+        {
+            // NOTE(joon) the mesh data now belongs to the arena, and merging also zeroes the scratch mesh's 
+            // sub-arena, so neither the scratch mesh nor the result keeps pointing at the merged blocks
+            merge_parser_sub_arena(arena, &block_meshes[i]->arena);
+            *mesh = *block_meshes[i];
+            assert(!mesh->arena.base);
+            mesh++;
+        }
+    }
+
+    free_parser_arena(&scratch_arena);
+
+    return result;
+}
+
+internal ParseSceneResult
+parse_scene(ParserArena *arena, char *path, char *base_file_path, ParserThreadPool *pool = 0)
+{
+    ParseSceneResult result = {};
+
+    ParserMappedFile file = map_parser_file(path);
+    if(file.memory)
+    {
+        result = parse_scene(arena, file.memory, file.size, base_file_path, pool);
+        unmap_parser_file(&file);
+    }
+
+    return result;
 }
-#endif
 
 
 
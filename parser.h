@@ -1,6 +1,8 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <pthread.h>
+
 struct ParseNumericResult
 {
     b32 is_float;
@@ -66,6 +68,8 @@ enum PlyTokenType
 
     ply_token_type_format,
     ply_token_type_ascii,
+    ply_token_type_binary_little_endian,
+    ply_token_type_binary_big_endian,
 
     // skip to next newline
     ply_token_type_comment,
@@ -95,6 +99,14 @@ enum PlyTokenType
     ply_token_type_int16,
     ply_token_type_int,
     ply_token_type_int32,
+    ply_token_type_char,
+    ply_token_type_int8,
+    ply_token_type_ushort,
+    ply_token_type_short,
+    ply_token_type_uint,
+    ply_token_type_uint32,
+    ply_token_type_double,
+    ply_token_type_float64,
 
     // values
     ply_token_type_f32,
@@ -112,21 +124,1049 @@ struct PlyToken
     };
 };
 
+enum PlyFormat
+{
+    ply_format_ascii,
+    ply_format_binary_little_endian,
+    ply_format_binary_big_endian,
+};
+
+enum PlyScalarType
+{
+    ply_scalar_type_null,
+
+    ply_scalar_type_i8,
+    ply_scalar_type_u8,
+    ply_scalar_type_i16,
+    ply_scalar_type_u16,
+    ply_scalar_type_i32,
+    ply_scalar_type_u32,
+    ply_scalar_type_f32,
+    ply_scalar_type_f64,
+};
+
+#define ply_max_name_length 24
+struct PlyProperty
+{
+    // if this is a list, this is the type of each item
+    PlyScalarType type;
+
+    // ply_scalar_type_null if this property is not a list
+    PlyScalarType list_count_type;
+
+    char name[ply_max_name_length]; // null terminated, cut if it was longer
+};
+
+#define ply_max_property_count 32
+struct PlyElement
+{
+    char name[ply_max_name_length];
+    u32 count;
+
+    PlyProperty properties[ply_max_property_count];
+    u32 property_count;
+
+    // size of one binary record, 0 if there is a list(then every record can have a different size)
+    u32 stride;
+
+    // where the records of this element are, from the start of the file. 
+    // Only filled by parse_ply_header, because the ascii records and the binary records with the lists 
+    // can only be found by walking the body.
+    u64 body_offset;
+    u64 body_size;
+};
+
+// NOTE(joon) vertex property lists that have their own row decoders(see parse_ply_vertex_rows_for_schema).
+// Names and types should match exactly, everything else is generic.
+enum PlyVertexSchema
+{
+    ply_vertex_schema_generic,
+
+    ply_vertex_schema_xyz, // float x y z
+    ply_vertex_schema_xyz_normal, // float x y z nx ny nz
+    ply_vertex_schema_xyz_confidence_intensity, // float x y z confidence intensity
+    ply_vertex_schema_xyz_rgb, // float x y z, uchar red green blue
+    ply_vertex_schema_xyz_rgba, // float x y z, uchar red green blue alpha
+};
+
+#define ply_max_element_count 8
 struct ParsePlyHeaderResult
 {
+    PlyFormat format;
+
+    // the body starts right after this
+    u32 header_size;
+
+    // every element in the order that they appear inside the file, including the ones that the loaders skip
+    PlyElement elements[ply_max_element_count];
+    u32 element_count;
+
+    // NOTE(joon) the vertex and the face elements are the only ones that the loaders read. 
+    // If the file doesn't have one of them, the counts below are 0(and the index is not meaningful).
+    u32 vertex_element_index;
     u32 vertex_count;
     u32 vertex_property_count;
+    // size of one vertex record, only meaningful for the binary formats
+    u32 vertex_stride;
+    PlyVertexSchema vertex_schema;
 
-    u32 index_count;
+    u32 face_element_index;
+    u32 face_count;
+    u32 face_property_count;
+    // the first list of the face element, which is the vertex indices(the properties before it are skipped)
+    u32 face_index_property_index;
+
+    u32 index_count; // after the fan triangulation
+    u32 polygon_index_count; // before the triangulation, sum of the corners of every face
+
+    // the binary body ended in the middle of a record, every count above is 0 so the loaders give an empty mesh
+    b32 is_truncated;
+};
+
+enum TokenizerLookaheadType
+{
+    tokenizer_lookahead_type_null,
+    tokenizer_lookahead_type_obj,
+    tokenizer_lookahead_type_ply,
 };
 
 struct Tokenizer
 {
     u8 *at;
     u8 *one_past_end;
+
+    // NOTE(joon) one token lookahead. peek_obj_token / peek_ply_token keep the token that they parsed here, 
+    // so that the eat that usually follows at the same position doesn't parse it again. 
+    // Only valid while at and one_past_end are still the same as when it was peeked.
+    TokenizerLookaheadType lookahead_type;
+    u8 *lookahead_at;
+    u8 *lookahead_one_past_end;
+    u8 *lookahead_next_at; // where at goes after eating the token
+    union
+    {
+        ObjToken lookahead_obj;
+        PlyToken lookahead_ply;
+    };
+};
+
+// NOTE(joon) simple bump allocator. When the current block is full, 
+// the arena mallocs a new block and keeps the previous one in a footer, 
+// so everything can be freed at once with free_parser_arena.
+// The first block can also be a memory that the caller owns(see init_parser_arena), 
+// so that a whole load fits inside one region when the caller knows the size.
+// Only the load_* entry points take the arena. pre_parse_obj / parse_obj / parse_ply_header / parse_ply 
+// still write into the buffers that the caller sized from the counts, so the callers that manage 
+// their own memory keep working, and the load_* wrappers are the ones that push those buffers into the arena.
+struct ParserArena
+{
+    u8 *base;
+    size_t size;
+    size_t used;
+
+    // if 0, default_parser_arena_block_size will be used
+    size_t minimum_block_size;
+    u32 block_count;
+
+    // the block that was given by the caller, free_parser_arena never frees this one
+    u8 *external_base;
+
+    // NOTE(joon) per-thread arena of a parallel loader(see begin_parser_sub_arena). 
+    // The sub-arena never locks anything when it pushes, but every block it gets or frees 
+    // is also counted in the parent, so the parent's peak includes the sub-arenas that were alive at the same time.
+    ParserArena *parent;
+
+    // bytes that this arena and its sub-arenas are holding right now, and the highest it has ever been. 
+    // Updated atomically, because the sub-arenas can be on the other threads.
+    size_t reserved_size;
+    size_t peak_reserved_size;
+};
+
+struct ParserArenaFooter
+{
+    u8 *base;
+    size_t size;
+    size_t used;
+};
+
+struct ParserArenaStats
+{
+    u32 block_count;
+
+    // bytes that were pushed into this arena(including the alignment)
+    size_t used_size;
+
+    // bytes that the blocks of this arena and its live sub-arenas are holding, and the highest it has ever been
+    size_t reserved_size;
+    size_t peak_reserved_size;
+};
+
+// NOTE(joon) growable array that lives inside the arena. 
+// Elements are stored in a linked list of blocks, so pushing never moves the 
+// previously pushed elements, and the final contiguous array can be made with 
+// one copy when the total count is known.
+struct ParserBlock
+{
+    ParserBlock *next;
+    u32 count;
+    u32 capacity;
+
+    // data follows
+};
+
+struct ParserBlockList
+{
+    ParserBlock *first;
+    ParserBlock *last;
+
+    u32 element_size;
+    u32 total_count;
+};
+
+// NOTE(joon) the parser never creates threads by itself. 
+// The caller starts the pool once and passes it to the parallel entry points, 
+// and the thread that waits for the work also helps with it.
+// The pool has a single owner : complete_all_parser_work waits for every work that was added to the pool, 
+// so only one thread at a time should add the work and wait for it. 
+// Two loads that run on different threads at the same time need two pools.
+typedef void parser_work_callback(void *data);
+
+struct ParserWork
+{
+    parser_work_callback *callback;
+    void *data;
+};
+
+#define parser_max_thread_count 256
+#define parser_max_work_count 4096
+// get_parser_chunk_count never returns more than this
+#define parser_max_chunk_count (4*(parser_max_thread_count + 1))
+struct ParserThreadPool
+{
+    pthread_t threads[parser_max_thread_count];
+    u32 thread_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work_added;
+    pthread_cond_t work_completed;
+
+    // ring buffer
+    ParserWork works[parser_max_work_count];
+    u32 next_work_to_read;
+    u32 next_work_to_write;
+
+    u32 completion_goal;
+    u32 completion_count;
+
+    b32 is_shutting_down;
+};
+
+// NOTE(joon) bounds and centroid of the positions, made by the loaders while they still have the vertices 
+// (see add_parser_mesh_stats_position / accumulate_ply_vertex_stats) instead of another pass over the result. 
+// Each chunk has its own, and they are merged after the chunks are done.
+struct ParserMeshStats
+{
+    v3 min;
+    v3 max;
+    v3 centroid;
+    u64 position_count;
+
+    // f64 so that the centroid of a big mesh doesn't drift, finish_parser_mesh_stats makes the centroid from it
+    f64 position_sum[3];
+};
+
+// NOTE(joon) one face vertex, as written in the file(1 based, 0 if it's not there)
+struct ObjCorner
+{
+    i32 v;
+    i32 vt;
+    i32 vn;
+};
+
+// NOTE(joon) one v / vn / vt / f line, decoded by decode_obj_line_fast
+#define obj_fast_line_max_corner_count 32
+struct ObjFastLine
+{
+    ObjTokenType type;
+
+    // v, vn, vt
+    f32 values[4];
+    u32 value_count;
+
+    // f
+    ObjCorner corners[obj_fast_line_max_corner_count];
+    u32 corner_count;
+};
+
+// NOTE(joon) result of parsing a range of an obj file in one pass.
+// Indices are already fan-triangulated, and only hold the position indices
+// (same as parse_obj)
+struct ObjChunk
+{
+    ParserBlockList positions; // v3
+    ParserBlockList normals; // v3
+    ParserBlockList texcoords; // v2
+    ParserBlockList indices; // u32
+
+    // if weld is true, faces are stored as (fan triangulated) corners instead of the indices
+    b32 weld;
+    ParserBlockList corners; // ObjCorner
+
+    // if keep_polygons is true, indices are the polygon corners as they were in the file(not triangulated), 
+    // and the number of corners of each face goes here
+    b32 keep_polygons;
+    ParserBlockList face_sizes; // u32
+
+    u32 texcoord_count;
+
+    b32 v_appeared;
+    b32 vn_appeared;
+    b32 vt_appeared;
+
+    // if compute_stats is true, the positions are added to the stats as they are parsed
+    b32 compute_stats;
+    b32 normalize_normals;
+    ParserMeshStats stats;
+};
+
+// NOTE(joon) one work item of the parallel obj loader
+struct ObjChunkWork
+{
+    // each chunk has its own arena, so that the threads don't need to lock anything
+    ParserArena arena;
+    ObjChunk chunk;
+
+    u8 *start;
+    u8 *one_past_end;
+
+    // where this chunk's data should go inside the final arrays
+    v3 *positions;
+    v3 *normals;
+    v2 *texcoords;
+    u32 *indices;
+
+    // used by load_obj_polygons, where this chunk's faces start inside the polygon offsets, 
+    // and where its indices start inside the polygon indices
+    u32 *face_offsets;
+    u32 first_index;
+
+    // used by load_obj_welded, everything is allocated inside the chunk arena
+    u32 *local_indices; // one per corner, index to the local_uniques
+    ObjCorner *local_uniques;
+    u32 local_unique_count;
+    u32 *local_to_global;
+};
+
+struct ObjWeldSlot
+{
+    // v == 0 means that the slot is empty
+    ObjCorner key;
+    u32 value;
+};
+
+// NOTE(joon) one ascii face row, decoded by decode_ply_face_row_fast
+#define ply_fast_face_max_index_count 32
+struct PlyFastFace
+{
+    u32 indices[ply_fast_face_max_index_count];
+    u32 index_count;
+};
+
+// NOTE(joon) output vertex layout for load_ply_with_layout / load_obj_welded_with_layout.
+// Each attribute picks where it reads from, what it becomes, and where it goes,
+// so the same descriptor can describe SoA streams(one buffer per attribute),
+// one interleaved struct, or anything in between.
+#define parser_max_vertex_attribute_count 16
+#define parser_max_vertex_buffer_count 8
+#define parser_vertex_offset_append 0xffffffff
+
+enum ParserVertexFormat
+{
+    parser_vertex_format_f32,
+    parser_vertex_format_f16,
+    parser_vertex_format_snorm16, // [-1, 1] -> [-32767, 32767], for the normals
+    parser_vertex_format_unorm8, // [0, 1] -> [0, 255], for the colors
+};
+
+// NOTE(joon) where each attribute of ObjVertex starts, in f32s
+enum ObjVertexSource
+{
+    obj_vertex_source_position = 0,
+    obj_vertex_source_normal = 3,
+    obj_vertex_source_texcoord = 6,
+};
+
+struct ParserVertexAttribute
+{
+    // ply : index of the first vertex property, obj : one of the ObjVertexSource
+    u32 source;
+    u32 component_count; // 1 ~ 4, read from source, source + 1...
+    ParserVertexFormat format;
+    f32 scale; // multiplied before the conversion(i.e 1/255 for uchar colors), 0 means 1
+
+    // attributes with the same buffer_index are interleaved inside the same buffer
+    u32 buffer_index;
+    u32 offset; // in bytes, from the start of the vertex
+};
+
+struct ParserVertexLayout
+{
+    ParserVertexAttribute attributes[parser_max_vertex_attribute_count];
+    u32 attribute_count;
+
+    // in bytes, 0 means tightly packed(the end of the last attribute in that buffer)
+    u32 strides[parser_max_vertex_buffer_count];
+};
+
+struct ParserVertexBuffers
+{
+    // all of these are allocated inside the arena that was passed to the loader
+    u8 *buffers[parser_max_vertex_buffer_count];
+    u32 strides[parser_max_vertex_buffer_count];
+    u32 buffer_count;
+
+    u32 vertex_count;
+};
+
+// NOTE(joon) where the positions and the normals are inside a vertex row, see get_ply_vertex_stats_info
+struct PlyVertexStatsInfo
+{
+    u32 vertex_property_count;
+
+    b32 has_positions; // x y z
+    u32 positions[3];
+
+    b32 normalize_normals; // nx ny nz, only if the caller asked for it and the file has them
+    u32 normals[3];
+};
+
+// NOTE(joon) one work item of the parallel ply vertex decoder
+struct PlyVertexChunkWork
+{
+    u8 *start;
+    u8 *one_past_end;
+
+    u64 newline_count;
+
+    // how many vertices are inside this chunk, and where they should go
+    u32 row_count;
+    u32 vertex_property_count;
+    PlyVertexSchema vertex_schema;
+    f32 *vertices;
+
+    // if the layout is given, the rows are converted into layout_vertices right away(starting from first_vertex), 
+    // and vertices is not used
+    ParserVertexLayout *layout;
+    ParserVertexBuffers *layout_vertices;
+    u32 first_vertex;
+
+    // where the decoding stopped, the last chunk with the vertices will point to the start of the faces
+    u8 *rows_end;
+
+    // if stats_info is given, this chunk's rows go into the stats right after they are decoded
+    PlyVertexStatsInfo *stats_info;
+    ParserMeshStats stats;
+};
+
+// NOTE(joon) one work item of the parallel binary ply vertex decoder
+struct PlyBinaryVertexChunkWork
+{
+    u8 *records;
+    u32 vertex_count;
+
+    ParsePlyHeaderResult *header;
+    f32 *vertices;
+
+    // same as PlyVertexChunkWork
+    ParserVertexLayout *layout;
+    ParserVertexBuffers *layout_vertices;
+    u32 first_vertex;
+
+    PlyVertexStatsInfo *stats_info;
+    ParserMeshStats stats;
+};
+
+// NOTE(joon) faces as they were in the file, without the triangulation(compressed sparse row). 
+// Face i uses indices[offsets[i]] ~ indices[offsets[i + 1] - 1], 
+// so a quad mesh needs 4 indices per face instead of 6. See triangulate_parser_polygons.
+struct ParserPolygons
+{
+    u32 *offsets; // face_count + 1, offsets[face_count] == index_count
+    u32 *indices;
+
+    u32 face_count;
+    u32 index_count;
+};
+
+// NOTE(joon) one work item of triangulate_parser_polygons, a range of faces
+struct ParserTriangulateWork
+{
+    ParserPolygons *polygons;
+    u32 first_face;
+    u32 face_count;
+
+    u32 *indices; // where the triangles of this range go
+};
+
+struct LoadObjResult
+{
+    // same counts that pre_parse_obj would have returned
+    PreParseObjResult counts;
+
+    // all of these are allocated inside the arena that was passed to load_obj
+    v3 *positions;
+    v3 *normals;
+    v2 *texcoords;
+    u32 *indices;
+};
+
+// NOTE(joon) GPU ready vertex, attributes that are not in the file are 0
+struct ObjVertex
+{
+    v3 p;
+    v3 normal;
+    v2 texcoord;
+};
+
+// NOTE(joon) one work item of the last pass of load_obj_welded, 
+// fills the vertices for a range of the unique corners
+struct ObjWeldVertexWork
+{
+    ObjCorner *corners;
+    u32 count;
+
+    LoadObjResult *attributes;
+    ObjVertex *vertices;
+
+    // same as PlyVertexChunkWork
+    ParserVertexLayout *layout;
+    ParserVertexBuffers *layout_vertices;
+    u32 first_vertex;
+};
+
+struct LoadObjWeldedResult
+{
+    ObjVertexType vertex_type;
+
+    // unique (v, vt, vn) combinations, in the order that they first appeared
+    ObjVertex *vertices;
+    u32 vertex_count;
+
+    // 0 based, 3 per triangle
+    u32 *indices;
+    u32 index_count;
+};
+
+struct LoadPlyResult
+{
+    ParsePlyHeaderResult header;
+
+    // all of these are allocated inside the arena that was passed to load_ply
+    f32 *vertices; // vertex_count x vertex_property_count
+    u32 *indices;
+};
+
+struct LoadObjPolygonsResult
+{
+    // same as pre_parse_obj, except that index_count is polygons.index_count
+    PreParseObjResult counts;
+
+    // all of these are allocated inside the arena that was passed to load_obj_polygons
+    v3 *positions;
+    v3 *normals;
+    v2 *texcoords;
+    ParserPolygons polygons; // same indices as load_obj(1 based positions)
+};
+
+struct LoadPlyPolygonsResult
+{
+    ParsePlyHeaderResult header;
+
+    // all of these are allocated inside the arena that was passed to load_ply_polygons
+    f32 *vertices; // vertex_count x vertex_property_count
+    ParserPolygons polygons;
+};
+
+struct LoadPlyLayoutResult
+{
+    ParsePlyHeaderResult header;
+
+    ParserVertexBuffers vertices;
+    u32 *indices;
+};
+
+struct LoadObjWeldedLayoutResult
+{
+    ObjVertexType vertex_type;
+
+    // same vertices and indices as load_obj_welded, but inside the layout
+    ParserVertexBuffers vertices;
+    u32 *indices;
+    u32 index_count;
+};
+
+// NOTE(joon) read only view of a whole file. 
+// Every mapping of the same file shares the same physical pages(page cache), 
+// and nothing is copied until the parser actually touches the memory.
+struct ParserMappedFile
+{
+    u8 *memory;
+    size_t size;
+};
+
+// NOTE(joon) SAH binned bvh over the triangles of a loaded mesh, see build_parser_bvh. 
+// The binary tree is collapsed into the wide nodes, and the children of a wide node are stored as SoA 
+// so that a ray can be tested against all of them at once(4 lanes for bvh4, 8 lanes for bvh8). 
+// A child is 
+// - empty if children[i] == parser_bvh_empty_child(the bounds are inverted, so nothing hits it)
+// - a leaf if primitive_counts[i] > 0, then children[i] is the first one inside ParserBvh.primitive_indices
+// - otherwise children[i] is the index of the wide node
+#define parser_bvh_empty_child 0xffffffff
+#define parser_bvh_bin_count 16
+#define parser_bvh_max_leaf_size 8
+// the serial subtree build keeps this many pending nodes, deeper nodes become leaves
+#define parser_bvh_max_stack_depth 128
+
+struct ParserBvh4Node
+{
+    f32 min_x[4];
+    f32 min_y[4];
+    f32 min_z[4];
+    f32 max_x[4];
+    f32 max_y[4];
+    f32 max_z[4];
+
+    u32 children[4];
+    u32 primitive_counts[4];
+}; // 128 bytes
+
+struct ParserBvh8Node
+{
+    f32 min_x[8];
+    f32 min_y[8];
+    f32 min_z[8];
+    f32 max_x[8];
+    f32 max_y[8];
+    f32 max_z[8];
+
+    u32 children[8];
+    u32 primitive_counts[8];
+}; // 256 bytes
+
+struct ParserBvh
+{
+    u32 width; // 4 or 8
+    union
+    {
+        ParserBvh4Node *nodes4;
+        ParserBvh8Node *nodes8;
+    };
+    u32 node_count; // the root is the first node
+
+    // triangle index(the index of the first corner / 3) of every leaf entry
+    u32 *primitive_indices;
+    u32 primitive_count;
+
+    v3 min;
+    v3 max;
+};
+
+// NOTE(joon) one triangle while building, the bounds are all that the builder looks at
+struct ParserBvhReference
+{
+    f32 min[3];
+    u32 primitive_index;
+    f32 max[3];
+    u32 padding;
+};
+
+// NOTE(joon) binary node, only alive while building
+struct ParserBvhBuildNode
+{
+    f32 min[3];
+    f32 max[3];
+
+    // leaf : first reference, internal : left child(the right child is right after it)
+    u32 first;
+    u32 count; // 0 for the internal nodes
+};
+
+// NOTE(joon) the 4th lane is not used, it's there so that the bin can be grown with one min and one max
+struct ParserBvhBin
+{
+    f32 min[4];
+    f32 max[4];
+};
+
+struct ParserBvhBins
+{
+    // per axis
+    ParserBvhBin bins[3][parser_bvh_bin_count];
+    u32 counts[3][parser_bvh_bin_count];
+};
+
+// NOTE(joon) a node that still needs to be split, with the range of the references that it has
+struct ParserBvhBuildTask
+{
+    u32 node_index;
+    u32 first;
+    u32 count;
+    u32 bin_count; // parser_bvh_bin_count, or less for the small nodes
+
+    // the bins are spread over the centroids, not over the bounds
+    f32 centroid_min[3];
+    f32 centroid_max[3];
+};
+
+struct ParserBvhSplit
+{
+    b32 is_valid;
+    u32 axis;
+    u32 bin; // the references with the bin index <= bin go to the left
+    f32 cost; // sum of (half area x count) of both sides
+
+    f32 left_min[3];
+    f32 left_max[3];
+    f32 right_min[3];
+    f32 right_max[3];
+};
+
+struct ParserBvhBuilder
+{
+    ParserBvhReference *references;
+    ParserBvhReference *scratch_references; // the parallel partition scatters into this and copies back
+
+    ParserBvhBuildNode *nodes; // 2*reference_count - 1 at most
+    u32 node_count; // atomic, the subtree works allocate the nodes two at a time
+};
+
+// NOTE(joon) one work item of the parallel passes of build_parser_bvh, each one does a range of the triangles 
+// or the references, and keeps its own bounds / bins / counts that are merged afterwards
+struct ParserBvhWork
+{
+    ParserBvhBuilder *builder;
+    u32 first;
+    u32 count;
+
+    // making the references
+    f32 *positions;
+    u32 position_stride;
+    u32 vertex_count;
+    u32 *indices;
+    u32 index_base;
+    f32 min[3];
+    f32 max[3];
+    f32 centroid_min[3];
+    f32 centroid_max[3];
+
+    // splitting one node
+    ParserBvhBuildTask *task;
+    f32 *bin_scales;
+    ParserBvhBins bins;
+    ParserBvhSplit *split;
+    u32 left_count;
+    u32 left_offset;
+    u32 right_offset;
+    f32 left_centroid_min[3];
+    f32 left_centroid_max[3];
+    f32 right_centroid_min[3];
+    f32 right_centroid_max[3];
+
+    // building one subtree
+    ParserBvhBuildTask subtree_task;
+};
+
+// NOTE(joon) on disk cache of the parse result, see load_obj_cached / load_ply_cached.
+// Everything is stored in the host byte order and layout,
+// so a cache from a different machine or an older build fails the magic / version / header_size check
+// and is simply rebuilt.
+#define parser_mesh_cache_magic 0x4853454d52535250ull // "PRSRMESH"
+#define parser_mesh_cache_version 4
+#define parser_mesh_cache_alignment 64
+#define parser_mesh_cache_max_array_count 6
+
+enum ParserMeshCacheSourceType
+{
+    parser_mesh_cache_source_type_null,
+    parser_mesh_cache_source_type_obj,
+    parser_mesh_cache_source_type_ply,
+};
+
+struct ParserMeshCacheHeader
+{
+    u64 magic;
+    u32 version;
+    u32 header_size; // sizeof(ParserMeshCacheHeader), catches the layout changes that forgot to bump the version
+    u32 source_type;
+    u32 array_count;
+
+    // the source file that this cache was made from
+    u64 source_size;
+    i64 source_mtime_sec;
+    i64 source_mtime_nsec;
+    u64 source_hash;
+
+    // only the one that matches the source_type is valid
+    PreParseObjResult obj_counts;
+    ParsePlyHeaderResult ply_header;
+
+    // the bvh that was built with the mesh, bvh_width is 0 if there is none
+    u32 bvh_width;
+    u32 bvh_node_count;
+    u32 bvh_primitive_count;
+    v3 bvh_min;
+    v3 bvh_max;
+
+    // from the start of the cache file, aligned to parser_mesh_cache_alignment
+    // obj : positions, normals, texcoords, indices, (bvh nodes, bvh primitive indices)
+    // ply : vertices, indices, (bvh nodes, bvh primitive indices)
+    u64 array_offsets[parser_mesh_cache_max_array_count];
+    u64 array_sizes[parser_mesh_cache_max_array_count];
+};
+
+// NOTE(joon) one piece of the file that load_obj_incremental keeps parsed between the reloads.
+// The cuts depend only on the lines around them(see find_obj_incremental_cuts_work),
+// so an edit only changes the chunks that it touches, and the cuts after it line up again.
+struct ObjIncrementalChunk
+{
+    u64 hash;
+    u64 size;
+
+    // arena + parsed chunk, and where the chunk was copied inside the result
+    ObjChunkWork work;
+    b32 is_reparsed;
+    b32 is_moved; // old chunk that was given to the new chunk list as it is
+};
+
+// NOTE(joon) used by the parallel passes of load_obj_incremental, one range of the chunks per work
+struct ObjIncrementalWork
+{
+    ObjIncrementalChunk *chunks;
+    u32 *chunk_indices;
+    u32 chunk_count;
+
+    // find_obj_incremental_cuts_work only, the line starts inside [start, one_past_end) that can be a cut
+    u8 *file;
+    u8 *start;
+    u8 *one_past_end;
+    u8 *file_one_past_end;
+    size_t target_chunk_size;
+    ParserArena arena;
+    ParserBlockList cuts; // u64, offset from the file start
+};
+
+struct ObjIncrementalSlot
+{
+    // chunk_index_plus_one == 0 means that the slot is empty
+    u64 hash;
+    u32 chunk_index_plus_one;
+};
+
+struct ObjIncrementalState
+{
+    // every chunk has its own sub-arena of this one, and the result lives inside result_arena
+    ParserArena *arena;
+    size_t target_chunk_size;
+
+    ParserArena chunk_arena; // chunks
+    ObjIncrementalChunk *chunks;
+    u32 chunk_count;
+
+    ParserArena result_arena;
+    LoadObjResult result;
+
+    // what the last load_obj_incremental did
+    u32 reparsed_chunk_count;
+    u64 reparsed_size;
+    b32 is_result_patched; // the result arrays didn't move, only the chunks that changed were copied again
+};
+
+// NOTE(joon) reads the next chunks of the file ahead of the parser, so that the disk(or the network) 
+// and the parser work at the same time instead of one after another. 
+// The chunks are a fixed ring of queue_depth buffers, and a chunk is read again 
+// as soon as the parser is done with it.
+enum ParserReadBackend
+{
+    parser_read_backend_read, // no overlap, used for the pipes or when nothing else works
+    parser_read_backend_pread_thread,
+    parser_read_backend_io_uring,
+    parser_read_backend_decompress_thread, // see begin_parser_decompress_pipeline
+};
+
+enum ParserCompression
+{
+    parser_compression_none,
+    parser_compression_gzip, // needs PARSER_ZLIB
+    parser_compression_zstd, // needs PARSER_ZSTD
+};
+
+// NOTE(joon) turns the compressed bytes from the file descriptor into the chunks of the read pipeline. 
+// The compressed bytes go through a fixed input buffer, so the memory is bounded no matter how big the file is.
+struct ParserDecompressor
+{
+    ParserCompression compression;
+    int file_descriptor;
+
+    u8 *input;
+    size_t input_size;
+    u8 *input_at;
+    u8 *input_one_past_end;
+    b32 input_reached_eof;
+
+    // z_stream or ZSTD_DStream
+    void *state;
+    b32 reached_eof;
+    // errno of the failed read, EIO for the corrupted data, ENOTSUP if the compression was not compiled in
+    int error;
+};
+
+struct ParserReadChunk
+{
+    u8 *memory;
+    u64 offset;
+    // bytes that were read so far, the chunk is only handed to the parser when it's full or the file is over
+    size_t size;
+
+    b32 is_in_flight;
+    b32 is_ready;
+    b32 reached_eof;
+    // errno of the read that ended the file early, 0 if the file really ended
+    int error;
+};
+
+#define parser_max_read_queue_depth 64
+struct ParserReadPipeline
+{
+    int file_descriptor;
+    ParserReadBackend backend;
+
+    size_t chunk_size;
+    u32 queue_depth;
+    ParserReadChunk chunks[parser_max_read_queue_depth];
+
+    // chunk i goes to chunks[i % queue_depth], and starts at first_offset + i*chunk_size
+    u64 first_offset;
+    u64 next_chunk_to_read;
+    u64 next_chunk_to_consume;
+    // no chunk after this one has any data
+    b32 reached_eof;
+    // error of the last chunk that was handed to the parser, see ParserReadChunk
+    int error;
+
+    // the chunk that the parser is consuming
+    ParserReadChunk *current_chunk;
+    u8 *at;
+    u8 *one_past_end;
+
+    // io_uring, everything is mapped from the ring file descriptor
+    int ring_file_descriptor;
+    u32 in_flight_count;
+    void *submission_ring;
+    size_t submission_ring_size;
+    void *completion_ring;
+    size_t completion_ring_size;
+    void *submission_entries;
+    size_t submission_entries_size;
+    u32 *submission_head;
+    u32 *submission_tail;
+    u32 *submission_mask;
+    u32 *submission_array;
+    u32 *completion_head;
+    u32 *completion_tail;
+    u32 *completion_mask;
+    void *completion_entries;
+
+    // if this is not 0, the chunks are the decompressed bytes
+    ParserDecompressor *decompressor;
+
+    // pread thread(or the decompress thread)
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t chunk_changed;
+    b32 is_shutting_down;
+};
+
+// NOTE(joon) fixed size window over a file descriptor, used by the streaming parsers.
+// The window is owned by the caller, and it's the only place where the file bytes live, 
+// so the memory usage doesn't depend on the file size.
+struct ParserStream
+{
+    int file_descriptor;
+
+    // if this is not 0, the window is filled from the chunks that were read ahead
+    ParserReadPipeline *pipeline;
+
+    u8 *window;
+    size_t window_size;
+
+    // bytes inside the window that are not consumed yet
+    u8 *at;
+    u8 *one_past_end;
+
+    b32 reached_eof;
+    // errno of the read that ended the stream early(EIO, ESTALE...), 0 if the file really ended
+    int error;
+};
+
+// NOTE(joon) fixed size output of stream_obj. Whenever one of the arrays is full(and once more at the end), 
+// the batch is handed to the callback and then emptied. 
+// Indices are never split across the batches in the middle of a triangle.
+struct ObjStreamBatch;
+typedef void obj_stream_callback(ObjStreamBatch *batch, void *user_data);
+
+#define obj_stream_batch_count 4096
+struct ObjStreamBatch
+{
+    obj_stream_callback *callback;
+    void *user_data;
+
+    // how many elements were handed to the callback before this batch
+    u32 first_position_index;
+    u32 first_normal_index;
+    u32 first_texcoord_index;
+    u32 first_index_index;
+
+    v3 positions[obj_stream_batch_count];
+    u32 position_count;
+
+    v3 normals[obj_stream_batch_count];
+    u32 normal_count;
+
+    // vt u [v [w]], w is ignored and v is 0 if it's not there(same as load_obj)
+    v2 texcoords[obj_stream_batch_count];
+    u32 texcoord_count;
+
+    u32 indices[3*obj_stream_batch_count];
+    u32 index_count;
+
+    // set when stream_obj returns, errno of the read that ended the file early(see ParserStream), 
+    // so that a failed read is not mistaken for a shorter mesh
+    int read_error;
+};
+
+// NOTE(joon) same as ObjStreamBatch, but for stream_ply. 
+// Vertices are vertex_property_count f32s each, same as parse_ply.
+struct PlyStreamBatch;
+typedef void ply_stream_callback(ParsePlyHeaderResult *header, PlyStreamBatch *batch, void *user_data);
+
+#define ply_stream_batch_value_count (64*1024)
+struct PlyStreamBatch
+{
+    ply_stream_callback *callback;
+    void *user_data;
+
+    u32 first_vertex_index;
+    u32 first_index_index;
+
+    f32 vertices[ply_stream_batch_value_count];
+    u32 vertex_count;
+
+    u32 indices[ply_stream_batch_value_count];
+    u32 index_count;
+
+    // same as ObjStreamBatch::read_error
+    int read_error;
 };
 
-#if 0
 enum SceneTokenType
 {
     scene_token_type_null, 
@@ -163,15 +1203,98 @@ struct SceneToken
     };
 };
 
+struct SceneKeyword
+{
+    const char *name;
+    SceneTokenType type;
+};
+
+struct SceneMaterial
+{
+    v3 emissive_color;
+    v3 diffuse;
+    v4 specular;
+};
+
+struct SceneSphere
+{
+    v3 p;
+    f32 r;
+    u32 mat_index;
+};
+
+struct SceneBox
+{
+    v3 min;
+    v3 max;
+    u32 mat_index;
+};
+
+struct SceneCylinder
+{
+    v3 base;
+    v3 axis;
+    f32 r;
+    u32 mat_index;
+};
+
+enum SceneMeshType
+{
+    scene_mesh_type_obj,
+    scene_mesh_type_ply,
+};
+
+// NOTE(joon) one mesh file. Even if the scene uses the same file many times, 
+// it is only loaded once.
+struct SceneMesh
+{
+    char *file_path;
+    u64 file_path_hash;
+
+    SceneMeshType type;
+    // counts are 0 if the file could not be opened
+    union
+    {
+        LoadObjResult obj;
+        LoadPlyResult ply;
+    };
+
+    // the thread that loads this mesh allocates here, 
+    // and parse_scene merges it into the scene arena when the loading is done
+    ParserArena arena;
+};
+
+// NOTE(joon) one mesh line in the scene
 struct MeshInfo
 {
-    // TODO(joon) If we don't want any memory allocation inside the parser,
-    // we can just get the file_path_start & file_path_end
+    // allocated inside the arena that was passed to parse_scene
     char *file_path;
 
+    // index to ParseSceneResult::meshes
+    u32 mesh_index;
     u32 mat_index;
 };
 
+struct SceneMeshSlot
+{
+    // file_path == 0 means that the slot is empty
+    u64 hash;
+    char *file_path;
+    u32 mesh_index;
+};
+
+// NOTE(joon) deduplicates the mesh files by their paths
+struct SceneMeshTable
+{
+    SceneMeshSlot *slots;
+    u32 slot_count;
+
+    // mesh index -> path, so that the slots can be rebuilt when the table grows
+    char **file_paths;
+
+    ParserBlockList meshes; // SceneMesh *, the meshes themselves never move because the pool is loading them
+};
+
 struct ParseSceneResult
 {
     i32 output_width;
@@ -183,23 +1306,27 @@ struct ParseSceneResult
 
     v3 ambient;
 
-    // TODO(joon) pass world instead?
-    Sphere spheres[100]; // TODO(joon) better way??
+    // all of these are allocated inside the arena that was passed to parse_scene
+    SceneSphere *spheres;
     u32 sphere_count;
 
-    Box boxes[100];
+    SceneBox *boxes;
     u32 box_count;
 
-    Cylinder cylinders[100];
+    SceneCylinder *cylinders;
     u32 cylinder_count;
 
-    Material materials[100];
+    // 0th mat is a default mat
+    SceneMaterial *materials;
     u32 mat_count;
 
-    MeshInfo mesh_infos[100];
+    MeshInfo *mesh_infos;
     u32 mesh_count;
+
+    // unique mesh files
+    SceneMesh *meshes;
+    u32 unique_mesh_count;
 };
-#endif
 
 
 #endif
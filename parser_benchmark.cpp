@@ -0,0 +1,1183 @@
+// NOTE(joon) benchmark for the parsers, with a deterministic synthetic corpus generator.
+// Unity build, just like the projects that use this parser:
+//     g++ -O2 -pthread parser_benchmark.cpp -o parser_benchmark
+// Usage:
+//     parser_benchmark [corpus_dir] [-sizes 1,16,128] [-threads n] [-generate]
+// -sizes is the list of the file sizes in MB(1 ~ 10240). Files that are already inside the
+// corpus_dir with the same name are not generated again, -generate forces it.
+// Every benchmark runs inside its own child process, so that the peak RSS can be measured per function.
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// NOTE(joon) the parser expects these from the host project
+typedef int8_t i8;
+typedef int16_t i16;
+typedef int32_t i32;
+typedef int64_t i64;
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef float f32;
+typedef double f64;
+typedef int32_t b32;
+
+#define internal static
+#define global static
+#define local_persist static
+#define invalid_code_path assert(0)
+
+struct v2
+{
+    f32 x, y;
+};
+
+struct v3
+{
+    f32 x, y, z;
+};
+
+struct v4
+{
+    f32 x, y, z, w;
+};
+
+#include "parser.cpp"
+
+//
+// NOTE(joon) corpus generator
+//
+
+// xorshift64*, so that the corpus is the same on every machine
+struct BenchmarkRandom
+{
+    u64 state;
+};
+
+inline u64
+next_random(BenchmarkRandom *random)
+{
+    random->state ^= random->state >> 12;
+    random->state ^= random->state << 25;
+    random->state ^= random->state >> 27;
+    return random->state*0x2545f4914f6cdd1dull;
+}
+
+inline f64
+random_bilateral(BenchmarkRandom *random)
+{
+    f64 result = ((f64)(next_random(random) >> 11)/(f64)(1ull << 53))*2.0 - 1.0;
+    return result;
+}
+
+inline u32
+random_range(BenchmarkRandom *random, u32 min, u32 max)
+{
+    u32 result = min + (u32)(next_random(random) % (u64)(max - min + 1));
+    return result;
+}
+
+enum BenchmarkFloatFormat
+{
+    benchmark_float_format_fixed, // %f
+    benchmark_float_format_scientific, // %.9e, scanner output looks like this
+    benchmark_float_format_shortest, // %.7g
+    benchmark_float_format_integer,
+};
+
+enum BenchmarkFileType
+{
+    benchmark_file_type_obj,
+    benchmark_file_type_ply_ascii,
+    benchmark_file_type_ply_binary,
+    benchmark_file_type_numbers,
+    benchmark_file_type_indices, // non negative integers, like the face indices
+    benchmark_file_type_scene, // spheres, boxes, cylinders and the meshes that point to the other corpus files
+};
+
+struct BenchmarkCorpus
+{
+    const char *name;
+    BenchmarkFileType type;
+
+    BenchmarkFloatFormat float_format;
+
+    // obj only
+    ObjVertexType vertex_type;
+    u32 min_face_arity;
+    u32 max_face_arity;
+    // how many comment lines out of 1000 lines
+    u32 comment_per_mille;
+
+    // ply only
+    u32 vertex_property_count;
+    b32 has_face_flags; // a uchar property before the vertex indices of every face
+};
+
+global BenchmarkCorpus benchmark_corpora[] =
+{
+    {"obj_v_tri_fixed", benchmark_file_type_obj, benchmark_float_format_fixed, obj_vertex_type_v, 3, 3, 0, 0},
+    {"obj_v_vn_quad_sci", benchmark_file_type_obj, benchmark_float_format_scientific, obj_vertex_type_v_vn, 4, 4, 0, 0},
+    {"obj_v_vt_vn_mixed_comments", benchmark_file_type_obj, benchmark_float_format_shortest, obj_vertex_type_v_vt_vn, 3, 6, 50, 0},
+    {"ply_ascii_xyz", benchmark_file_type_ply_ascii, benchmark_float_format_fixed, obj_vertex_type_v, 3, 3, 0, 3},
+    {"ply_ascii_xyz_n_conf_int", benchmark_file_type_ply_ascii, benchmark_float_format_scientific, obj_vertex_type_v, 3, 4, 0, 8},
+    {"ply_binary_xyz", benchmark_file_type_ply_binary, benchmark_float_format_fixed, obj_vertex_type_v, 3, 3, 0, 3},
+    {"ply_ascii_xyz_face_flags", benchmark_file_type_ply_ascii, benchmark_float_format_fixed, obj_vertex_type_v, 3, 5, 0, 3, true},
+    {"numbers_fixed", benchmark_file_type_numbers, benchmark_float_format_fixed},
+    {"numbers_scientific", benchmark_file_type_numbers, benchmark_float_format_scientific},
+    {"numbers_integer", benchmark_file_type_numbers, benchmark_float_format_integer},
+    {"indices", benchmark_file_type_indices, benchmark_float_format_integer},
+    // NOTE(joon) should come after the mesh files, because the scene points to them
+    {"scene", benchmark_file_type_scene, benchmark_float_format_fixed},
+};
+
+struct BenchmarkWriter
+{
+    FILE *file;
+    u64 size;
+
+    u8 buffer[1 << 20];
+    u32 used;
+};
+
+internal void
+flush_benchmark_writer(BenchmarkWriter *writer)
+{
+    fwrite(writer->buffer, 1, writer->used, writer->file);
+    writer->used = 0;
+}
+
+internal void
+write_bytes(BenchmarkWriter *writer, void *data, u32 size)
+{
+    if(writer->used + size > sizeof(writer->buffer))
+    {
+        flush_benchmark_writer(writer);
+    }
+
+    memcpy(writer->buffer + writer->used, data, size);
+    writer->used += size;
+    writer->size += size;
+}
+
+internal void
+write_format(BenchmarkWriter *writer, const char *format, ...)
+{
+    char buffer[256];
+
+    va_list args;
+    va_start(args, format);
+    i32 length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    assert(length > 0 && length < (i32)sizeof(buffer));
+    write_bytes(writer, buffer, (u32)length);
+}
+
+internal void
+write_float(BenchmarkWriter *writer, BenchmarkFloatFormat format, f64 value)
+{
+    switch(format)
+    {
+        case benchmark_float_format_fixed:
+        {
+            write_format(writer, "%f", value);
+        }break;
+        case benchmark_float_format_scientific:
+        {
+            write_format(writer, "%.9e", value);
+        }break;
+        case benchmark_float_format_shortest:
+        {
+            write_format(writer, "%.7g", value);
+        }break;
+        case benchmark_float_format_integer:
+        {
+            write_format(writer, "%d", (i32)(value*100000.0));
+        }break;
+    }
+}
+
+internal void
+generate_obj(BenchmarkWriter *writer, BenchmarkCorpus *corpus, BenchmarkRandom *random, u64 target_size)
+{
+    b32 has_vt = (corpus->vertex_type == obj_vertex_type_v_vt || corpus->vertex_type == obj_vertex_type_v_vt_vn);
+    b32 has_vn = (corpus->vertex_type == obj_vertex_type_v_vn || corpus->vertex_type == obj_vertex_type_v_vt_vn);
+
+    write_format(writer, "# generated by parser_benchmark\no %s\n", corpus->name);
+
+    // NOTE(joon) vertices and faces are interleaved, and the faces only use the vertices that
+    // appeared before(mostly the recent ones), which is how the exporters usually write them
+    u32 vertex_count = 0;
+    while(writer->size < target_size)
+    {
+        for(u32 i = 0;
+                i < 64;
+                ++i)
+        {
+            write_format(writer, "v ");
+            write_float(writer, corpus->float_format, 100.0*random_bilateral(random));
+            write_format(writer, " ");
+            write_float(writer, corpus->float_format, 100.0*random_bilateral(random));
+            write_format(writer, " ");
+            write_float(writer, corpus->float_format, 100.0*random_bilateral(random));
+            write_format(writer, "\n");
+
+            if(has_vt)
+            {
+                write_format(writer, "vt ");
+                write_float(writer, corpus->float_format, 0.5 + 0.5*random_bilateral(random));
+                write_format(writer, " ");
+                write_float(writer, corpus->float_format, 0.5 + 0.5*random_bilateral(random));
+                write_format(writer, "\n");
+            }
+            if(has_vn)
+            {
+                write_format(writer, "vn ");
+                write_float(writer, corpus->float_format, random_bilateral(random));
+                write_format(writer, " ");
+                write_float(writer, corpus->float_format, random_bilateral(random));
+                write_format(writer, " ");
+                write_float(writer, corpus->float_format, random_bilateral(random));
+                write_format(writer, "\n");
+            }
+
+            if(random_range(random, 0, 999) < corpus->comment_per_mille)
+            {
+                write_format(writer, "# comment line, the parser should skip this as fast as possible\n");
+            }
+        }
+        vertex_count += 64;
+
+        // about two faces per vertex
+        for(u32 i = 0;
+                i < 128;
+                ++i)
+        {
+            u32 arity = random_range(random, corpus->min_face_arity, corpus->max_face_arity);
+            write_format(writer, "f");
+            for(u32 corner_index = 0;
+                    corner_index < arity;
+                    ++corner_index)
+            {
+                u32 window = vertex_count < 256 ? vertex_count : 256;
+                u32 index = vertex_count - random_range(random, 0, window - 1);
+                switch(corpus->vertex_type)
+                {
+                    case obj_vertex_type_v:
+                    {
+                        write_format(writer, " %u", index);
+                    }break;
+                    case obj_vertex_type_v_vn:
+                    {
+                        write_format(writer, " %u//%u", index, index);
+                    }break;
+                    case obj_vertex_type_v_vt:
+                    {
+                        write_format(writer, " %u/%u", index, index);
+                    }break;
+                    case obj_vertex_type_v_vt_vn:
+                    {
+                        write_format(writer, " %u/%u/%u", index, index, index);
+                    }break;
+                }
+            }
+            write_format(writer, "\n");
+        }
+    }
+}
+
+internal void
+write_ply_vertex(BenchmarkWriter *writer, BenchmarkCorpus *corpus, BenchmarkRandom *random)
+{
+    for(u32 property_index = 0;
+            property_index < corpus->vertex_property_count;
+            ++property_index)
+    {
+        f64 value = (property_index < 3) ? 100.0*random_bilateral(random) : random_bilateral(random);
+        if(corpus->type == benchmark_file_type_ply_binary)
+        {
+            f32 value_f32 = (f32)value;
+            write_bytes(writer, &value_f32, sizeof(value_f32));
+        }
+        else
+        {
+            if(property_index)
+            {
+                write_format(writer, " ");
+            }
+            if(property_index == 7)
+            {
+                // NOTE(joon) scanners often put an integer intensity at the end
+                write_format(writer, "%u", random_range(random, 0, 255));
+            }
+            else
+            {
+                write_float(writer, corpus->float_format, value);
+            }
+        }
+    }
+
+    if(corpus->type != benchmark_file_type_ply_binary)
+    {
+        write_format(writer, "\n");
+    }
+}
+
+internal void
+write_ply_face(BenchmarkWriter *writer, BenchmarkCorpus *corpus, BenchmarkRandom *random, u32 vertex_count)
+{
+    u32 arity = random_range(random, corpus->min_face_arity, corpus->max_face_arity);
+    if(corpus->has_face_flags)
+    {
+        u8 flags = (u8)random_range(random, 0, 255);
+        if(corpus->type == benchmark_file_type_ply_binary)
+        {
+            write_bytes(writer, &flags, 1);
+        }
+        else
+        {
+            write_format(writer, "%u ", flags);
+        }
+    }
+
+    if(corpus->type == benchmark_file_type_ply_binary)
+    {
+        u8 arity_u8 = (u8)arity;
+        write_bytes(writer, &arity_u8, 1);
+    }
+    else
+    {
+        write_format(writer, "%u", arity);
+    }
+
+    for(u32 corner_index = 0;
+            corner_index < arity;
+            ++corner_index)
+    {
+        i32 index = (i32)random_range(random, 0, vertex_count - 1);
+        if(corpus->type == benchmark_file_type_ply_binary)
+        {
+            write_bytes(writer, &index, sizeof(index));
+        }
+        else
+        {
+            write_format(writer, " %d", index);
+        }
+    }
+
+    if(corpus->type != benchmark_file_type_ply_binary)
+    {
+        write_format(writer, "\n");
+    }
+}
+
+internal void
+generate_ply(BenchmarkWriter *writer, BenchmarkCorpus *corpus, BenchmarkRandom *random, u64 target_size)
+{
+    // NOTE(joon) the header needs the counts, so measure how big one vertex + two faces are first
+    // (with a copy of the random, so that the real output doesn't change)
+    BenchmarkWriter *sample = (BenchmarkWriter *)calloc(1, sizeof(BenchmarkWriter));
+    sample->file = fopen("/dev/null", "wb");
+    BenchmarkRandom sample_random = *random;
+    for(u32 i = 0;
+            i < 1024;
+            ++i)
+    {
+        write_ply_vertex(sample, corpus, &sample_random);
+        write_ply_face(sample, corpus, &sample_random, 1024);
+        write_ply_face(sample, corpus, &sample_random, 1024);
+    }
+    fclose(sample->file);
+    u64 bytes_per_vertex = sample->size/1024;
+    free(sample);
+
+    u32 vertex_count = (u32)(target_size/bytes_per_vertex) + 3;
+    u32 face_count = 2*vertex_count;
+
+    const char *property_names[] = {"x", "y", "z", "nx", "ny", "nz", "confidence", "intensity"};
+    write_format(writer, "ply\nformat %s 1.0\ncomment generated by parser_benchmark\n",
+                 corpus->type == benchmark_file_type_ply_binary ? "binary_little_endian" : "ascii");
+    write_format(writer, "element vertex %u\n", vertex_count);
+    for(u32 property_index = 0;
+            property_index < corpus->vertex_property_count;
+            ++property_index)
+    {
+        write_format(writer, "property float %s\n", property_names[property_index]);
+    }
+    write_format(writer, "element face %u\n", face_count);
+    if(corpus->has_face_flags)
+    {
+        write_format(writer, "property uchar flags\n");
+    }
+    write_format(writer, "property list uchar int vertex_indices\nend_header\n");
+
+    for(u32 vertex_index = 0;
+            vertex_index < vertex_count;
+            ++vertex_index)
+    {
+        write_ply_vertex(writer, corpus, random);
+    }
+    for(u32 face_index = 0;
+            face_index < face_count;
+            ++face_index)
+    {
+        write_ply_face(writer, corpus, random, vertex_count);
+    }
+}
+
+internal void
+generate_numbers(BenchmarkWriter *writer, BenchmarkCorpus *corpus, BenchmarkRandom *random, u64 target_size)
+{
+    while(writer->size < target_size)
+    {
+        for(u32 i = 0;
+                i < 8;
+                ++i)
+        {
+            write_float(writer, corpus->float_format, 1000.0*random_bilateral(random));
+            write_format(writer, (i == 7) ? "\n" : " ");
+        }
+    }
+}
+
+internal void
+generate_indices(BenchmarkWriter *writer, BenchmarkRandom *random, u64 target_size)
+{
+    while(writer->size < target_size)
+    {
+        for(u32 i = 0;
+                i < 8;
+                ++i)
+        {
+            // NOTE(joon) mostly 4 ~ 7 digits, like the meshes with 10k ~ 10M vertices
+            u32 digit_count = random_range(random, 1, 7);
+            u32 max = 1;
+            for(u32 digit_index = 0;
+                    digit_index < digit_count;
+                    ++digit_index)
+            {
+                max *= 10;
+            }
+
+            write_format(writer, (i == 7) ? "%u\n" : "%u ", random_range(random, 0, max - 1));
+        }
+    }
+}
+
+// NOTE(joon) every 64th line is a mesh, and the meshes are the obj & ply corpus files of the same size, 
+// so most of the mesh lines are the duplicates of the files that were already mentioned
+internal void
+generate_scene(BenchmarkWriter *writer, BenchmarkCorpus *corpus, BenchmarkRandom *random, u64 target_size)
+{
+    write_format(writer, "screen 1920 1080\n");
+    write_format(writer, "camera 0 1.5 -5 b 0.5 q 1 0 0 0\n");
+    write_format(writer, "ambient 0.1 0.1 0.1\n");
+
+    u32 line_index = 0;
+    while(writer->size < target_size)
+    {
+        if((line_index % 64) == 0)
+        {
+            BenchmarkCorpus *mesh_corpus = benchmark_corpora + random_range(random, 0, 5);
+            assert(mesh_corpus->type == benchmark_file_type_obj || 
+                   mesh_corpus->type == benchmark_file_type_ply_ascii || 
+                   mesh_corpus->type == benchmark_file_type_ply_binary);
+
+            write_format(writer, "mesh %s_%umb.%s\n", mesh_corpus->name, (u32)(target_size >> 20), 
+                         mesh_corpus->type == benchmark_file_type_obj ? "obj" : "ply");
+        }
+        else if((line_index % 16) == 0)
+        {
+            write_format(writer, "brdf ");
+            for(u32 i = 0;
+                    i < 6;
+                    ++i)
+            {
+                write_float(writer, corpus->float_format, 0.5 + 0.5*random_bilateral(random));
+                write_format(writer, " ");
+            }
+            write_format(writer, "%u\n", random_range(random, 1, 100));
+        }
+        else
+        {
+            u32 value_count = 0;
+            switch(random_range(random, 0, 2))
+            {
+                case 0:
+                {
+                    write_format(writer, "sphere");
+                    value_count = 4;
+                }break;
+                case 1:
+                {
+                    write_format(writer, "box");
+                    value_count = 6;
+                }break;
+                case 2:
+                {
+                    write_format(writer, "cylinder");
+                    value_count = 7;
+                }break;
+            }
+
+            for(u32 i = 0;
+                    i < value_count;
+                    ++i)
+            {
+                write_format(writer, " ");
+                write_float(writer, corpus->float_format, 100.0*random_bilateral(random));
+            }
+            write_format(writer, "\n");
+        }
+
+        line_index++;
+    }
+}
+
+internal void
+generate_corpus_file(char *path, BenchmarkCorpus *corpus, u64 target_size)
+{
+    BenchmarkWriter *writer = (BenchmarkWriter *)calloc(1, sizeof(BenchmarkWriter));
+    writer->file = fopen(path, "wb");
+    assert(writer->file);
+
+    BenchmarkRandom random = {0x9e3779b97f4a7c15ull ^ target_size};
+    switch(corpus->type)
+    {
+        case benchmark_file_type_obj:
+        {
+            generate_obj(writer, corpus, &random, target_size);
+        }break;
+        case benchmark_file_type_ply_ascii:
+        case benchmark_file_type_ply_binary:
+        {
+            generate_ply(writer, corpus, &random, target_size);
+        }break;
+        case benchmark_file_type_numbers:
+        {
+            generate_numbers(writer, corpus, &random, target_size);
+        }break;
+        case benchmark_file_type_indices:
+        {
+            generate_indices(writer, &random, target_size);
+        }break;
+        case benchmark_file_type_scene:
+        {
+            generate_scene(writer, corpus, &random, target_size);
+        }break;
+    }
+
+    flush_benchmark_writer(writer);
+    fclose(writer->file);
+    free(writer);
+}
+
+//
+// NOTE(joon) benchmarks
+//
+
+inline f64
+get_seconds()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    f64 result = (f64)time.tv_sec + 1e-9*(f64)time.tv_nsec;
+    return result;
+}
+
+enum BenchmarkFunction
+{
+    benchmark_function_eat_numeric,
+    benchmark_function_decode_parser_small_integer,
+
+    benchmark_function_pre_parse_obj,
+    benchmark_function_parse_obj,
+    benchmark_function_pre_parse_and_parse_obj,
+    benchmark_function_load_obj,
+    benchmark_function_load_obj_pool,
+    benchmark_function_load_obj_welded_pool,
+    benchmark_function_load_obj_polygons_pool,
+    benchmark_function_load_obj_stats_pool, // bounds, centroid and unit normals while parsing
+    benchmark_function_load_obj_incremental_pool,
+    benchmark_function_load_obj_incremental_reload_pool, // one digit edited, after the first load
+    benchmark_function_build_obj_bvh_pool, // bvh4 after load_obj(pool), the load is not counted
+    benchmark_function_stream_obj,
+    benchmark_function_stream_obj_pipelined,
+    benchmark_function_load_obj_path_pool, // end to end, from the path
+
+    benchmark_function_parse_ply_header,
+    benchmark_function_parse_ply,
+    benchmark_function_parse_ply_pool,
+    benchmark_function_load_ply_with_layout_pool,
+    benchmark_function_load_ply_polygons_pool,
+    benchmark_function_load_ply_stats_pool,
+    benchmark_function_build_ply_bvh_pool, // bvh4 after parse_ply(pool), the parse is not counted
+    benchmark_function_stream_ply,
+    benchmark_function_stream_ply_pipelined,
+    benchmark_function_load_ply_path_pool, // end to end, from the path
+
+    benchmark_function_parse_scene_pool, // including the meshes
+
+    benchmark_function_count,
+};
+
+global const char *benchmark_function_names[] =
+{
+    "eat_numeric",
+    "decode_parser_small_integer",
+    "pre_parse_obj",
+    "parse_obj",
+    "pre_parse_obj + parse_obj",
+    "load_obj",
+    "load_obj(pool)",
+    "load_obj_welded(pool)",
+    "load_obj_polygons(pool)",
+    "load_obj(pool, stats)",
+    "load_obj_incremental(pool)",
+    "load_obj_incremental(reload, pool)",
+    "build_obj_bvh(pool)",
+    "stream_obj(1MB window)",
+    "stream_obj(pipelined reads)",
+    "load_obj(path, pool)",
+    "parse_ply_header",
+    "parse_ply",
+    "parse_ply(pool)",
+    "load_ply_with_layout(pool)",
+    "load_ply_polygons(pool)",
+    "load_ply(pool, stats)",
+    "build_ply_bvh(pool)",
+    "stream_ply(1MB window)",
+    "stream_ply(pipelined reads)",
+    "load_ply(path, pool)",
+    "parse_scene(pool)",
+};
+
+internal b32
+is_benchmark_function_for(BenchmarkFunction function, BenchmarkFileType type)
+{
+    b32 result = false;
+    if(function == benchmark_function_eat_numeric)
+    {
+        result = (type == benchmark_file_type_numbers || type == benchmark_file_type_indices);
+    }
+    else if(function == benchmark_function_decode_parser_small_integer)
+    {
+        result = (type == benchmark_file_type_indices);
+    }
+    else if(function < benchmark_function_parse_ply_header)
+    {
+        result = (type == benchmark_file_type_obj);
+    }
+    else if(function < benchmark_function_parse_scene_pool)
+    {
+        result = (type == benchmark_file_type_ply_ascii || type == benchmark_file_type_ply_binary);
+    }
+    else
+    {
+        result = (type == benchmark_file_type_scene);
+    }
+
+    return result;
+}
+
+internal void
+count_stream_obj_batch(ObjStreamBatch *batch, void *user_data)
+{
+    *(u64 *)user_data += batch->position_count;
+}
+
+internal void
+count_stream_ply_batch(ParsePlyHeaderResult *header, PlyStreamBatch *batch, void *user_data)
+{
+    *(u64 *)user_data += batch->vertex_count;
+}
+
+// NOTE(joon) runs the function once, and returns how many vertices(or numbers) it produced. 
+// The peak of the arena(including the per-thread sub-arenas) goes to arena_peak_size.
+internal u64
+run_benchmark_function(BenchmarkFunction function, char *path, ParserMappedFile *file, ParserThreadPool *pool, 
+                       size_t *arena_peak_size = 0)
+{
+    u64 result = 0;
+
+    ParserArena arena = {};
+    switch(function)
+    {
+        case benchmark_function_eat_numeric:
+        {
+            Tokenizer tokenizer = {};
+            tokenizer.at = file->memory;
+            tokenizer.one_past_end = file->memory + file->size;
+
+            f32 sum = 0.0f;
+            while(1)
+            {
+                eat_all_whitespaces(&tokenizer);
+                if(tokenizer.at == tokenizer.one_past_end)
+                {
+                    break;
+                }
+
+                ParseNumericResult number = eat_numeric(&tokenizer);
+                sum += number.is_float ? number.value_f32 : (f32)number.value_i32;
+                result++;
+            }
+
+            // NOTE(joon) so that the compiler doesn't throw the loop away
+            if(sum == 1234.5f)
+            {
+                printf(" ");
+            }
+        }break;
+
+        case benchmark_function_decode_parser_small_integer:
+        {
+            Tokenizer tokenizer = {};
+            tokenizer.at = file->memory;
+            tokenizer.one_past_end = file->memory + file->size;
+
+            u32 sum = 0;
+            while(1)
+            {
+                eat_all_whitespaces(&tokenizer);
+                if(tokenizer.at == tokenizer.one_past_end)
+                {
+                    break;
+                }
+
+                u32 value;
+                tokenizer.at = decode_parser_small_integer(tokenizer.at, tokenizer.one_past_end, &value);
+                assert(tokenizer.at);
+                sum += value;
+                result++;
+            }
+
+            if(sum == 12345)
+            {
+                printf(" ");
+            }
+        }break;
+
+        case benchmark_function_pre_parse_obj:
+        {
+            result = pre_parse_obj(file->memory, file->size).position_count;
+        }break;
+        case benchmark_function_parse_obj:
+        case benchmark_function_pre_parse_and_parse_obj:
+        {
+            // NOTE(joon) parse_obj alone still needs the pre_parse result,
+            // so that one is subtracted from the time by the caller
+            PreParseObjResult pre_parse = pre_parse_obj(file->memory, file->size);
+            v3 *positions = push_parser_array(&arena, v3, pre_parse.position_count);
+            v3 *normals = push_parser_array(&arena, v3, pre_parse.normal_count);
+            v2 *texcoords = push_parser_array(&arena, v2, pre_parse.texcoord_count);
+            u32 *indices = push_parser_array(&arena, u32, pre_parse.index_count);
+            parse_obj(&pre_parse, file->memory, (u32)file->size, positions, normals, texcoords, indices);
+
+            result = pre_parse.position_count;
+        }break;
+        case benchmark_function_load_obj:
+        {
+            result = load_obj(&arena, file->memory, file->size).counts.position_count;
+        }break;
+        case benchmark_function_load_obj_pool:
+        {
+            result = load_obj(&arena, file->memory, file->size, pool).counts.position_count;
+        }break;
+        case benchmark_function_load_obj_welded_pool:
+        {
+            result = load_obj_welded(&arena, file->memory, file->size, pool).vertex_count;
+        }break;
+        case benchmark_function_load_obj_polygons_pool:
+        {
+            result = load_obj_polygons(&arena, file->memory, file->size, pool).counts.position_count;
+        }break;
+        case benchmark_function_load_obj_stats_pool:
+        {
+            ParserMeshStats stats;
+            result = load_obj(&arena, file->memory, file->size, pool, &stats, true).counts.position_count;
+        }break;
+        case benchmark_function_load_obj_incremental_pool:
+        case benchmark_function_load_obj_incremental_reload_pool:
+        {
+            // NOTE(joon) the file is copied so that it can be edited, load_obj_incremental alone 
+            // copies it as well and the caller subtracts that from the reload
+            u8 *copy = (u8 *)malloc(file->size);
+            memcpy(copy, file->memory, file->size);
+
+            ObjIncrementalState state;
+            begin_obj_incremental(&state, &arena);
+            result = load_obj_incremental(&state, copy, file->size, pool).counts.position_count;
+            if(function == benchmark_function_load_obj_incremental_reload_pool)
+            {
+                for(size_t i = file->size/2;
+                        i < file->size;
+                        ++i)
+                {
+                    if(copy[i] >= '1' && copy[i] <= '8')
+                    {
+                        copy[i]++;
+                        break;
+                    }
+                }
+                result = load_obj_incremental(&state, copy, file->size, pool).counts.position_count;
+            }
+            end_obj_incremental(&state);
+
+            free(copy);
+        }break;
+        case benchmark_function_build_obj_bvh_pool:
+        {
+            LoadObjResult mesh = load_obj(&arena, file->memory, file->size, pool);
+            build_obj_bvh(&arena, &mesh, 4, pool);
+
+            result = mesh.counts.position_count;
+        }break;
+        case benchmark_function_stream_obj:
+        case benchmark_function_stream_obj_pipelined:
+        {
+            u32 window_size = 1 << 20;
+            u8 *window = (u8 *)malloc(window_size);
+            ObjStreamBatch *batch = (ObjStreamBatch *)malloc(sizeof(ObjStreamBatch));
+
+            int file_descriptor = open(path, O_RDONLY);
+            if(function == benchmark_function_stream_obj_pipelined)
+            {
+                // NOTE(joon) 4 reads of 256KB ahead of the parser
+                ParserReadPipeline *pipeline = push_parser_struct(&arena, ParserReadPipeline);
+                begin_parser_read_pipeline(pipeline, &arena, file_descriptor, 256*1024, 4);
+                stream_obj(file_descriptor, window, window_size, batch, count_stream_obj_batch, &result, pipeline);
+                end_parser_read_pipeline(pipeline);
+            }
+            else
+            {
+                stream_obj(file_descriptor, window, window_size, batch, count_stream_obj_batch, &result);
+            }
+            close(file_descriptor);
+
+            free(batch);
+            free(window);
+        }break;
+        case benchmark_function_load_obj_path_pool:
+        {
+            result = load_obj(&arena, path, pool).counts.position_count;
+        }break;
+
+        case benchmark_function_parse_ply_header:
+        {
+            result = parse_ply_header(file->memory, file->size).vertex_count;
+        }break;
+        case benchmark_function_parse_ply:
+        case benchmark_function_parse_ply_pool:
+        {
+            ParsePlyHeaderResult header = parse_ply_header(file->memory, file->size);
+            f32 *vertices = push_parser_array(&arena, f32, (size_t)header.vertex_count*header.vertex_property_count);
+            u32 *indices = push_parser_array(&arena, u32, header.index_count);
+            parse_ply(file->memory, file->size, header, vertices, indices,
+                      (function == benchmark_function_parse_ply_pool) ? pool : 0);
+
+            result = header.vertex_count;
+        }break;
+        case benchmark_function_load_ply_with_layout_pool:
+        {
+            // NOTE(joon) f16 positions padded to 8 bytes, and the rest of the properties as f32 in their own stream
+            ParsePlyHeaderResult header = parse_ply_header(file->memory, file->size);
+            ParserVertexLayout layout = {};
+            add_parser_vertex_attribute(&layout, 0, 3, parser_vertex_format_f16, 0);
+            layout.strides[0] = 8;
+            if(header.vertex_property_count > 3)
+            {
+                u32 rest_count = header.vertex_property_count - 3;
+                add_parser_vertex_attribute(&layout, 3, (rest_count < 4) ? rest_count : 4, parser_vertex_format_f32, 1);
+            }
+
+            result = load_ply_with_layout(&arena, file->memory, file->size, &layout, pool).vertices.vertex_count;
+        }break;
+        case benchmark_function_load_ply_polygons_pool:
+        {
+            result = load_ply_polygons(&arena, file->memory, file->size, pool).header.vertex_count;
+        }break;
+        case benchmark_function_load_ply_stats_pool:
+        {
+            ParserMeshStats stats;
+            result = load_ply(&arena, file->memory, file->size, pool, &stats, true).header.vertex_count;
+        }break;
+        case benchmark_function_build_ply_bvh_pool:
+        {
+            LoadPlyResult mesh = load_ply(&arena, file->memory, file->size, pool);
+            build_ply_bvh(&arena, &mesh, 4, pool);
+
+            result = mesh.header.vertex_count;
+        }break;
+        case benchmark_function_stream_ply:
+        case benchmark_function_stream_ply_pipelined:
+        {
+            u32 window_size = 1 << 20;
+            u8 *window = (u8 *)malloc(window_size);
+            PlyStreamBatch *batch = (PlyStreamBatch *)malloc(sizeof(PlyStreamBatch));
+
+            int file_descriptor = open(path, O_RDONLY);
+            if(function == benchmark_function_stream_ply_pipelined)
+            {
+                // NOTE(joon) 4 reads of 256KB ahead of the parser
+                ParserReadPipeline *pipeline = push_parser_struct(&arena, ParserReadPipeline);
+                begin_parser_read_pipeline(pipeline, &arena, file_descriptor, 256*1024, 4);
+                stream_ply(file_descriptor, window, window_size, batch, count_stream_ply_batch, &result, pipeline);
+                end_parser_read_pipeline(pipeline);
+            }
+            else
+            {
+                stream_ply(file_descriptor, window, window_size, batch, count_stream_ply_batch, &result);
+            }
+            close(file_descriptor);
+
+            free(batch);
+            free(window);
+        }break;
+        case benchmark_function_load_ply_path_pool:
+        {
+            result = load_ply(&arena, path, pool).header.vertex_count;
+        }break;
+        case benchmark_function_parse_scene_pool:
+        {
+            // NOTE(joon) the meshes are next to the scene
+            char base_file_path[1024] = {};
+            char *last_slash = strrchr(path, '/');
+            if(last_slash)
+            {
+                memcpy(base_file_path, path, last_slash - path + 1);
+            }
+
+            ParseSceneResult scene = parse_scene(&arena, file->memory, file->size, base_file_path, pool);
+            result = scene.sphere_count + scene.box_count + scene.cylinder_count + scene.mesh_count;
+        }break;
+
+        default:
+        {
+            invalid_code_path;
+        }break;
+    }
+    free_parser_arena(&arena);
+
+    if(arena_peak_size)
+    {
+        *arena_peak_size = get_parser_arena_stats(&arena).peak_reserved_size;
+    }
+
+    return result;
+}
+
+// NOTE(joon) runs inside the child process. Best of the repeats is reported.
+internal void
+run_benchmark(BenchmarkFunction function, const char *corpus_name, char *path, u32 thread_count)
+{
+    ParserMappedFile file = {};
+    b32 needs_mapping = (function != benchmark_function_stream_obj &&
+                         function != benchmark_function_stream_obj_pipelined &&
+                         function != benchmark_function_stream_ply &&
+                         function != benchmark_function_stream_ply_pipelined &&
+                         function != benchmark_function_load_obj_path_pool &&
+                         function != benchmark_function_load_ply_path_pool);
+    size_t file_size = 0;
+    {
+        ParserMappedFile size_check = map_parser_file(path);
+        file_size = size_check.size;
+        unmap_parser_file(&size_check);
+    }
+    if(needs_mapping)
+    {
+        file = map_parser_file(path);
+    }
+
+    // NOTE(joon) parse_obj takes the size as u32
+    if((function == benchmark_function_parse_obj ||
+        function == benchmark_function_pre_parse_and_parse_obj) &&
+        file_size > 0xffffffff)
+    {
+        printf("%-32s %-28s skipped(bigger than 4GB)\n", corpus_name, benchmark_function_names[function]);
+        return;
+    }
+
+    ParserThreadPool *pool = (ParserThreadPool *)calloc(1, sizeof(ParserThreadPool));
+    start_parser_thread_pool(pool, thread_count);
+
+    u32 repeat_count = (file_size < (256ull << 20)) ? 3 : 1;
+    f64 best_seconds = 1e30;
+    u64 element_count = 0;
+    size_t arena_peak_size = 0;
+    for(u32 repeat_index = 0;
+            repeat_index < repeat_count;
+            ++repeat_index)
+    {
+        f64 start = get_seconds();
+        element_count = run_benchmark_function(function, path, &file, pool, &arena_peak_size);
+        f64 seconds = get_seconds() - start;
+
+        if(function == benchmark_function_parse_obj)
+        {
+            start = get_seconds();
+            run_benchmark_function(benchmark_function_pre_parse_obj, path, &file, pool);
+            seconds -= get_seconds() - start;
+        }
+        else if(function == benchmark_function_load_obj_incremental_reload_pool)
+        {
+            start = get_seconds();
+            run_benchmark_function(benchmark_function_load_obj_incremental_pool, path, &file, pool);
+            seconds -= get_seconds() - start;
+        }
+        else if(function == benchmark_function_build_obj_bvh_pool || 
+                function == benchmark_function_build_ply_bvh_pool)
+        {
+            start = get_seconds();
+            run_benchmark_function((function == benchmark_function_build_obj_bvh_pool) ? 
+                                   benchmark_function_load_obj_pool : benchmark_function_parse_ply_pool, path, &file, pool);
+            seconds -= get_seconds() - start;
+        }
+
+        if(seconds < best_seconds)
+        {
+            best_seconds = seconds;
+        }
+    }
+
+    end_parser_thread_pool(pool);
+    free(pool);
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("%-32s %-28s %10.1f MB/s %10.2f M%s/s %10.1f MB peak RSS %10.1f MB peak arena\n",
+            corpus_name, benchmark_function_names[function],
+            (f64)file_size/best_seconds/1e6,
+            (f64)element_count/best_seconds/1e6,
+            (function <= benchmark_function_decode_parser_small_integer) ? "num" : "vtx",
+            (f64)usage.ru_maxrss/1024.0,
+            (f64)arena_peak_size/(1024.0*1024.0));
+    fflush(stdout);
+
+    unmap_parser_file(&file);
+}
+
+int
+main(int argument_count, char **arguments)
+{
+    char *corpus_dir = (char *)"parser_benchmark_corpus";
+    u32 sizes_in_mb[32] = {1, 16, 128};
+    u32 size_count = 3;
+    long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+    u32 thread_count = (processor_count > 1) ? (u32)(processor_count - 1) : 0;
+    b32 force_generate = false;
+
+    for(i32 argument_index = 1;
+            argument_index < argument_count;
+            ++argument_index)
+    {
+        char *argument = arguments[argument_index];
+        if(strcmp(argument, "-sizes") == 0 && argument_index + 1 < argument_count)
+        {
+            size_count = 0;
+            char *at = arguments[++argument_index];
+            while(*at && size_count < 32)
+            {
+                sizes_in_mb[size_count++] = (u32)strtoul(at, &at, 10);
+                if(*at == ',')
+                {
+                    at++;
+                }
+            }
+        }
+        else if(strcmp(argument, "-threads") == 0 && argument_index + 1 < argument_count)
+        {
+            thread_count = (u32)atoi(arguments[++argument_index]);
+            if(thread_count > parser_max_thread_count)
+            {
+                thread_count = parser_max_thread_count;
+            }
+        }
+        else if(strcmp(argument, "-generate") == 0)
+        {
+            force_generate = true;
+        }
+        else
+        {
+            corpus_dir = argument;
+        }
+    }
+
+    mkdir(corpus_dir, 0755);
+    printf("corpus: %s, pool: %u worker threads + the calling thread\n", corpus_dir, thread_count);
+
+    for(u32 size_index = 0;
+            size_index < size_count;
+            ++size_index)
+    {
+        u64 target_size = (u64)sizes_in_mb[size_index] << 20;
+        for(u32 corpus_index = 0;
+                corpus_index < sizeof(benchmark_corpora)/sizeof(benchmark_corpora[0]);
+                ++corpus_index)
+        {
+            BenchmarkCorpus *corpus = benchmark_corpora + corpus_index;
+
+            char path[1024];
+            snprintf(path, sizeof(path), "%s/%s_%umb.%s", corpus_dir, corpus->name, sizes_in_mb[size_index],
+                     corpus->type == benchmark_file_type_obj ? "obj" :
+                     corpus->type == benchmark_file_type_scene ? "scn" :
+                     (corpus->type == benchmark_file_type_numbers || corpus->type == benchmark_file_type_indices) ? "txt" : "ply");
+
+            struct stat file_stat;
+            if(force_generate || stat(path, &file_stat) != 0)
+            {
+                generate_corpus_file(path, corpus, target_size);
+            }
+
+            char corpus_name[256];
+            snprintf(corpus_name, sizeof(corpus_name), "%s_%umb", corpus->name, sizes_in_mb[size_index]);
+            for(u32 function = 0;
+                    function < benchmark_function_count;
+                    ++function)
+            {
+                if(!is_benchmark_function_for((BenchmarkFunction)function, corpus->type))
+                {
+                    continue;
+                }
+
+                // NOTE(joon) parse_obj only supports v & v//vn
+                if((function == benchmark_function_parse_obj ||
+                    function == benchmark_function_pre_parse_and_parse_obj) &&
+                    corpus->vertex_type != obj_vertex_type_v &&
+                    corpus->vertex_type != obj_vertex_type_v_vn)
+                {
+                    continue;
+                }
+
+                fflush(stdout);
+                pid_t child = fork();
+                if(child == 0)
+                {
+                    run_benchmark((BenchmarkFunction)function, corpus_name, path, thread_count);
+                    _exit(0);
+                }
+                else if(child > 0)
+                {
+                    int status;
+                    waitpid(child, &status, 0);
+                    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                    {
+                        printf("%-32s %-28s failed\n", corpus_name, benchmark_function_names[function]);
+                    }
+                }
+            }
+        }
+    }
+
+    return 0;
+}